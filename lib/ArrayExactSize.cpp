@@ -10,6 +10,8 @@
 namespace Canal {
 namespace Array {
 
+bool ExactSize::COLLAPSE = false;
+
 ExactSize::ExactSize(const Environment &environment,
                      const llvm::SequentialType &type)
     : Domain(environment, Domain::ArrayExactSizeKind),
@@ -85,6 +87,19 @@ ExactSize::memoryUsage() const
     return size;
 }
 
+size_t
+ExactSize::hash() const
+{
+    size_t result = combineHash(getKind(), mValues.size());
+    std::vector<Domain*>::const_iterator it = mValues.begin(),
+        itend = mValues.end();
+
+    for (; it != itend; ++it)
+        result = combineHash(result, (*it)->hash());
+
+    return result;
+}
+
 std::string
 ExactSize::toString() const
 {
@@ -502,9 +517,10 @@ ExactSize::extractelement(const Domain &index) const
             // If some offset from the set points out of the
             // array bounds, we ignore it FOR NOW.  It might be caused
             // either by a bug in the code, or by imprecision of the
-            // interpreter.
+            // interpreter.  Offsets are sorted, so all the following
+            // ones are out of bounds as well.
             if (numOffset >= mValues.size())
-                continue;
+                break;
 
             result->join(*mValues[numOffset]);
         }
@@ -580,9 +596,10 @@ ExactSize::insertelement(const Domain &array,
             // If some offset from the set points out of the
             // array bounds, we ignore it.  It might be caused either
             // by a bug in the code, or by imprecision of the
-            // interpreter.
+            // interpreter.  Offsets are sorted, so all the following
+            // ones are out of bounds as well.
             if (numOffset >= mValues.size())
-                continue;
+                break;
 
             if (set.mValues.size() == 1)
             {
@@ -809,9 +826,10 @@ ExactSize::store(const Domain &value,
             // If some offset from the set points out of the
             // array bounds, we ignore it FOR NOW.  It might be caused
             // either by a bug in the code, or by imprecision of the
-            // interpreter.
+            // interpreter.  Offsets are sorted, so all the following
+            // ones are out of bounds as well.
             if (numOffset >= mValues.size())
-                continue;
+                break;
 
             mValues[numOffset]->store(value,
                                       std::vector<Domain*>(offsets.begin() + 1,
@@ -11,6 +11,11 @@ namespace Array {
 class ExactSize : public Domain
 {
 public:
+    /// Create arrays without the exact-size domain, so the items are
+    /// kept only as a single item.  Set when the interpreter runs out
+    /// of memory.  See Array::Utils::collapseExactSize.
+    static bool COLLAPSE;
+
     std::vector<Domain*> mValues;
 
     bool mHasExactSize;
@@ -49,6 +54,8 @@ public: // Implementation of Domain.
 
     virtual size_t memoryUsage() const;
 
+    virtual size_t hash() const;
+
     virtual std::string toString() const;
 
     virtual void setZero(const llvm::Value *place);
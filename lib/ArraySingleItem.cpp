@@ -91,6 +91,15 @@ SingleItem::memoryUsage() const
     return size;
 }
 
+size_t
+SingleItem::hash() const
+{
+    size_t result = getKind();
+    result = combineHash(result, mValue ? mValue->hash() : 0);
+    result = combineHash(result, mSize ? mSize->hash() : 0);
+    return result;
+}
+
 std::string
 SingleItem::toString() const
 {
@@ -63,6 +63,8 @@ public: // Implementation of Domain.
 
     virtual size_t memoryUsage() const;
 
+    virtual size_t hash() const;
+
     virtual std::string toString() const;
 
     virtual void setZero(const llvm::Value *place);
@@ -1,4 +1,5 @@
 #include "ArrayStringPrefix.h"
+#include "ArrayUtils.h"
 #include "ProductVector.h"
 #include "Utils.h"
 #include "Environment.h"
@@ -60,8 +61,7 @@ StringPrefix::StringPrefix(const Environment &environment,
     : Domain(environment, Domain::ArrayStringPrefixKind),
       mPrefix(value),
       mIsBottom(false),
-      mType(*llvm::ArrayType::get(llvm::Type::getInt8Ty(environment.getContext()),
-                                  value.size()))
+      mType(Utils::getStringType(environment, value.size()))
 {
 }
 
@@ -85,6 +85,19 @@ StringPrefix::memoryUsage() const
     return size;
 }
 
+size_t
+StringPrefix::hash() const
+{
+    size_t result = combineHash(getKind(), mIsBottom);
+    if (mIsBottom)
+        return result;
+
+    for (size_t i = 0; i < mPrefix.size(); ++i)
+        result = combineHash(result, (unsigned char)mPrefix[i]);
+
+    return result;
+}
+
 std::string
 StringPrefix::toString() const
 {
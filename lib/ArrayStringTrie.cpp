@@ -1,4 +1,5 @@
 #include "ArrayStringTrie.h"
+#include "ArrayUtils.h"
 #include "Environment.h"
 #include "Utils.h"
 #include "IntegerUtils.h"
@@ -7,6 +8,8 @@
 namespace Canal {
 namespace Array {
 
+size_t StringTrie::SIZE_THRESHOLD = 0;
+
 bool
 TrieNode::Compare::operator()(const TrieNode *first, const TrieNode *second) const
 {
@@ -178,8 +181,7 @@ StringTrie::StringTrie(const Environment &environment,
     : Domain(environment, Domain::ArrayStringTrieKind),
       mIsBottom(false),
       mRoot(new TrieNode("")),
-      mType(*llvm::ArrayType::get(llvm::Type::getInt8Ty(environment.getContext()),
-                                  value.size()))
+      mType(Utils::getStringType(environment, value.size()))
 {
     TrieNode *newNode = new TrieNode(value);
     mRoot->mChildren.insert(newNode);
@@ -206,6 +208,22 @@ StringTrie::memoryUsage() const
     return size;
 }
 
+size_t
+StringTrie::hash() const
+{
+    size_t result = combineHash(getKind(), mIsBottom);
+    if (mIsBottom)
+        return result;
+
+    // Only the root is hashed, the children are left to the
+    // equality operator.
+    result = combineHash(result, mRoot->mChildren.size());
+    for (size_t i = 0; i < mRoot->mValue.size(); ++i)
+        result = combineHash(result, (unsigned char)mRoot->mValue[i]);
+
+    return result;
+}
+
 std::string
 StringTrie::toString() const
 {
@@ -283,6 +301,9 @@ StringTrie::join(const Domain &value)
     }
    
     mIsBottom = false;
+    if (SIZE_THRESHOLD && mRoot->size() > SIZE_THRESHOLD)
+        setTop();
+
     return *this;
 }
 
@@ -32,6 +32,10 @@ public:
 class StringTrie : public Domain
 {
 public:
+    /// Maximum number of characters stored in a trie.  Larger tries
+    /// are widened to top when joined.  Zero disables the limit.
+    static size_t SIZE_THRESHOLD;
+
     TrieNode *mRoot;
     bool mIsBottom;
     const llvm::SequentialType &mType;
@@ -62,6 +66,8 @@ public: // Implementation of Domain
 
     virtual size_t memoryUsage() const;
 
+    virtual size_t hash() const;
+
     virtual std::string toString() const;
 
     virtual void setZero(const llvm::Value *place);
@@ -81,6 +87,9 @@ public: // Implementation of Domain
     virtual bool isTop() const;
 
     virtual void setTop();
+
+public: // Memory layout
+    virtual const llvm::SequentialType &getValueType() const { return mType; }
 };
 
 } // namespace Array
@@ -1,7 +1,11 @@
 #include "ArrayUtils.h"
+#include "ArrayExactSize.h"
+#include "ArraySingleItem.h"
 #include "ArrayStringPrefix.h"
 #include "ProductVector.h"
+#include "Structure.h"
 #include "Utils.h"
+#include "Environment.h"
 
 namespace Canal {
 namespace Array {
@@ -32,6 +36,110 @@ strcat(Domain &destination, const Domain &source)
     }
 }
 
+/// Check if a value contains the exact-size domain of an array.
+static bool
+hasExactSize(const Domain &value)
+{
+    if (llvm::isa<ExactSize>(value))
+        return true;
+
+    const std::vector<Domain*> *values = NULL;
+    if (const Product::Vector *vector = dynCast<Product::Vector>(&value))
+        values = &vector->mValues;
+    else if (const Structure *structure = dynCast<Structure>(&value))
+        values = &structure->mMembers;
+    else if (const SingleItem *array = dynCast<SingleItem>(&value))
+        return hasExactSize(*array->mValue);
+    else
+        return false;
+
+    std::vector<Domain*>::const_iterator it = values->begin(),
+        itend = values->end();
+
+    for (; it != itend; ++it)
+    {
+        if (hasExactSize(**it))
+            return true;
+    }
+
+    return false;
+}
+
+/// Replace the exact-size domains in a value in place.
+static void
+collapse(Domain &value)
+{
+    std::vector<Domain*> *values = NULL;
+    if (Product::Vector *vector = dynCast<Product::Vector>(&value))
+        values = &vector->mValues;
+    else if (Structure *structure = dynCast<Structure>(&value))
+        values = &structure->mMembers;
+    else if (SingleItem *array = dynCast<SingleItem>(&value))
+    {
+        collapse(*array->mValue);
+        return;
+    }
+    else
+        return;
+
+    std::vector<Domain*>::iterator it = values->begin(),
+        itend = values->end();
+
+    for (; it != itend; ++it)
+    {
+        ExactSize *array = dynCast<ExactSize>(*it);
+        if (!array)
+        {
+            collapse(**it);
+            continue;
+        }
+
+        // The items are collapsed first, so they can be joined with
+        // items created without the exact-size domain.
+        std::vector<Domain*>::iterator iit = array->mValues.begin(),
+            iitend = array->mValues.end();
+
+        for (; iit != iitend; ++iit)
+            collapse(**iit);
+
+        SingleItem *item;
+        if (array->mHasExactSize)
+        {
+            item = new SingleItem(array->getEnvironment(),
+                                  array->mType,
+                                  array->mValues.begin(),
+                                  array->mValues.end());
+        }
+        else
+        {
+            item = new SingleItem(array->getEnvironment(), array->mType);
+            item->setTop();
+        }
+
+        delete array;
+        *it = item;
+    }
+}
+
+Domain *
+collapseExactSize(const Domain &value)
+{
+    if (!hasExactSize(value))
+        return NULL;
+
+    Domain *result = value.clone();
+    collapse(*result);
+    return result;
+}
+
+const llvm::ArrayType &
+getStringType(const Environment &environment, uint64_t size)
+{
+    llvm::MutexGuard guard(environment.getMutex());
+    return *llvm::ArrayType::get(
+        llvm::Type::getInt8Ty(environment.getContext()), size);
+}
+
 } // namespace Utils
 } // namespace Array
 } // namespace Canal
@@ -9,6 +9,19 @@ namespace Utils {
 
 void strcat(Domain &destination, const Domain &source);
 
+/// Get a copy of a value where the exact-size domain of every array,
+/// including the arrays nested in structures and other arrays, is
+/// replaced by a single item holding the join of the array items.
+/// @returns
+///   A newly allocated value, or NULL if the value contains no
+///   exact-size domain.
+Domain *collapseExactSize(const Domain &value);
+
+/// Returns the LLVM type of a string (array of i8) of given length.
+/// Safe to call from multiple interpreter threads.
+const llvm::ArrayType &getStringType(const Environment &environment,
+                                     uint64_t size);
+
 } // namespace Utils
 } // namespace Array
 } // namespace Canal
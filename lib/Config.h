@@ -0,0 +1,24 @@
+
+/* Define to 1 if you have the <gelf.h> header file. */
+/* #undef HAVE_GELF_H */
+
+/* Define to 1 if you have the `elf' library (-lelf). */
+/* #undef HAVE_LIBELF */
+
+/* Define to 1 if you have the <libelf.h> header file. */
+/* #undef HAVE_LIBELF_H */
+
+/* Define to 1 if you have the <readline/readline.h> header file. */
+#define HAVE_READLINE_READLINE_H 1
+
+/* LLVM has been compiled with NDEBUG */
+/* #undef LLVM_WITH_NDEBUG */
+
+/* Have Clang. */
+/* #undef HAVE_CLANG */
+
+#define LLVM_VERSION_MAJOR 14
+
+#define LLVM_VERSION_MINOR 0
+
+#define VERSION 2
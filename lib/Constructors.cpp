@@ -1,4 +1,5 @@
 #include "Constructors.h"
+#include "ProductStatic.h"
 #include "ProductVector.h"
 #include "IntegerBitfield.h"
 #include "IntegerSet.h"
@@ -206,9 +207,14 @@ Constructors::create(const llvm::Constant &value,
         const llvm::Function &functionValue =
             checkedCast<llvm::Function>(value);
 
-        Domain *constPointer;
-        constPointer = createPointer(*llvm::PointerType::getUnqual(
-                                         functionValue.getFunctionType()));
+        const llvm::PointerType *pointerType;
+        {
+            llvm::MutexGuard guard(mEnvironment.getMutex());
+            pointerType = llvm::PointerType::getUnqual(
+                functionValue.getFunctionType());
+        }
+
+        Domain *constPointer = createPointer(*pointerType);
 
         Pointer::Utils::addTarget(*constPointer,
                                   Pointer::Target::Function,
@@ -226,21 +232,13 @@ Constructors::create(const llvm::Constant &value,
 Domain *
 Constructors::createInteger(unsigned bitWidth) const
 {
-    Product::Vector* container = new Product::Vector(mEnvironment);
-    container->mValues.push_back(new Integer::Bitfield(mEnvironment, bitWidth));
-    container->mValues.push_back(new Integer::Set(mEnvironment, bitWidth));
-    container->mValues.push_back(new Integer::Interval(mEnvironment, bitWidth));
-    return container;
+    return new Integer::Combined(mEnvironment, bitWidth);
 }
 
 Domain *
 Constructors::createInteger(const llvm::APInt &number) const
 {
-    Product::Vector* container = new Product::Vector(mEnvironment);
-    container->mValues.push_back(new Integer::Bitfield(mEnvironment, number));
-    container->mValues.push_back(new Integer::Set(mEnvironment, number));
-    container->mValues.push_back(new Integer::Interval(mEnvironment, number));
-    return container;
+    return new Integer::Combined(mEnvironment, number);
 }
 
 Domain *
@@ -259,7 +257,11 @@ Domain *
 Constructors::createArray(const llvm::SequentialType &type) const
 {
     Product::Vector *container = new Product::Vector(mEnvironment);
-    container->mValues.push_back(new Array::ExactSize(mEnvironment, type));
+    if (Array::ExactSize::COLLAPSE)
+        container->mValues.push_back(new Array::SingleItem(mEnvironment, type));
+    else
+        container->mValues.push_back(new Array::ExactSize(mEnvironment, type));
+
     container->mValues.push_back(new Array::SingleItem(mEnvironment, type));
     container->mValues.push_back(new Array::StringPrefix(mEnvironment, type));
     return container;
@@ -270,7 +272,14 @@ Constructors::createArray(const llvm::SequentialType &type,
                           Domain *size) const
 {
     Product::Vector *container = new Product::Vector(mEnvironment);
-    container->mValues.push_back(new Array::ExactSize(mEnvironment, type));
+    if (Array::ExactSize::COLLAPSE)
+    {
+        container->mValues.push_back(
+            new Array::SingleItem(mEnvironment, type, size->clone()));
+    }
+    else
+        container->mValues.push_back(new Array::ExactSize(mEnvironment, type));
+
     container->mValues.push_back(new Array::SingleItem(mEnvironment, type, size));
     container->mValues.push_back(new Array::StringPrefix(mEnvironment, type));
     return container;
@@ -281,9 +290,23 @@ Constructors::createArray(const llvm::SequentialType &type,
                           const std::vector<Domain*> &values) const
 {
     Product::Vector *container = new Product::Vector(mEnvironment);
-    container->mValues.push_back(new Array::ExactSize(mEnvironment, type, values));
+    if (Array::ExactSize::COLLAPSE)
+        container->mValues.push_back(new Array::SingleItem(mEnvironment, type, values.begin(), values.end()));
+    else
+        container->mValues.push_back(new Array::ExactSize(mEnvironment, type, values));
+
     container->mValues.push_back(new Array::SingleItem(mEnvironment, type, values.begin(), values.end()));
     container->mValues.push_back(new Array::StringPrefix(mEnvironment, type, values.begin(), values.end()));
+
+    // Without the exact-size domain, nothing takes ownership of the
+    // values.
+    if (Array::ExactSize::COLLAPSE)
+    {
+        std::vector<Domain*>::const_iterator it = values.begin();
+        for (; it != values.end(); ++it)
+            delete *it;
+    }
+
     return container;
 }
 
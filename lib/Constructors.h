@@ -50,6 +50,8 @@ public:
     Domain *createArray(const llvm::SequentialType &type,
                         Domain *size) const;
 
+    /// @param values
+    ///   The array takes ownership of the values.
     Domain *createArray(const llvm::SequentialType &type,
                         const std::vector<Domain*> &values) const;
 
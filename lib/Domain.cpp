@@ -6,11 +6,18 @@
 
 namespace Canal {
 
+/// Memory of the abstract values stored in states in bytes.  The
+/// atomic operations of LLVM are limited to 32 bits, which large
+/// states overflow, so GCC builtins are used instead.
+static volatile int64_t storedMemory = 0;
+
 Domain::Domain(const Environment &environment,
                enum DomainKind kind)
     : mEnvironment(environment),
       mKind(kind),
-      mWideningData(NULL)
+      mWideningData(NULL),
+      mInterned(false),
+      mAccountedMemory(0)
 {
 }
 
@@ -18,7 +25,9 @@ Domain::Domain(const Domain &value)
     : SharedData(value),
       mEnvironment(value.mEnvironment),
       mKind(value.mKind),
-      mWideningData(value.mWideningData)
+      mWideningData(value.mWideningData),
+      mInterned(false),
+      mAccountedMemory(0)
 {
     if (mWideningData)
         mWideningData = mWideningData->clone();
@@ -27,6 +36,31 @@ Domain::Domain(const Domain &value)
 Domain::~Domain()
 {
     delete mWideningData;
+    if (mAccountedMemory)
+        __sync_sub_and_fetch(&storedMemory, (int64_t)mAccountedMemory);
+}
+
+void
+Domain::accountMemory() const
+{
+    // Interned values are never modified.
+    if (mInterned && mAccountedMemory)
+        return;
+
+    size_t memory = memoryUsage();
+    if (memory == mAccountedMemory)
+        return;
+
+    __sync_add_and_fetch(&storedMemory,
+                         (int64_t)memory - (int64_t)mAccountedMemory);
+
+    mAccountedMemory = memory;
+}
+
+uint64_t
+Domain::getStoredMemory()
+{
+    return __sync_add_and_fetch(&storedMemory, 0);
 }
 
 bool
@@ -29,6 +29,7 @@ public:
         ArrayStringPrefixKind,
         ArrayStringTrieKind,
         FloatIntervalKind,
+        ProductStaticKind,
         ProductVectorKind,
         IntegerBitfieldKind,
         IntegerIntervalKind,
@@ -43,6 +44,16 @@ public:
 
     Widening::DataInterface *mWideningData;
 
+    /// Indication that the value is stored in the interning table of
+    /// its environment.  Interned values are never modified, and
+    /// equal interned values are the same object.
+    bool mInterned;
+
+    /// Memory (byte count) of this value included in the memory of
+    /// the stored abstract values.  Zero until the value is stored
+    /// to a state.
+    mutable size_t mAccountedMemory;
+
 public:
     /// Standard constructor.
     Domain(const Environment &environment,
@@ -56,6 +67,17 @@ public:
     /// Virtual destructor.
     virtual ~Domain();
 
+    /// Update the memory of the stored abstract values by the change
+    /// of the memory usage of this value since it was last accounted.
+    /// Called when the value is stored to a state and after it is
+    /// modified there, so the memory can be limited without walking
+    /// the states.  The memory is released with the value.
+    void accountMemory() const;
+
+    /// Get the memory (byte count) of the abstract values stored in
+    /// states, including the memory allocated by their members.
+    static uint64_t getStoredMemory();
+
     const Environment &getEnvironment() const
     {
         return mEnvironment;
@@ -72,6 +94,10 @@ public:
     /// Get memory usage (used byte count) of this abstract value.
     virtual size_t memoryUsage() const = 0;
 
+    /// Get a hash of the abstract value.  Values that are equal
+    /// according to operator== must have the same hash.
+    virtual size_t hash() const = 0;
+
     /// Create a string representation of the abstract value.
     virtual std::string toString() const = 0;
 
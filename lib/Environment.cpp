@@ -7,10 +7,13 @@ Environment::Environment(llvm::Module *module)
     : mModule(module), mTargetData(module), mSlotTracker(*module)
 {
     CANAL_ASSERT_MSG(module, "Module cannot be NULL");
+    numberRegisters();
 }
 
 Environment::~Environment()
 {
+    // Interned values may refer to the module.
+    mInterningTable.clear();
     delete mModule;
 }
 
@@ -20,9 +23,40 @@ Environment::getContext() const
     return mModule->getContext();
 }
 
+void
+Environment::numberRegisters()
+{
+    mRegisterNumbers.clear();
+    llvm::Module::const_iterator it = mModule->begin(),
+        itend = mModule->end();
+
+    for (; it != itend; ++it)
+    {
+        unsigned number = 0;
+        llvm::Function::const_arg_iterator ait = it->arg_begin(),
+            aitend = it->arg_end();
+
+        for (; ait != aitend; ++ait)
+            mRegisterNumbers[&*ait] = number++;
+
+        llvm::Function::const_iterator bit = it->begin(),
+            bitend = it->end();
+
+        for (; bit != bitend; ++bit)
+        {
+            llvm::BasicBlock::const_iterator iit = bit->begin(),
+                iitend = bit->end();
+
+            for (; iit != iitend; ++iit)
+                mRegisterNumbers[&*iit] = number++;
+        }
+    }
+}
+
 uint64_t
 Environment::getTypeStoreSize(const llvm::Type &type) const
 {
+    llvm::MutexGuard guard(mMutex);
     llvm::Type &modifiableType = const_cast<llvm::Type&>(type);
     uint64_t size = mTargetData.getTypeStoreSize(&modifiableType);
     CANAL_ASSERT_MSG(mTargetData.getTypeAllocSize(&modifiableType) == size,
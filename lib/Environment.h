@@ -2,6 +2,7 @@
 #define LIBCANAL_ENVIRONMENT_H
 
 #include "SlotTracker.h"
+#include "InterningTable.h"
 
 namespace Canal {
 
@@ -19,8 +20,19 @@ class Environment
 
     mutable SlotTracker mSlotTracker;
 
+    /// Numbers of registers (arguments and instructions) within
+    /// their functions.
+    llvm::DenseMap<const llvm::Value*, unsigned> mRegisterNumbers;
+
     Constructors *mConstructors;
 
+    /// Canonical abstract values of the module.
+    mutable InterningTable mInterningTable;
+
+    /// Serializes access to the LLVM context and the target data,
+    /// which are not thread-safe.  Both create their content lazily.
+    mutable llvm::sys::Mutex mMutex;
+
 public:
     // @param module
     //   LLVM module that contains all functions.
@@ -49,6 +61,11 @@ public:
         return mSlotTracker;
     }
 
+    InterningTable &getInterningTable() const
+    {
+        return mInterningTable;
+    }
+
     const Constructors &getConstructors() const
     {
         return *mConstructors;
@@ -60,6 +77,30 @@ public:
     }
 
     uint64_t getTypeStoreSize(const llvm::Type &type) const;
+
+    /// Get the number of a register within its function.  Arguments
+    /// are numbered first, then instructions in the order of basic
+    /// blocks.
+    /// @returns
+    ///   -1 if the place is not a register of the module.
+    int getRegisterNumber(const llvm::Value &place) const
+    {
+        llvm::DenseMap<const llvm::Value*, unsigned>::const_iterator it =
+            mRegisterNumbers.find(&place);
+
+        return it == mRegisterNumbers.end() ? -1 : (int)it->second;
+    }
+
+    /// Number the registers of all functions of the module.  Must be
+    /// called when the functions of the module change.
+    void numberRegisters();
+
+    /// Lock that must be held when types are created in the LLVM
+    /// context during the interpretation.
+    llvm::sys::Mutex &getMutex() const
+    {
+        return mMutex;
+    }
 };
 
 } // namespace Canal
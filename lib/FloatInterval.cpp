@@ -5,6 +5,8 @@
 #include "FloatUtils.h"
 #include "Utils.h"
 #include "Environment.h"
+#include <algorithm>
+#include <math.h>
 
 #define ROUNDING_MODE llvm::APFloat::rmNearestTiesToEven
 
@@ -261,6 +263,31 @@ Interval::memoryUsage() const
     return sizeof(Interval);
 }
 
+/// Helper for Interval::hash().  Positive and negative zero are
+/// equal, so they must have the same hash.
+static size_t
+getFloatHash(const llvm::APFloat &value)
+{
+    if (value.isZero())
+        return 0;
+
+    return getHash(value.bitcastToAPInt());
+}
+
+size_t
+Interval::hash() const
+{
+    size_t result = getKind();
+    if (mEmpty)
+        return combineHash(result, 1);
+
+    if (isTop())
+        return combineHash(result, 2);
+
+    result = combineHash(result, getFloatHash(mFrom));
+    return combineHash(result, getFloatHash(mTo));
+}
+
 std::string
 Interval::toString() const
 {
@@ -566,6 +593,52 @@ minMax(llvm::APFloat& min,
     return false;
 }
 
+bool
+Interval::nativeOperation(const Interval &a,
+                          const Interval &b,
+                          Utils::NativeOperation operation)
+{
+    const llvm::fltSemantics &semantics = a.getSemantics();
+    if (!Utils::isNative(semantics) || &b.getSemantics() != &semantics)
+        return false;
+
+    double bounds[4];
+    if (!Utils::toDouble(a.mFrom, bounds[0]) ||
+        !Utils::toDouble(a.mTo, bounds[1]) ||
+        !Utils::toDouble(b.mFrom, bounds[2]) ||
+        !Utils::toDouble(b.mTo, bounds[3]))
+    {
+        return false;
+    }
+
+    // Combine all bounds of the operands, so the same code serves
+    // both monotone and sign-dependent operations.
+    double lower = HUGE_VAL, upper = -HUGE_VAL;
+    for (int i = 0; i < 2; ++i)
+    {
+        for (int j = 2; j < 4; ++j)
+        {
+            double resultLower, resultUpper;
+            if (!operation(bounds[i], bounds[j], resultLower, resultUpper))
+            {
+                setTop();
+                return true;
+            }
+
+            lower = std::min(lower, resultLower);
+            upper = std::max(upper, resultUpper);
+        }
+    }
+
+    if (!Utils::fromDouble(lower, semantics, /*roundUp=*/false, mFrom) ||
+        !Utils::fromDouble(upper, semantics, /*roundUp=*/true, mTo))
+    {
+        setTop();
+    }
+
+    return true;
+}
+
 #define OVERFLOW_TO_TOP(op)        \
     if (op != llvm::APFloat::opOK) \
     {                              \
@@ -584,13 +657,13 @@ Interval::fadd(const Domain &a, const Domain &b)
         return *this;
 
     mTop = (aa.mTop || bb.mTop);
-    if (!mTop)
+    if (!mTop && !nativeOperation(aa, bb, Utils::nativeAdd))
     {
         mFrom = aa.mFrom;
         OVERFLOW_TO_TOP(mFrom.add(bb.mFrom, ROUNDING_MODE));
 
         mTo = aa.mTo;
-        OVERFLOW_TO_TOP(mTo.add(bb.mFrom, ROUNDING_MODE));
+        OVERFLOW_TO_TOP(mTo.add(bb.mTo, ROUNDING_MODE));
     }
 
     return *this;
@@ -607,10 +680,10 @@ Interval::fsub(const Domain &a, const Domain &b)
         return *this;
 
     mTop = (aa.mTop || bb.mTop);
-    if (!mTop)
+    if (!mTop && !nativeOperation(aa, bb, Utils::nativeSubtract))
     {
         mFrom = aa.mFrom;
-        OVERFLOW_TO_TOP(mFrom.subtract(bb.mFrom, ROUNDING_MODE));
+        OVERFLOW_TO_TOP(mFrom.subtract(bb.mTo, ROUNDING_MODE));
 
         mTo = aa.mTo;
         OVERFLOW_TO_TOP(mTo.subtract(bb.mFrom, ROUNDING_MODE));
@@ -630,7 +703,7 @@ Interval::fmul(const Domain &a, const Domain &b)
         return *this;
 
     mTop = (aa.mTop || bb.mTop);
-    if (!mTop)
+    if (!mTop && !nativeOperation(aa, bb, Utils::nativeMultiply))
     {
         llvm::APFloat fromFrom(aa.mFrom), fromTo(aa.mFrom),
                 toFrom(aa.mTo), toTo(aa.mTo);
@@ -664,6 +737,21 @@ Interval::fdiv(const Domain &a, const Domain &b)
             setTop();
             return *this;
         }
+
+        // A divisor crossing zero gets arbitrarily close to it from
+        // both sides, so the quotient is unbounded in both directions.
+        if (bb.mFrom.isNegative() != bb.mTo.isNegative())
+        {
+            setTop();
+            return *this;
+        }
+
+        if (!bb.mFrom.isZero() && !bb.mTo.isZero() &&
+            nativeOperation(aa, bb, Utils::nativeDivide))
+        {
+            return *this;
+        }
+
         llvm::APFloat fromFrom(aa.mFrom), fromTo(aa.mFrom),
                 toFrom(aa.mTo), toTo(aa.mTo);
 
@@ -2,6 +2,7 @@
 #define LIBCANAL_FLOAT_INTERVAL_H
 
 #include "Domain.h"
+#include "FloatUtils.h"
 
 namespace Canal {
 namespace Float {
@@ -59,6 +60,8 @@ public: // Implementation of Domain.
 
     virtual size_t memoryUsage() const;
 
+    virtual size_t hash() const;
+
     virtual std::string toString() const;
 
     virtual void setZero(const llvm::Value *place);
@@ -96,6 +99,16 @@ public: // Implementation of Domain.
     virtual Interval &sitofp(const Domain &value);
 
     virtual const llvm::Type &getValueType() const;
+
+protected:
+    /// Computes the result by hardware arithmetic when both operands
+    /// are finite IEEE single or double precision intervals.  Bounds
+    /// are rounded outwards, so they contain the exact result.
+    /// @return
+    ///   False if the operation must be computed by APFloat.
+    bool nativeOperation(const Interval &a,
+                         const Interval &b,
+                         Utils::NativeOperation operation);
 };
 
 } // namespace Float
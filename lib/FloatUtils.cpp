@@ -1,5 +1,13 @@
 #include "FloatUtils.h"
 #include "Utils.h"
+#include <cfloat>
+#include <math.h>
+
+// Error-free transformations used to round the native results
+// outwards require every operation to be rounded to double.
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+#  define CANAL_NATIVE_FLOAT
+#endif
 
 namespace Canal {
 namespace Float {
@@ -70,6 +78,130 @@ toInteger(const llvm::APFloat &num, unsigned bitWidth, bool isSigned, llvm::APFl
     else return llvm::APInt(bitWidth, 0);
 }
 
+bool
+isNative(const llvm::fltSemantics &semantics)
+{
+#ifdef CANAL_NATIVE_FLOAT
+    return &semantics == &llvm::APFloat::IEEEsingle ||
+        &semantics == &llvm::APFloat::IEEEdouble;
+#else
+    return false;
+#endif
+}
+
+bool
+toDouble(const llvm::APFloat &num, double &result)
+{
+    if (num.isNaN() || num.isInfinity())
+        return false;
+
+    if (&num.getSemantics() == &llvm::APFloat::IEEEsingle)
+        result = num.convertToFloat();
+    else
+        result = num.convertToDouble();
+
+    return true;
+}
+
+static bool
+isFinite(double num)
+{
+    return num - num == 0;
+}
+
+bool
+fromDouble(double num,
+           const llvm::fltSemantics &semantics,
+           bool roundUp,
+           llvm::APFloat &result)
+{
+    if (&semantics == &llvm::APFloat::IEEEdouble)
+    {
+        result = llvm::APFloat(num);
+        return isFinite(num);
+    }
+
+    float single = (float)num;
+    if (roundUp && (double)single < num)
+        single = nextafterf(single, HUGE_VALF);
+    else if (!roundUp && (double)single > num)
+        single = nextafterf(single, -HUGE_VALF);
+
+    result = llvm::APFloat(single);
+    return isFinite(single);
+}
+
+// Below this magnitude the rounding error of a product or a
+// quotient might not be representable, so its sign is not reliable.
+static const double TINY = 1e-288;
+
+// Sets the bounds around a result rounded to nearest, given the sign
+// of its rounding error.
+static bool
+setBounds(double result, double error, double &lower, double &upper)
+{
+    if (!isFinite(result))
+        return false;
+
+    lower = upper = result;
+    if (error > 0)
+        upper = nextafter(result, HUGE_VAL);
+    else if (error < 0)
+        lower = nextafter(result, -HUGE_VAL);
+
+    return true;
+}
+
+bool
+nativeAdd(double a, double b, double &lower, double &upper)
+{
+    // Knuth's TwoSum computes the exact rounding error.
+    double sum = a + b,
+        bVirtual = sum - a,
+        aVirtual = sum - bVirtual,
+        error = (a - aVirtual) + (b - bVirtual);
+
+    return setBounds(sum, error, lower, upper);
+}
+
+bool
+nativeSubtract(double a, double b, double &lower, double &upper)
+{
+    return nativeAdd(a, -b, lower, upper);
+}
+
+bool
+nativeMultiply(double a, double b, double &lower, double &upper)
+{
+    double product = a * b;
+    if (product != 0 ? fabs(product) < TINY : a != 0 && b != 0)
+    {
+        // The product might have lost precision by underflow.
+        lower = nextafter(product, -HUGE_VAL);
+        upper = nextafter(product, HUGE_VAL);
+        return true;
+    }
+
+    return setBounds(product, fma(a, b, -product), lower, upper);
+}
+
+bool
+nativeDivide(double a, double b, double &lower, double &upper)
+{
+    CANAL_ASSERT(b != 0);
+    double quotient = a / b;
+    if (a != 0 && (fabs(quotient) < TINY || fabs(a) < TINY))
+    {
+        lower = nextafter(quotient, -HUGE_VAL);
+        upper = nextafter(quotient, HUGE_VAL);
+        return true;
+    }
+
+    // The remainder of the rounded quotient is exact.
+    double remainder = fma(-quotient, b, a);
+    return setBounds(quotient, b > 0 ? remainder : -remainder, lower, upper);
+}
+
 } // namespace Utils
 } // namespace Float
 } // namespace Canal
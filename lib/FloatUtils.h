@@ -17,6 +17,44 @@ llvm::APInt toInteger(const llvm::APFloat &num,
                       bool isSigned,
                       llvm::APFloat::opStatus &status);
 
+/// Checks whether values of the semantics can be computed by the
+/// host's IEEE double precision arithmetic.  True for IEEE single
+/// and double precision unless the host evaluates floating point
+/// expressions in a wider format (x87).
+bool isNative(const llvm::fltSemantics &semantics);
+
+/// Converts a finite number of native semantics to double.
+/// @return
+///   False if the number is a NaN or an infinity.
+bool toDouble(const llvm::APFloat &num, double &result);
+
+/// Converts a double to the given native semantics.
+/// @param roundUp
+///   Direction of rounding if the number is not representable in
+///   the semantics.
+/// @return
+///   False if the result is not finite.
+bool fromDouble(double num,
+                const llvm::fltSemantics &semantics,
+                bool roundUp,
+                llvm::APFloat &result);
+
+/// Operation on doubles that computes bounds of the exact result.
+/// @return
+///   False if the result is not finite.
+typedef bool(*NativeOperation)(double a,
+                               double b,
+                               double &lower,
+                               double &upper);
+
+bool nativeAdd(double a, double b, double &lower, double &upper);
+
+bool nativeSubtract(double a, double b, double &lower, double &upper);
+
+bool nativeMultiply(double a, double b, double &lower, double &upper);
+
+bool nativeDivide(double a, double b, double &lower, double &upper);
+
 } // namespace Utils
 } // namespace Float
 } // namespace Canal
@@ -0,0 +1,157 @@
+#include "GarbageCollector.h"
+#include "ArrayExactSize.h"
+#include "ArraySingleItem.h"
+#include "Pointer.h"
+#include "ProductVector.h"
+#include "State.h"
+#include "Structure.h"
+#include "Utils.h"
+
+namespace Canal {
+
+bool GarbageCollector::ENABLED = false;
+
+void
+GarbageCollector::addRoot(const Domain &value)
+{
+    mark(value);
+}
+
+void
+GarbageCollector::mark(const Domain &value)
+{
+    if (const Pointer::Pointer *pointer = dynCast<Pointer::Pointer>(&value))
+    {
+        if (pointer->mTop)
+            mKeepAll = true;
+
+        Pointer::PlaceTargetMap::const_iterator it = pointer->mTargets.begin(),
+            itend = pointer->mTargets.end();
+
+        for (; it != itend; ++it)
+        {
+            if (it->second->mType == Pointer::Target::Block)
+                addBlock(it->second->mTarget);
+        }
+    }
+    else if (const Structure *structure = dynCast<Structure>(&value))
+    {
+        std::vector<Domain*>::const_iterator it = structure->mMembers.begin(),
+            itend = structure->mMembers.end();
+
+        for (; it != itend; ++it)
+            mark(**it);
+    }
+    else if (const Array::ExactSize *array = dynCast<Array::ExactSize>(&value))
+    {
+        std::vector<Domain*>::const_iterator it = array->mValues.begin(),
+            itend = array->mValues.end();
+
+        for (; it != itend; ++it)
+            mark(**it);
+    }
+    else if (const Array::SingleItem *array = dynCast<Array::SingleItem>(&value))
+        mark(*array->mValue);
+    else if (const Product::Vector *vector = dynCast<Product::Vector>(&value))
+    {
+        std::vector<Domain*>::const_iterator it = vector->mValues.begin(),
+            itend = vector->mValues.end();
+
+        for (; it != itend; ++it)
+            mark(**it);
+    }
+}
+
+void
+GarbageCollector::addRoots(const State &state)
+{
+    addRoots(state.getGlobalVariables());
+    addRoots(state.getFunctionVariables());
+    if (state.getReturnedValue())
+        addRoot(*state.getReturnedValue());
+
+    const VariableArguments::CallMap &calls =
+        state.getVariableArguments().getCalls();
+
+    VariableArguments::CallMap::const_iterator cit = calls.begin();
+    for (; cit != calls.end(); ++cit)
+    {
+        std::vector<Domain*>::const_iterator it = cit->second.begin();
+        for (; it != cit->second.end(); ++it)
+            addRoot(**it);
+    }
+}
+
+size_t
+GarbageCollector::collect(State &state)
+{
+    addRoots(state);
+
+    StateMap::const_iterator it = state.getGlobalBlocks().begin(),
+        itend = state.getGlobalBlocks().end();
+
+    for (; it != itend; ++it)
+    {
+        if (llvm::isa<llvm::GlobalVariable>(it->first))
+            addBlock(it->first);
+    }
+
+    while (!mWorklist.empty() && !mKeepAll)
+    {
+        const llvm::Value *place = mWorklist.back();
+        mWorklist.pop_back();
+        const Domain *block = state.findBlock(*place);
+        if (block)
+            mark(*block);
+    }
+
+    if (mKeepAll)
+        return 0;
+
+    return sweep(state.getGlobalBlocks()) + sweep(state.getFunctionBlocks());
+}
+
+void
+GarbageCollector::addRoots(const StateMap &map)
+{
+    StateMap::const_iterator it = map.begin(), itend = map.end();
+    for (; it != itend; ++it)
+        addRoot(*it->second);
+}
+
+void
+GarbageCollector::addRoots(const RegisterFile &registers)
+{
+    RegisterFile::const_iterator it = registers.begin(),
+        itend = registers.end();
+
+    for (; it != itend; ++it)
+        addRoot(*it->second);
+}
+
+void
+GarbageCollector::addBlock(const llvm::Value *place)
+{
+    if (mReachable.insert(place).second)
+        mWorklist.push_back(place);
+}
+
+size_t
+GarbageCollector::sweep(StateMap &blocks)
+{
+    std::vector<const llvm::Value*> unreachable;
+    StateMap::const_iterator it = blocks.begin(), itend = blocks.end();
+    for (; it != itend; ++it)
+    {
+        if (mReachable.find(it->first) == mReachable.end())
+            unreachable.push_back(it->first);
+    }
+
+    std::vector<const llvm::Value*>::const_iterator uit = unreachable.begin();
+    for (; uit != unreachable.end(); ++uit)
+        blocks.erase(*uit);
+
+    return unreachable.size();
+}
+
+} // namespace Canal
@@ -0,0 +1,74 @@
+#ifndef LIBCANAL_GARBAGE_COLLECTOR_H
+#define LIBCANAL_GARBAGE_COLLECTOR_H
+
+#include "Prereq.h"
+#include <set>
+#include <vector>
+
+namespace Canal {
+
+class Domain;
+class RegisterFile;
+class State;
+class StateMap;
+
+/// Removes memory blocks that cannot be reached from a state.  Blocks
+/// are reachable from the roots (registers, global variables, the
+/// returned value and variable arguments) through block targets of
+/// pointers, including pointers stored in other reachable blocks.
+///
+/// Blocks of global variables are always reachable, because constants
+/// refer to them directly.  When a reachable pointer is top, it might
+/// point anywhere, so no block is removed.
+class GarbageCollector
+{
+public:
+    /// Collect unreachable blocks at function calls and returns.
+    static bool ENABLED;
+
+protected:
+    /// Places of the blocks that have been found reachable.
+    std::set<const llvm::Value*> mReachable;
+
+    /// Reachable blocks whose values have not been searched yet.
+    std::vector<const llvm::Value*> mWorklist;
+
+    /// Indication that a reachable pointer is top.
+    bool mKeepAll;
+
+public:
+    GarbageCollector() : mKeepAll(false) {}
+
+    /// Add the blocks referenced by a value to the reachable blocks.
+    void addRoot(const Domain &value);
+
+    /// Add the blocks referenced by the registers, global variables,
+    /// returned value and variable arguments of a state to the
+    /// reachable blocks.  Used for roots that are not stored in the
+    /// collected state.
+    void addRoots(const State &state);
+
+    /// Remove unreachable global and function blocks from a state.
+    /// The roots of the state are added to the roots added before.
+    /// @returns
+    ///   Number of removed blocks.
+    size_t collect(State &state);
+
+protected:
+    /// Add the blocks referenced by a value, including the values of
+    /// aggregates, to the worklist.
+    void mark(const Domain &value);
+
+    void addRoots(const StateMap &map);
+
+    void addRoots(const RegisterFile &registers);
+
+    void addBlock(const llvm::Value *place);
+
+    /// Remove blocks that have not been found reachable.
+    size_t sweep(StateMap &blocks);
+};
+
+} // namespace Canal
+
+#endif // LIBCANAL_GARBAGE_COLLECTOR_H
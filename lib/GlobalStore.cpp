@@ -0,0 +1,22 @@
+#include "GlobalStore.h"
+
+namespace Canal {
+
+bool
+GlobalStore::commit(const State &state)
+{
+    if (!mState.mergeGlobal(state))
+        return false;
+
+    ++mVersion;
+    return true;
+}
+
+void
+GlobalStore::share(State &state) const
+{
+    state.getGlobalVariables().share(mState.getGlobalVariables());
+    state.getGlobalBlocks().share(mState.getGlobalBlocks());
+}
+
+} // namespace Canal
@@ -0,0 +1,58 @@
+#ifndef LIBCANAL_GLOBAL_STORE_H
+#define LIBCANAL_GLOBAL_STORE_H
+
+#include "State.h"
+
+namespace Canal {
+
+/// Global variables and global blocks of the whole program.  States
+/// of functions and basic blocks refer to the memory of the store
+/// instead of keeping their own copies of the globals.
+///
+/// Every change of the store creates a new version.  The maps are
+/// persistent, so a state holding an older version keeps a valid
+/// snapshot, which shares the unchanged entries with the store.
+class GlobalStore
+{
+    /// Global variables and global blocks of the current version.
+    /// Other members of the state are not used.
+    State mState;
+
+    /// Incremented on every change of the store.
+    unsigned mVersion;
+
+public:
+    GlobalStore() : mVersion(0) {}
+
+    const State &getState() const
+    {
+        return mState;
+    }
+
+    unsigned getVersion() const
+    {
+        return mVersion;
+    }
+
+    /// Merge global variables and global blocks of a state to the
+    /// store.
+    /// @returns
+    ///   True if a new version has been created.
+    bool commit(const State &state);
+
+    /// Make the globals of a state that are equal to the globals in
+    /// the store share the memory of the store.  The content of the
+    /// state does not change.
+    void share(State &state) const;
+
+    /// Replace the globals by their transformed copies.  The version
+    /// is kept, as the states holding it are transformed as well.
+    void transform(ValueTransform &transform)
+    {
+        mState.transform(transform);
+    }
+};
+
+} // namespace Canal
+
+#endif // LIBCANAL_GLOBAL_STORE_H
@@ -224,6 +224,13 @@ Bitfield::memoryUsage() const
     return sizeof(Bitfield);
 }
 
+size_t
+Bitfield::hash() const
+{
+    size_t result = combineHash(getKind(), getHash(mZeroes));
+    return combineHash(result, getHash(mOnes));
+}
+
 std::string
 Bitfield::toString() const
 {
@@ -329,12 +336,8 @@ Bitfield::setTop()
 float
 Bitfield::accuracy() const
 {
-    int variableBits = 0;
-    for (unsigned pos = 0; pos < getBitWidth(); ++pos)
-    {
-        if (getBitValue(pos) == 2)
-            ++variableBits;
-    }
+    // Bits set in both masks are the top ones.
+    unsigned variableBits = (mZeroes & mOnes).countPopulation();
 
     return 1.0 - (variableBits / (float)getBitWidth());
 }
@@ -506,11 +509,43 @@ Bitfield::ashr(const Domain &a, const Domain &b)
     return *this;
 }
 
+// Bits of a bitfield that fits into a machine word, split by their
+// value.  Bottom bits are the ones missing from all three masks.
+struct WordBits
+{
+    uint64_t mMask;
+    uint64_t mZero;
+    uint64_t mOne;
+    uint64_t mTop;
+
+    WordBits(const Bitfield &bitfield)
+    {
+        uint64_t zeroes = bitfield.mZeroes.getZExtValue(),
+            ones = bitfield.mOnes.getZExtValue();
+
+        mMask = ~UINT64_C(0) >> (64 - bitfield.getBitWidth());
+        mZero = zeroes & ~ones;
+        mOne = ones & ~zeroes;
+        mTop = zeroes & ones;
+    }
+
+    uint64_t known() const
+    {
+        return mZero | mOne;
+    }
+};
+
+// Word-parallel equivalents of bitAnd, bitOr and bitXor for bitfields
+// of 64 bits and less.
+typedef void(*WordOperation)(const WordBits &, const WordBits &,
+                             uint64_t &, uint64_t &);
+
 static Bitfield &
 bitOperation(Bitfield &result,
              const Domain &a,
              const Domain &b,
-             int(*operation)(int,int))
+             int(*operation)(int,int),
+             WordOperation wordOperation)
 {
     const Bitfield &aa = checkedCast<Bitfield>(a),
         &bb = checkedCast<Bitfield>(b);
@@ -520,6 +555,15 @@ bitOperation(Bitfield &result,
     CANAL_ASSERT(aa.getBitWidth() == bb.getBitWidth() &&
                  result.getBitWidth() == aa.getBitWidth());
 
+    if (aa.getBitWidth() <= 64)
+    {
+        uint64_t zero, one;
+        wordOperation(WordBits(aa), WordBits(bb), zero, one);
+        result.mZeroes = llvm::APInt(aa.getBitWidth(), zero);
+        result.mOnes = llvm::APInt(aa.getBitWidth(), one);
+        return result;
+    }
+
     for (unsigned pos = 0; pos < aa.getBitWidth(); ++pos)
     {
         result.setBitValue(pos, operation(aa.getBitValue(pos),
@@ -551,10 +595,22 @@ bitAnd(int valueA, int valueB)
         return (valueA == -1 || valueB == -1) ? -1 : 1;
 }
 
+static void
+wordAnd(const WordBits &a, const WordBits &b,
+        uint64_t &zeroes, uint64_t &ones)
+{
+    uint64_t zero = a.mZero | b.mZero,
+        top = ~zero & (a.mTop | b.mTop),
+        one = a.mOne & b.mOne;
+
+    zeroes = zero | top;
+    ones = one | top;
+}
+
 Bitfield &
 Bitfield::and_(const Domain &a, const Domain &b)
 {
-    return bitOperation(*this, a, b, bitAnd);
+    return bitOperation(*this, a, b, bitAnd, wordAnd);
 }
 
 // First number in a pair is mOnes, second is mZeroes
@@ -579,10 +635,23 @@ bitOr(int valueA, int valueB)
         return (valueA == 1 || valueB == 1) ? 1 : -1;
 }
 
+static void
+wordOr(const WordBits &a, const WordBits &b,
+       uint64_t &zeroes, uint64_t &ones)
+{
+    uint64_t known = a.known() & b.known(),
+        top = ~known & (a.mTop | b.mTop),
+        zero = known & a.mZero & b.mZero,
+        one = ~top & (a.mOne | b.mOne);
+
+    zeroes = zero | top;
+    ones = one | top;
+}
+
 Bitfield &
 Bitfield::or_(const Domain &a, const Domain &b)
 {
-    return bitOperation(*this, a, b, bitOr);
+    return bitOperation(*this, a, b, bitOr, wordOr);
 }
 
 // First number in a pair is mOnes, second is mZeroes
@@ -607,10 +676,24 @@ bitXor(int valueA, int valueB)
         return (valueA == 1 || valueB == 1) ? 1 : -1;
 }
 
+static void
+wordXor(const WordBits &a, const WordBits &b,
+        uint64_t &zeroes, uint64_t &ones)
+{
+    uint64_t known = a.known() & b.known(),
+        top = ~known & (a.mTop | b.mTop),
+        zero = known & ~(a.mOne ^ b.mOne),
+        one = (known & (a.mOne ^ b.mOne)) |
+            (~known & ~top & (a.mOne | b.mOne));
+
+    zeroes = zero | top;
+    ones = one | top;
+}
+
 Bitfield &
 Bitfield::xor_(const Domain &a, const Domain &b)
 {
-    return bitOperation(*this, a, b, bitXor);
+    return bitOperation(*this, a, b, bitXor, wordXor);
 }
 
 // -1 if a < b, 0 if a == b, 1 if a > b, 2 if unknown
@@ -621,8 +704,24 @@ compare(const Bitfield &a,
         bool signed_)
 {
     //Possible todo - TT >= 10 if signed
-    bool first = true;
-    for (int pos = a.getBitWidth() - 1; pos >= 0; --pos)
+    int start = a.getBitWidth() - 1;
+    if (a.getBitWidth() <= 64)
+    {
+        // Skip the leading bits that are known and equal in both
+        // bitfields; the loop below decides at the first other bit.
+        WordBits wordA(a), wordB(b);
+        uint64_t known = wordA.known() & wordB.known(),
+            decisive = (wordA.mMask & ~known) |
+                (known & (wordA.mOne ^ wordB.mOne));
+
+        if (!decisive)
+            return 0;
+
+        start = llvm::Log2_64(decisive);
+    }
+
+    bool first = (start == (int)a.getBitWidth() - 1);
+    for (int pos = start; pos >= 0; --pos)
     {
         int i = a.getBitValue(pos);
         int j = b.getBitValue(pos);
@@ -676,6 +775,16 @@ compare(const Bitfield &a,
 static int
 compareEqual(const Bitfield &a, const Bitfield &b)
 {
+    if (a.getBitWidth() <= 64)
+    {
+        WordBits wordA(a), wordB(b);
+        uint64_t known = wordA.known() & wordB.known();
+        if (known & (wordA.mOne ^ wordB.mOne))
+            return 1;
+
+        return (known == wordA.mMask ? 0 : -1);
+    }
+
     bool wasTop = false;
     for (int pos = a.getBitWidth() - 1; pos >= 0; --pos)
     {
@@ -929,6 +1038,7 @@ Bitfield::fptosi(const Domain &value)
 const llvm::IntegerType &
 Bitfield::getValueType() const
 {
+    llvm::MutexGuard guard(mEnvironment.getMutex());
     return *llvm::Type::getIntNTy(mEnvironment.getContext(), getBitWidth());
 }
 
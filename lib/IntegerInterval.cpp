@@ -222,6 +222,29 @@ Interval::memoryUsage() const
     return sizeof(Interval);
 }
 
+size_t
+Interval::hash() const
+{
+    size_t result = combineHash(getKind(), getBitWidth());
+    result = combineHash(result, isSignedBottom());
+    result = combineHash(result, isSignedTop());
+    if (!isSignedTop() && !isSignedBottom())
+    {
+        result = combineHash(result, getHash(mSignedFrom));
+        result = combineHash(result, getHash(mSignedTo));
+    }
+
+    result = combineHash(result, isUnsignedBottom());
+    result = combineHash(result, isUnsignedTop());
+    if (!isUnsignedTop() && !isUnsignedBottom())
+    {
+        result = combineHash(result, getHash(mUnsignedFrom));
+        result = combineHash(result, getHash(mUnsignedTo));
+    }
+
+    return result;
+}
+
 std::string
 Interval::toString() const
 {
@@ -1737,6 +1760,7 @@ Interval::refine(const Product::Message& message)
 const llvm::IntegerType &
 Interval::getValueType() const
 {
+    llvm::MutexGuard guard(mEnvironment.getMutex());
     return *llvm::Type::getIntNTy(mEnvironment.getContext(), getBitWidth());
 }
 
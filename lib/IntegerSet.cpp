@@ -11,6 +11,22 @@ namespace Integer {
 
 unsigned int Set::SET_THRESHOLD = 40;
 
+// Appends the values from..to in modular arithmetic; the range wraps
+// around the maximum value if to is lower than from.
+static void
+appendWrapped(Utils::USet &values,
+              const llvm::APInt &from,
+              const llvm::APInt &to)
+{
+    if (from.ule(to))
+        values.append(from, to);
+    else
+    {
+        values.append(from, llvm::APInt::getMaxValue(from.getBitWidth()));
+        values.append(llvm::APInt::getMinValue(from.getBitWidth()), to);
+    }
+}
+
 Set::Set(const Environment &environment,
          unsigned bitWidth)
     : Domain(environment, Domain::IntegerSetKind),
@@ -80,7 +96,7 @@ Set::signedMax(llvm::APInt &result) const
         if (bound == mValues.end() || //If there is no negative number in this set
             bound == mValues.begin())
         { //or first element in this set is negative
-            result = *mValues.rbegin(); //then the last element in this set is highest
+            result = mValues.back(); //then the last element in this set is highest
         }
         else { //There are some positive numbers as well
             result = *(--bound); //then the highest number is the one directly preceeding lowest negative number
@@ -117,7 +133,7 @@ Set::unsignedMax(llvm::APInt &result) const
             return false;
 
         // We assume the set is sorted by unsigned comparison.
-        result = *mValues.rbegin();
+        result = mValues.back();
     }
     return true;
 }
@@ -125,7 +141,8 @@ Set::unsignedMax(llvm::APInt &result) const
 bool
 Set::isConstant() const
 {
-    return (!mTop && mValues.size() == 1);
+    return (!mTop && mValues.rangeCount() == 1 &&
+            mValues.front() == mValues.back());
 }
 
 bool
@@ -152,7 +169,26 @@ size_t
 Set::memoryUsage() const
 {
     size_t result = sizeof(Set);
-    result += mValues.size() * sizeof(llvm::APInt);
+    result += mValues.capacity() * sizeof(Utils::URange);
+    return result;
+}
+
+size_t
+Set::hash() const
+{
+    size_t result = combineHash(getKind(), mTop);
+    if (mTop)
+        return result;
+
+    std::vector<Utils::URange>::const_iterator it = mValues.getRanges().begin(),
+        itend = mValues.getRanges().end();
+
+    for (; it != itend; ++it)
+    {
+        result = combineHash(result, getHash(it->mFrom));
+        result = combineHash(result, getHash(it->mTo));
+    }
+
     return result;
 }
 
@@ -167,9 +203,15 @@ Set::toString() const
         ss << " empty";
     ss << "\n";
 
-    Utils::USet::const_iterator it = mValues.begin();
-    for (; it != mValues.end(); ++it)
-        ss << "    " << Canal::toString(*it) << "\n";
+    std::vector<Utils::URange>::const_iterator it = mValues.getRanges().begin();
+    for (; it != mValues.getRanges().end(); ++it)
+    {
+        ss << "    " << Canal::toString(it->mFrom);
+        if (it->mFrom != it->mTo)
+            ss << " to " << Canal::toString(it->mTo);
+
+        ss << "\n";
+    }
 
     return ss.str();
 }
@@ -210,17 +252,7 @@ Set::operator<(const Domain &value) const
     if (isTop()) return set.isTop();
     if (set.isTop()) return true;
 
-    Utils::USet::iterator mine = mValues.begin(), other = set.mValues.begin();
-    Utils::USet::key_compare comp = mValues.key_comp();
-
-    for (; mine != mValues.end(); mine ++, other ++) {
-        if (other == set.mValues.end()) return false;
-        for (; *mine != *other && !comp(*mine, *other) ; other ++ ) {
-            if (other == set.mValues.end()) return false;
-        }
-        if (*mine != *other) return false;
-    }
-    return true;
+    return mValues.includedIn(set.mValues);
 }
 
 Set &
@@ -240,10 +272,9 @@ Set::join(const Domain &value)
                          << " bit value merged to "
                          << getBitWidth() << " bit value");
 
-        mValues.insert(set.mValues.begin(),
-                       set.mValues.end());
+        mValues.merge(set.mValues);
 
-        if (mValues.size() > SET_THRESHOLD)
+        if (mValues.rangeCount() > SET_THRESHOLD)
             setTop();
     }
 
@@ -272,17 +303,7 @@ Set::meet(const Domain &value)
         mValues = set.mValues;
     }
     else
-    {
-        Utils::USet intersection;
-        std::set_intersection(mValues.begin(),
-                              mValues.end(),
-                              set.mValues.begin(),
-                              set.mValues.end(),
-                              std::inserter(intersection, intersection.end()),
-                              Utils::UCompare());
-
-        mValues = intersection;
-    }
+        mValues.intersect(set.mValues);
 
     return *this;
 }
@@ -326,13 +347,13 @@ Set::accuracy() const
 Set &
 Set::add(const Domain &a, const Domain &b)
 {
-    return applyOperation(a, b, &llvm::APInt::operator+, NULL);
+    return applyRangeOperation(a, b, /*subtract=*/false);
 }
 
 Set &
 Set::sub(const Domain &a, const Domain &b)
 {
-    return applyOperation(a, b, &llvm::APInt::operator-, NULL);
+    return applyRangeOperation(a, b, /*subtract=*/true);
 }
 
 Set &
@@ -405,28 +426,6 @@ Set::xor_(const Domain &a, const Domain &b)
     return applyOperation(a, b, &llvm::APInt::operator^, NULL);
 }
 
-static bool
-intersects(const Set &a,
-           const Set &b)
-{
-    // Signed and unsigned does not matter, it contains specific values
-    Utils::USet::const_iterator ita = a.mValues.begin(),
-        itb = b.mValues.begin();
-
-    // Algorithm inspired by std::set_intersection
-    while (ita != a.mValues.end() && itb != b.mValues.end())
-    {
-        if ((*ita).slt(*itb))
-            ++ita;
-        else if ((*itb).slt(*ita))
-            ++itb;
-        else
-            return true;
-    }
-
-    return false;
-}
-
 Set &
 Set::icmp(const Domain &a, const Domain &b,
                   llvm::CmpInst::Predicate predicate)
@@ -460,9 +459,9 @@ Set::icmp(const Domain &a, const Domain &b,
         // If both sets are equal, the result is 1.  If
         // set intersection is empty, the result is 0.
         // Otherwise the result is the top value (both 0 and 1).
-        if (aa.mValues.size() == 1 && aa.mValues == bb.mValues)
+        if (aa.isConstant() && aa.mValues == bb.mValues)
             mValues.insert(llvm::APInt(/*bitWidth*/1, /*val*/1));
-        else if (intersects(aa, bb))
+        else if (aa.mValues.intersects(bb.mValues))
             setTop();
         else
             mValues.insert(llvm::APInt(/*bitWidth*/1, /*val*/0));
@@ -472,9 +471,9 @@ Set::icmp(const Domain &a, const Domain &b,
         // If both sets are equal, the result is 0.  If
         // set intersection is empty, the result is 1.
         // Otherwise the result is the top value (both 0 and 1).
-        if (!intersects(aa, bb))
+        if (!aa.mValues.intersects(bb.mValues))
             mValues.insert(llvm::APInt(/*bitWidth*/1, /*val*/1));
-        else if (aa.mValues.size() == 1 && aa.mValues == bb.mValues)
+        else if (aa.isConstant() && aa.mValues == bb.mValues)
             mValues.insert(llvm::APInt(/*bitWidth*/1, /*val*/0));
         else
             setTop();
@@ -487,9 +486,9 @@ Set::icmp(const Domain &a, const Domain &b,
         // the first set is unsigned lower than the lowest
         // element from the second set, the result is 0.
         // Otherwise the result is the top value (both 0 and 1).
-        if (aa.mValues.begin()->ugt(*bb.mValues.rbegin()))
+        if (aa.mValues.front().ugt(bb.mValues.back()))
             mValues.insert(llvm::APInt(/*bitWidth*/1, /*val*/1));
-        else if (aa.mValues.rbegin()->ult(*bb.mValues.begin()))
+        else if (aa.mValues.back().ult(bb.mValues.front()))
             mValues.insert(llvm::APInt(/*bitWidth*/1, /*val*/0));
         else
             setTop();
@@ -502,9 +501,9 @@ Set::icmp(const Domain &a, const Domain &b,
         // the first set is unsigned larger or equal than the largest
         // element from the second set, the result is 0.
         // Otherwise the result is the top value (both 0 and 1).
-        if (aa.mValues.begin()->uge(*bb.mValues.rbegin()))
+        if (aa.mValues.front().uge(bb.mValues.back()))
             mValues.insert(llvm::APInt(/*bitWidth*/1, /*val*/1));
-        else if (aa.mValues.rbegin()->ule(*bb.mValues.begin()))
+        else if (aa.mValues.back().ule(bb.mValues.front()))
             mValues.insert(llvm::APInt(/*bitWidth*/1, /*val*/0));
         else
             setTop();
@@ -517,9 +516,9 @@ Set::icmp(const Domain &a, const Domain &b,
         // the first set is unsigned larger than the largest
         // element from the second set, the result is 0.
         // Otherwise the result is the top value (both 0 and 1).
-        if (aa.mValues.rbegin()->ult(*bb.mValues.begin()))
+        if (aa.mValues.back().ult(bb.mValues.front()))
             mValues.insert(llvm::APInt(/*bitWidth*/1, /*val*/1));
-        else if (aa.mValues.begin()->ugt(*bb.mValues.rbegin()))
+        else if (aa.mValues.front().ugt(bb.mValues.back()))
             mValues.insert(llvm::APInt(/*bitWidth*/1, /*val*/0));
         else
             setTop();
@@ -532,9 +531,9 @@ Set::icmp(const Domain &a, const Domain &b,
         // the first set is unsigned larger or equal than the largest
         // element from the second set, the result is 0.
         // Otherwise the result is the top value (both 0 and 1).
-        if (aa.mValues.rbegin()->ule(*bb.mValues.begin()))
+        if (aa.mValues.back().ule(bb.mValues.front()))
             mValues.insert(llvm::APInt(/*bitWidth*/1, /*val*/1));
-        else if (aa.mValues.begin()->uge(*bb.mValues.rbegin()))
+        else if (aa.mValues.front().uge(bb.mValues.back()))
             mValues.insert(llvm::APInt(/*bitWidth*/1, /*val*/0));
         else
             setTop();
@@ -644,9 +643,25 @@ Set::trunc(const Domain &value)
 {
     const Set &set = checkedCast<Set>(value);
     mTop = set.mTop;
-    Utils::USet::const_iterator it = set.mValues.begin();
-    for (; it != set.mValues.end(); ++it)
-        mValues.insert(Utils::trunc(*it, getBitWidth()));
+    llvm::APInt maxValue = Utils::zext(llvm::APInt::getMaxValue(getBitWidth()),
+                                       set.getBitWidth());
+
+    std::vector<Utils::URange>::const_iterator it = set.mValues.getRanges().begin();
+    for (; it != set.mValues.getRanges().end(); ++it)
+    {
+        // A range longer than the target type covers all values.
+        if ((it->mTo - it->mFrom).uge(maxValue))
+        {
+            setTop();
+            return *this;
+        }
+
+        appendWrapped(mValues,
+                      Utils::trunc(it->mFrom, getBitWidth()),
+                      Utils::trunc(it->mTo, getBitWidth()));
+    }
+
+    mValues.normalize();
 
     return *this;
 }
@@ -656,9 +671,14 @@ Set::zext(const Domain &value)
 {
     const Set &set = checkedCast<Set>(value);
     mTop = set.mTop;
-    Utils::USet::const_iterator it = set.mValues.begin();
-    for (; it != set.mValues.end(); ++it)
-        mValues.insert(Utils::zext(*it, getBitWidth()));
+    std::vector<Utils::URange>::const_iterator it = set.mValues.getRanges().begin();
+    for (; it != set.mValues.getRanges().end(); ++it)
+    {
+        mValues.append(Utils::zext(it->mFrom, getBitWidth()),
+                       Utils::zext(it->mTo, getBitWidth()));
+    }
+
+    mValues.normalize();
 
     return *this;
 }
@@ -668,9 +688,28 @@ Set::sext(const Domain &value)
 {
     const Set &set = checkedCast<Set>(value);
     mTop = set.mTop;
-    Utils::USet::const_iterator it = set.mValues.begin();
-    for (; it != set.mValues.end(); ++it)
-        mValues.insert(Utils::sext(*it, getBitWidth()));
+    std::vector<Utils::URange>::const_iterator it = set.mValues.getRanges().begin();
+    for (; it != set.mValues.getRanges().end(); ++it)
+    {
+        // Split the ranges that cross the sign boundary, because
+        // the negative part moves to the top of the wider type.
+        if (!it->mFrom.isNegative() && it->mTo.isNegative())
+        {
+            unsigned bitWidth = set.getBitWidth();
+            mValues.append(Utils::sext(it->mFrom, getBitWidth()),
+                           Utils::sext(llvm::APInt::getSignedMaxValue(bitWidth), getBitWidth()));
+
+            mValues.append(Utils::sext(llvm::APInt::getSignedMinValue(bitWidth), getBitWidth()),
+                           Utils::sext(it->mTo, getBitWidth()));
+        }
+        else
+        {
+            mValues.append(Utils::sext(it->mFrom, getBitWidth()),
+                           Utils::sext(it->mTo, getBitWidth()));
+        }
+    }
+
+    mValues.normalize();
 
     return *this;
 }
@@ -694,9 +733,70 @@ Set::fptosi(const Domain &value)
 const llvm::IntegerType &
 Set::getValueType() const
 {
+    llvm::MutexGuard guard(mEnvironment.getMutex());
     return *llvm::Type::getIntNTy(mEnvironment.getContext(), getBitWidth());
 }
 
+// Operations without a range form are computed for every pair of
+// values; dense sets with many values go to top instead.
+static bool
+canEnumerate(const Set &a, const Set &b)
+{
+    return a.mValues.size() <= Set::SET_THRESHOLD &&
+        b.mValues.size() <= Set::SET_THRESHOLD;
+}
+
+Set &
+Set::applyRangeOperation(const Domain &a,
+                         const Domain &b,
+                         bool subtract)
+{
+    const Set &aa = checkedCast<Set>(a),
+        &bb = checkedCast<Set>(b);
+
+    CANAL_ASSERT(this != &a && this != &b);
+    setBottom();
+    if (aa.isBottom() || bb.isBottom()) return *this;
+    if (aa.isTop() || bb.isTop())
+    {
+        setTop();
+        return *this;
+    }
+
+    CANAL_ASSERT(aa.getBitWidth() == bb.getBitWidth());
+    std::vector<Utils::URange>::const_iterator aaIt = aa.mValues.getRanges().begin();
+    for (; aaIt != aa.mValues.getRanges().end(); ++aaIt)
+    {
+        std::vector<Utils::URange>::const_iterator bbIt = bb.mValues.getRanges().begin();
+        for (; bbIt != bb.mValues.getRanges().end(); ++bbIt)
+        {
+            // Results of two ranges form a single range in modular
+            // arithmetic, unless it covers all values.
+            bool overflow;
+            llvm::APInt length = Utils::uadd_ov(aaIt->mTo - aaIt->mFrom,
+                                                bbIt->mTo - bbIt->mFrom,
+                                                overflow);
+
+            if (overflow || length.isMaxValue())
+            {
+                setTop();
+                return *this;
+            }
+
+            llvm::APInt from = subtract
+                ? aaIt->mFrom - bbIt->mTo
+                : aaIt->mFrom + bbIt->mFrom;
+
+            appendWrapped(mValues, from, from + length);
+            if (!checkThreshold())
+                return *this;
+        }
+    }
+
+    mValues.normalize();
+    return *this;
+}
+
 Set &
 Set::applyOperation(const Domain &a,
                     const Domain &b,
@@ -716,6 +816,12 @@ Set::applyOperation(const Domain &a,
     }
 
     CANAL_ASSERT(aa.getBitWidth() == bb.getBitWidth());
+    if (!canEnumerate(aa, bb))
+    {
+        setTop();
+        return *this;
+    }
+
     Utils::USet::const_iterator aaIt = aa.mValues.begin();
     for (; aaIt != aa.mValues.end(); ++aaIt)
     {
@@ -723,11 +829,11 @@ Set::applyOperation(const Domain &a,
         for (; bbIt != bb.mValues.end(); ++bbIt)
         {
             if (operation1)
-                mValues.insert(((*aaIt).*(operation1))(*bbIt));
+                mValues.append(((*aaIt).*(operation1))(*bbIt));
             else
             {
                 bool overflow;
-                mValues.insert(((*aaIt).*(operation2))(*bbIt, overflow));
+                mValues.append(((*aaIt).*(operation2))(*bbIt, overflow));
                 if (overflow)
                 {
                     setTop();
@@ -735,14 +841,12 @@ Set::applyOperation(const Domain &a,
                 }
             }
 
-            if (mValues.size() > SET_THRESHOLD)
-            {
-                setTop();
+            if (!checkThreshold())
                 return *this;
-            }
         }
     }
 
+    mValues.normalize();
     return *this;
 }
 
@@ -764,9 +868,15 @@ Set::applyOperationDivision(const Domain &a,
     }
 
     CANAL_ASSERT(aa.getBitWidth() == bb.getBitWidth());
+    if (!canEnumerate(aa, bb))
+    {
+        setTop();
+        return *this;
+    }
+
     Utils::USet::const_iterator aaIt = aa.mValues.begin();
 
-    if (bb.mValues.size() == 1 && *bb.mValues.begin() == 0)
+    if (bb.isConstant() && bb.mValues.front() == 0)
     { //Only division by zero
         setTop();
         return *this;
@@ -778,19 +888,32 @@ Set::applyOperationDivision(const Domain &a,
         for (; bbIt != bb.mValues.end(); ++bbIt)
         {
             if (*bbIt == 0) continue; //Avoid division by zero
-            mValues.insert(((*aaIt).*(operation1))(*bbIt));
+            mValues.append(((*aaIt).*(operation1))(*bbIt));
 
-            if (mValues.size() > SET_THRESHOLD)
-            {
-                setTop();
+            if (!checkThreshold())
                 return *this;
-            }
         }
     }
 
+    mValues.normalize();
     return *this;
 }
 
+bool
+Set::checkThreshold()
+{
+    if (mValues.rangeCount() <= SET_THRESHOLD)
+        return true;
+
+    // Overlapping ranges might have been appended.
+    mValues.normalize();
+    if (mValues.rangeCount() <= SET_THRESHOLD)
+        return true;
+
+    setTop();
+    return false;
+}
+
 Set &
 Set::fromInterval(const Interval &interval) {
     mBitWidth = interval.getBitWidth();
@@ -804,26 +927,16 @@ Set::fromInterval(const Interval &interval) {
         mTop = false;
         mValues.clear();
         //Signed and unsigned are the same -> we store them ordered by unsigned comparator
-        llvm::APInt from, to, diff;
-        CANAL_ASSERT(interval.signedMin(from) && interval.signedMax(to));
-        diff = to - from;
-        if (diff.ult(SET_THRESHOLD)) { //Store every value
-            for (; from.slt(to); ++from) {
-                mValues.insert(from);
-            }
-            mValues.insert(from); //We need upper bound as well, but upper bound + 1 may not fit into bitwidth
-        }
-        else {
-            CANAL_ASSERT(interval.unsignedMin(from) && interval.unsignedMax(to));
-            diff = to - from;
-            if (diff.ult(SET_THRESHOLD)) { //Store every value
-                for (; from.ult(to); ++from) {
-                    mValues.insert(from);
-                }
-                mValues.insert(from);
-            }
-            else setTop();
-        }
+        llvm::APInt signedFrom, signedTo, unsignedFrom, unsignedTo;
+        CANAL_ASSERT(interval.signedMin(signedFrom) && interval.signedMax(signedTo));
+        CANAL_ASSERT(interval.unsignedMin(unsignedFrom) && interval.unsignedMax(unsignedTo));
+        //Use the representation with fewer values
+        if ((signedTo - signedFrom).ule(unsignedTo - unsignedFrom))
+            appendWrapped(mValues, signedFrom, signedTo);
+        else
+            mValues.append(unsignedFrom, unsignedTo);
+
+        mValues.normalize();
     }
     return *this;
 }
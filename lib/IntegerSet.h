@@ -16,6 +16,9 @@ public:
 
     unsigned mBitWidth;
 
+    /// Maximum number of ranges of consecutive values.  Operations
+    /// that enumerate values also require both operands to have
+    /// at most this number of values.
     static unsigned int SET_THRESHOLD;
 
 public:
@@ -99,6 +102,8 @@ public: // Implementation of Domain.
 
     virtual size_t memoryUsage() const;
 
+    virtual size_t hash() const;
+
     virtual std::string toString() const;
 
     virtual void setZero(const llvm::Value *place);
@@ -171,6 +176,11 @@ public: // Product
     virtual const llvm::IntegerType &getValueType() const;
 
 protected:
+    /// Addition and subtraction computed on ranges of values.
+    Set &applyRangeOperation(const Domain &a,
+                             const Domain &b,
+                             bool subtract);
+
     Set &applyOperation(const Domain &a,
                                 const Domain &b,
                                 Utils::Operation operation1,
@@ -179,6 +189,13 @@ protected:
     Set &applyOperationDivision(const Domain &a,
                                 const Domain &b,
                                 Utils::Operation operation1);
+
+    /// Sets the value to top if it holds more than SET_THRESHOLD
+    /// ranges.  Joins the overlapping ranges appended to the set
+    /// first.
+    /// @return
+    ///   False if the value was set to top.
+    bool checkThreshold();
 };
 
 } // namespace Integer
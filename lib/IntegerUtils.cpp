@@ -1,14 +1,224 @@
 #include "IntegerUtils.h"
 #include "IntegerBitfield.h"
-#include "ProductVector.h"
+#include "ProductStatic.h"
 #include "IntegerSet.h"
 #include "IntegerInterval.h"
 #include "Utils.h"
+#include <algorithm>
+
+// Checked arithmetic builtins are available since GCC 5 and in recent
+// clang releases.  Integers of 64 bits and less are computed natively
+// when they are present.
+#if defined(__clang__)
+#  if defined(__has_builtin)
+#    if __has_builtin(__builtin_add_overflow)
+#      define CANAL_OVERFLOW_BUILTINS
+#    endif
+#  endif
+#elif defined(__GNUC__) && __GNUC__ >= 5
+#  define CANAL_OVERFLOW_BUILTINS
+#endif
 
 namespace Canal {
 namespace Integer {
 namespace Utils {
 
+#ifdef CANAL_OVERFLOW_BUILTINS
+static bool
+fitsSigned(int64_t value, unsigned bitWidth)
+{
+    if (bitWidth >= 64)
+        return true;
+
+    int64_t limit = INT64_C(1) << (bitWidth - 1);
+    return value >= -limit && value < limit;
+}
+
+static bool
+fitsUnsigned(uint64_t value, unsigned bitWidth)
+{
+    return bitWidth >= 64 || (value >> bitWidth) == 0;
+}
+#endif
+
+static bool
+rangeFromLess(const URange &a, const URange &b)
+{
+    return a.mFrom.ult(b.mFrom);
+}
+
+static bool
+rangeToLess(const URange &range, const llvm::APInt &value)
+{
+    return range.mTo.ult(value);
+}
+
+// Appends a range to ranges sorted by their lower bound, joining it
+// with the last range if they overlap or are adjacent.
+static void
+appendJoined(std::vector<URange> &ranges, const URange &range)
+{
+    if (!ranges.empty())
+    {
+        URange &last = ranges.back();
+        if (last.mTo.isMaxValue() || range.mFrom.ule(last.mTo + 1))
+        {
+            if (range.mTo.ugt(last.mTo))
+                last.mTo = range.mTo;
+
+            return;
+        }
+    }
+
+    ranges.push_back(range);
+}
+
+size_t
+USet::size() const
+{
+    uint64_t result = 0;
+    std::vector<URange>::const_iterator it = mRanges.begin(),
+        itend = mRanges.end();
+
+    for (; it != itend; ++it)
+    {
+        uint64_t count = (it->mTo - it->mFrom).getLimitedValue(~UINT64_C(0) - 1) + 1;
+        if (result + count < result)
+            return ~(size_t)0;
+
+        result += count;
+    }
+
+    return (size_t)std::min(result, (uint64_t)~(size_t)0);
+}
+
+USet::const_iterator
+USet::lower_bound(const llvm::APInt &value) const
+{
+    std::vector<URange>::const_iterator it = std::lower_bound(
+        mRanges.begin(), mRanges.end(), value, rangeToLess);
+
+    if (it == mRanges.end())
+        return end();
+
+    return const_iterator(mRanges,
+                          it - mRanges.begin(),
+                          it->mFrom.ugt(value) ? it->mFrom : value);
+}
+
+void
+USet::normalize()
+{
+    if (mRanges.size() < 2)
+        return;
+
+    std::sort(mRanges.begin(), mRanges.end(), rangeFromLess);
+
+    std::vector<URange> result;
+    result.reserve(mRanges.size());
+    std::vector<URange>::const_iterator it = mRanges.begin(),
+        itend = mRanges.end();
+
+    for (; it != itend; ++it)
+        appendJoined(result, *it);
+
+    mRanges.swap(result);
+}
+
+void
+USet::merge(const USet &set)
+{
+    if (set.empty())
+        return;
+
+    std::vector<URange> result;
+    result.reserve(mRanges.size() + set.mRanges.size());
+    std::vector<URange>::const_iterator a = mRanges.begin(),
+        aend = mRanges.end(),
+        b = set.mRanges.begin(),
+        bend = set.mRanges.end();
+
+    while (a != aend || b != bend)
+    {
+        if (b == bend || (a != aend && a->mFrom.ult(b->mFrom)))
+            appendJoined(result, *a++);
+        else
+            appendJoined(result, *b++);
+    }
+
+    mRanges.swap(result);
+}
+
+void
+USet::intersect(const USet &set)
+{
+    std::vector<URange> result;
+    std::vector<URange>::const_iterator a = mRanges.begin(),
+        aend = mRanges.end(),
+        b = set.mRanges.begin(),
+        bend = set.mRanges.end();
+
+    while (a != aend && b != bend)
+    {
+        const llvm::APInt &from = a->mFrom.ugt(b->mFrom) ? a->mFrom : b->mFrom,
+            &to = a->mTo.ult(b->mTo) ? a->mTo : b->mTo;
+
+        if (from.ule(to))
+            result.push_back(URange(from, to));
+
+        // Move past the range that ends first.
+        if (a->mTo.ult(b->mTo))
+            ++a;
+        else
+            ++b;
+    }
+
+    mRanges.swap(result);
+}
+
+bool
+USet::intersects(const USet &set) const
+{
+    std::vector<URange>::const_iterator a = mRanges.begin(),
+        aend = mRanges.end(),
+        b = set.mRanges.begin(),
+        bend = set.mRanges.end();
+
+    while (a != aend && b != bend)
+    {
+        if (a->mTo.ult(b->mFrom))
+            ++a;
+        else if (b->mTo.ult(a->mFrom))
+            ++b;
+        else
+            return true;
+    }
+
+    return false;
+}
+
+bool
+USet::includedIn(const USet &set) const
+{
+    std::vector<URange>::const_iterator a = mRanges.begin(),
+        aend = mRanges.end(),
+        b = set.mRanges.begin(),
+        bend = set.mRanges.end();
+
+    // Ranges are not adjacent, so every range of this set must be
+    // covered by a single range of the other one.
+    for (; a != aend; ++a)
+    {
+        while (b != bend && b->mTo.ult(a->mFrom))
+            ++b;
+
+        if (b == bend || b->mFrom.ugt(a->mFrom) || b->mTo.ult(a->mTo))
+            return false;
+    }
+
+    return true;
+}
+
 unsigned
 getBitWidth(const Domain &value)
 {
@@ -19,43 +229,37 @@ getBitWidth(const Domain &value)
 Bitfield &
 getBitfield(Domain &value)
 {
-    Product::Vector &container = checkedCast<Product::Vector>(value);
-    return checkedCast<Bitfield>(*container.mValues[0]);
+    return checkedCast<Combined>(value).mFirst;
 }
 
 const Bitfield &
 getBitfield(const Domain &value)
 {
-    const Product::Vector &container = checkedCast<Product::Vector>(value);
-    return checkedCast<Bitfield>(*container.mValues[0]);
+    return checkedCast<Combined>(value).mFirst;
 }
 
 Set &
 getSet(Domain &value)
 {
-    Product::Vector &container = checkedCast<Product::Vector>(value);
-    return checkedCast<Set>(*container.mValues[1]);
+    return checkedCast<Combined>(value).mSecond;
 }
 
 const Set &
 getSet(const Domain &value)
 {
-    const Product::Vector &container = checkedCast<Product::Vector>(value);
-    return checkedCast<Set>(*container.mValues[1]);
+    return checkedCast<Combined>(value).mSecond;
 }
 
 Interval &
 getInterval(Domain &value)
 {
-    Product::Vector &container = checkedCast<Product::Vector>(value);
-    return checkedCast<Interval>(*container.mValues[2]);
+    return checkedCast<Combined>(value).mThird;
 }
 
 const Interval &
 getInterval(const Domain &value)
 {
-    const Product::Vector &container = checkedCast<Product::Vector>(value);
-    return checkedCast<Interval>(*container.mValues[2]);
+    return checkedCast<Combined>(value).mThird;
 }
 
 bool
@@ -161,6 +365,17 @@ sadd_ov(const llvm::APInt &a,
         const llvm::APInt &b,
         bool &overflow)
 {
+#ifdef CANAL_OVERFLOW_BUILTINS
+    if (a.getBitWidth() <= 64)
+    {
+        int64_t result;
+        overflow = __builtin_add_overflow(a.getSExtValue(), b.getSExtValue(), &result) ||
+            !fitsSigned(result, a.getBitWidth());
+
+        return llvm::APInt(a.getBitWidth(), result, true);
+    }
+#endif
+
 #if LLVM_VERSION_MAJOR == 2 && LLVM_VERSION_MINOR < 9
     llvm::APInt result = a + b;
     overflow = a.isNonNegative() == b.isNonNegative() &&
@@ -177,6 +392,17 @@ uadd_ov(const llvm::APInt &a,
         const llvm::APInt &b,
         bool &overflow)
 {
+#ifdef CANAL_OVERFLOW_BUILTINS
+    if (a.getBitWidth() <= 64)
+    {
+        uint64_t result;
+        overflow = __builtin_add_overflow(a.getZExtValue(), b.getZExtValue(), &result) ||
+            !fitsUnsigned(result, a.getBitWidth());
+
+        return llvm::APInt(a.getBitWidth(), result);
+    }
+#endif
+
 #if LLVM_VERSION_MAJOR == 2 && LLVM_VERSION_MINOR < 9
     llvm::APInt result = a+b;
     overflow = result.ult(b);
@@ -191,6 +417,17 @@ ssub_ov(const llvm::APInt &a,
         const llvm::APInt &b,
         bool &overflow)
 {
+#ifdef CANAL_OVERFLOW_BUILTINS
+    if (a.getBitWidth() <= 64)
+    {
+        int64_t result;
+        overflow = __builtin_sub_overflow(a.getSExtValue(), b.getSExtValue(), &result) ||
+            !fitsSigned(result, a.getBitWidth());
+
+        return llvm::APInt(a.getBitWidth(), result, true);
+    }
+#endif
+
 #if LLVM_VERSION_MAJOR == 2 && LLVM_VERSION_MINOR < 9
     llvm::APInt result = a - b;
     overflow = a.isNonNegative() != b.isNonNegative() &&
@@ -207,6 +444,17 @@ usub_ov(const llvm::APInt &a,
         const llvm::APInt &b,
         bool &overflow)
 {
+#ifdef CANAL_OVERFLOW_BUILTINS
+    if (a.getBitWidth() <= 64)
+    {
+        uint64_t result;
+        overflow = __builtin_sub_overflow(a.getZExtValue(), b.getZExtValue(), &result) ||
+            !fitsUnsigned(result, a.getBitWidth());
+
+        return llvm::APInt(a.getBitWidth(), result);
+    }
+#endif
+
 #if LLVM_VERSION_MAJOR == 2 && LLVM_VERSION_MINOR < 9
     llvm::APInt result = a-b;
     overflow = result.ugt(a);
@@ -235,6 +483,17 @@ smul_ov(const llvm::APInt &a,
         const llvm::APInt &b,
         bool &overflow)
 {
+#ifdef CANAL_OVERFLOW_BUILTINS
+    if (a.getBitWidth() <= 64)
+    {
+        int64_t result;
+        overflow = __builtin_mul_overflow(a.getSExtValue(), b.getSExtValue(), &result) ||
+            !fitsSigned(result, a.getBitWidth());
+
+        return llvm::APInt(a.getBitWidth(), result, true);
+    }
+#endif
+
 #if LLVM_VERSION_MAJOR == 2 && LLVM_VERSION_MINOR < 9
     llvm::APInt result = a * b;
     if (a != 0 && b != 0)
@@ -253,6 +512,17 @@ umul_ov(const llvm::APInt &a,
         const llvm::APInt &b,
         bool &overflow)
 {
+#ifdef CANAL_OVERFLOW_BUILTINS
+    if (a.getBitWidth() <= 64)
+    {
+        uint64_t result;
+        overflow = __builtin_mul_overflow(a.getZExtValue(), b.getZExtValue(), &result) ||
+            !fitsUnsigned(result, a.getBitWidth());
+
+        return llvm::APInt(a.getBitWidth(), result);
+    }
+#endif
+
 #if LLVM_VERSION_MAJOR == 2
     llvm::APInt result = a * b;
     if (a != 0 && b != 0)
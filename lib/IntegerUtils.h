@@ -2,10 +2,16 @@
 #define LIBCANAL_INTEGER_UTILS_H
 
 #include "Prereq.h"
-#include <set>
+#include <iterator>
+#include <vector>
 
 namespace Canal {
 namespace Integer {
+
+/// Reduced product of the integer domains.  Abstract values of
+/// integer types are its instances.
+typedef Product::Static<Bitfield, Set, Interval> Combined;
+
 namespace Utils {
 
 struct UCompare
@@ -26,7 +32,198 @@ struct SCompare
     }
 };
 
-typedef std::set<llvm::APInt, UCompare> USet;
+/// Inclusive range of integers in unsigned order.
+struct URange
+{
+    llvm::APInt mFrom;
+
+    llvm::APInt mTo;
+
+    URange(const llvm::APInt &from, const llvm::APInt &to)
+        : mFrom(from), mTo(to) {}
+
+    bool operator==(const URange &range) const
+    {
+        return mFrom == range.mFrom && mTo == range.mTo;
+    }
+};
+
+/// Set of integers of the same bit width ordered by unsigned
+/// comparison.  Values are kept as a sorted vector of disjoint,
+/// non-adjacent ranges, so dense sets cost one entry per run of
+/// consecutive values.  Unions and intersections are linear merges
+/// of the ranges.
+class USet
+{
+public:
+    /// Iterates over individual values of all ranges in unsigned
+    /// order.
+    class const_iterator
+    {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef llvm::APInt value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const llvm::APInt *pointer;
+        typedef const llvm::APInt &reference;
+
+        const_iterator() : mRanges(NULL), mIndex(0) {}
+
+        const_iterator(const std::vector<URange> &ranges,
+                       size_t index)
+            : mRanges(&ranges), mIndex(index)
+        {
+            if (mIndex < mRanges->size())
+                mValue = (*mRanges)[mIndex].mFrom;
+        }
+
+        const_iterator(const std::vector<URange> &ranges,
+                       size_t index,
+                       const llvm::APInt &value)
+            : mRanges(&ranges), mIndex(index), mValue(value) {}
+
+        reference operator*() const { return mValue; }
+        pointer operator->() const { return &mValue; }
+
+        const_iterator &operator++()
+        {
+            if (mValue == (*mRanges)[mIndex].mTo)
+            {
+                ++mIndex;
+                if (mIndex < mRanges->size())
+                    mValue = (*mRanges)[mIndex].mFrom;
+            }
+            else
+                ++mValue;
+
+            return *this;
+        }
+
+        const_iterator &operator--()
+        {
+            if (mIndex == mRanges->size() ||
+                mValue == (*mRanges)[mIndex].mFrom)
+            {
+                --mIndex;
+                mValue = (*mRanges)[mIndex].mTo;
+            }
+            else
+                --mValue;
+
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator result(*this);
+            ++*this;
+            return result;
+        }
+
+        const_iterator operator--(int)
+        {
+            const_iterator result(*this);
+            --*this;
+            return result;
+        }
+
+        bool operator==(const const_iterator &it) const
+        {
+            return mIndex == it.mIndex &&
+                (mIndex == mRanges->size() || mValue == it.mValue);
+        }
+
+        bool operator!=(const const_iterator &it) const
+        {
+            return !operator==(it);
+        }
+
+    protected:
+        const std::vector<URange> *mRanges;
+
+        size_t mIndex;
+
+        llvm::APInt mValue;
+    };
+
+    typedef const_iterator iterator;
+
+    const_iterator begin() const { return const_iterator(mRanges, 0); }
+    const_iterator end() const { return const_iterator(mRanges, mRanges.size()); }
+
+    /// Lowest value of a nonempty set.
+    const llvm::APInt &front() const { return mRanges.front().mFrom; }
+
+    /// Highest value of a nonempty set.
+    const llvm::APInt &back() const { return mRanges.back().mTo; }
+
+    const std::vector<URange> &getRanges() const { return mRanges; }
+
+    /// Number of values in the set.  Saturates for huge sets.
+    size_t size() const;
+
+    size_t rangeCount() const { return mRanges.size(); }
+    size_t capacity() const { return mRanges.capacity(); }
+    bool empty() const { return mRanges.empty(); }
+    void clear() { mRanges.clear(); }
+
+    /// Lowest value which is not lower than the given one.
+    const_iterator lower_bound(const llvm::APInt &value) const;
+
+    /// Inserts a single value.
+    void insert(const llvm::APInt &value)
+    {
+        insert(value, value);
+    }
+
+    /// Inserts all values between from and to, both included.
+    void insert(const llvm::APInt &from, const llvm::APInt &to)
+    {
+        append(from, to);
+        normalize();
+    }
+
+    /// Adds a value without keeping the order.  Call normalize()
+    /// after the last value has been appended.
+    void append(const llvm::APInt &value)
+    {
+        append(value, value);
+    }
+
+    void append(const llvm::APInt &from, const llvm::APInt &to)
+    {
+        mRanges.push_back(URange(from, to));
+    }
+
+    /// Sorts the appended ranges and joins the overlapping and
+    /// adjacent ones.
+    void normalize();
+
+    /// Set union.
+    void merge(const USet &set);
+
+    /// Set intersection.
+    void intersect(const USet &set);
+
+    /// Checks whether the sets have a common value.
+    bool intersects(const USet &set) const;
+
+    /// Checks whether all values of this set are in the other one.
+    bool includedIn(const USet &set) const;
+
+    bool operator==(const USet &set) const
+    {
+        return mRanges == set.mRanges;
+    }
+
+    bool operator!=(const USet &set) const
+    {
+        return mRanges != set.mRanges;
+    }
+
+protected:
+    std::vector<URange> mRanges;
+};
 
 typedef llvm::APInt(llvm::APInt::*Operation)(const llvm::APInt&) const;
 
@@ -0,0 +1,150 @@
+#include "InterningTable.h"
+#include "Domain.h"
+#include "Utils.h"
+#include "Environment.h"
+#include "WideningManager.h"
+#include <algorithm>
+
+namespace Canal {
+
+bool InterningTable::ENABLED = false;
+
+/// Initial size of the table that triggers a collection.
+static const size_t MIN_COLLECTION_THRESHOLD = 1024;
+
+InterningTable::InterningTable()
+    : mCollectionThreshold(MIN_COLLECTION_THRESHOLD)
+{
+}
+
+InterningTable::~InterningTable()
+{
+    clear();
+}
+
+void
+InterningTable::intern(SharedDataPointer<Domain> &value)
+{
+    if (!ENABLED || !value || value->mInterned || value->getWideningData())
+        return;
+
+    size_t hash = value->hash();
+    llvm::MutexGuard guard(mMutex);
+    std::pair<Table::iterator, Table::iterator> range =
+        mTable.equal_range(hash);
+
+    for (; range.first != range.second; ++range.first)
+    {
+        const Domain &interned = *range.first->second;
+        if (interned.getKind() == value->getKind() &&
+            &interned.getValueType() == &value->getValueType() &&
+            interned == *value)
+        {
+            value = range.first->second;
+            return;
+        }
+    }
+
+    if (mTable.size() >= mCollectionThreshold)
+        collect();
+
+    // The value is shared with the table from now on, so it is
+    // never modified in place.  It is accounted before other threads
+    // can find it.
+    value->accountMemory();
+    mTable.insert(Table::value_type(hash, value));
+    const_cast<Domain*>(value.data())->mInterned = true;
+}
+
+void
+InterningTable::clear()
+{
+    llvm::MutexGuard guard(mMutex);
+    Table::iterator it = mTable.begin(), itend = mTable.end();
+    for (; it != itend; ++it)
+        const_cast<Domain*>(it->second.data())->mInterned = false;
+
+    mTable.clear();
+    mCollectionThreshold = MIN_COLLECTION_THRESHOLD;
+}
+
+size_t
+InterningTable::size() const
+{
+    llvm::MutexGuard guard(mMutex);
+    return mTable.size();
+}
+
+void
+InterningTable::collect()
+{
+    Table::iterator it = mTable.begin();
+    while (it != mTable.end())
+    {
+        if (it->second->mReferenceCount == 1)
+            mTable.erase(it++);
+        else
+            ++it;
+    }
+
+    mCollectionThreshold = std::max(MIN_COLLECTION_THRESHOLD,
+                                    2 * mTable.size());
+}
+
+void
+intern(SharedDataPointer<Domain> &value)
+{
+    if (!value)
+        return;
+
+    if (InterningTable::ENABLED)
+        value->getEnvironment().getInterningTable().intern(value);
+
+    if (!value->mInterned)
+        value->accountMemory();
+}
+
+bool
+joinValues(SharedDataPointer<Domain> &value,
+           const SharedDataPointer<Domain> &other,
+           const Widening::Point *widening)
+{
+    if (equalValues(value, other))
+        return false;
+
+    SharedDataPointer<Domain> original(value);
+    value.mutable_()->join(*other);
+    if (equalValues(value, original))
+    {
+        value = original;
+        return false;
+    }
+
+    // Widening counts the changes of the value, so it is applied
+    // only when the join changes the value.
+    if (widening)
+    {
+        value = original;
+        Domain *widened = value.mutable_();
+        widening->widen(*widened, *other);
+        widened->join(*other);
+    }
+
+    intern(value);
+    return true;
+}
+
+bool
+equalValues(const SharedDataPointer<Domain> &first,
+            const SharedDataPointer<Domain> &second)
+{
+    if (first == second)
+        return true;
+
+    if (first->mInterned && second->mInterned)
+        return false;
+
+    return *first == *second;
+}
+
+} // namespace Canal
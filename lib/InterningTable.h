@@ -0,0 +1,78 @@
+#ifndef LIBCANAL_INTERNING_TABLE_H
+#define LIBCANAL_INTERNING_TABLE_H
+
+#include "SharedDataPointer.h"
+#include <map>
+
+namespace Canal {
+
+class Domain;
+
+/// Table of canonical abstract values.  Values stored in states are
+/// replaced by an equal value from the table, so duplicate values
+/// share memory, and two interned values are equal exactly when they
+/// are the same object.
+///
+/// The table holds a reference to every interned value.  Interned
+/// values are therefore always shared, and SharedDataPointer copies
+/// them before modification.
+class InterningTable
+{
+public:
+    /// Intern values stored in states.
+    static bool ENABLED;
+
+protected:
+    typedef std::multimap<size_t, SharedDataPointer<Domain> > Table;
+    Table mTable;
+
+    /// Size of the table that triggers the removal of values no
+    /// longer referenced outside of the table.
+    size_t mCollectionThreshold;
+
+    mutable llvm::sys::Mutex mMutex;
+
+public:
+    InterningTable();
+
+    ~InterningTable();
+
+    /// Replace the value by an equal interned value, or intern it if
+    /// none exists.  Values with widening data are not interned, as
+    /// the data are not part of the equality.
+    void intern(SharedDataPointer<Domain> &value);
+
+    /// Remove all values from the table.
+    void clear();
+
+    size_t size() const;
+
+protected:
+    /// Remove values referenced only by the table.
+    void collect();
+};
+
+/// Intern a value in the table of its environment, if interning is
+/// enabled.  Called for every value stored to a state, so the memory
+/// of the value is accounted here as well.
+void intern(SharedDataPointer<Domain> &value);
+
+/// Join a shared value with another one.  When the join does not
+/// change the value, the original shared value is kept.
+/// @param widening
+///   If not NULL, the value is widened before the join when the join
+///   changes it.
+/// @returns
+///   True if the value has changed.
+bool joinValues(SharedDataPointer<Domain> &value,
+                const SharedDataPointer<Domain> &other,
+                const Widening::Point *widening = NULL);
+
+/// Compare two shared values.  Interned values are compared by their
+/// addresses.
+bool equalValues(const SharedDataPointer<Domain> &first,
+                 const SharedDataPointer<Domain> &second);
+
+} // namespace Canal
+
+#endif // LIBCANAL_INTERNING_TABLE_H
@@ -1,22 +1,261 @@
 #include "Interpreter.h"
 #include "Utils.h"
 #include "Pointer.h"
+#include <map>
+#include <set>
 
 namespace Canal {
 namespace Interpreter {
 
+#if LLVM_VERSION_MAJOR > 2
+/// Maps types of a newly loaded module to the types of the
+/// interpreted module.  LLVM renames identified structures when a
+/// structure of the same name already exists in the context, so they
+/// are matched by their base name and their elements.
+class StructTypeMapper : public llvm::ValueMapTypeRemapper
+{
+    std::map<std::string, std::vector<llvm::StructType*> > mStructs;
+
+    std::map<llvm::Type*, llvm::Type*> mMapped;
+
+public:
+    StructTypeMapper(llvm::Module &module)
+    {
+        std::vector<llvm::StructType*> structs;
+        module.findUsedStructTypes(structs);
+        std::vector<llvm::StructType*>::const_iterator it = structs.begin(),
+            itend = structs.end();
+
+        for (; it != itend; ++it)
+        {
+            if (!(*it)->hasName())
+                continue;
+
+            std::string name = getStructBaseName((*it)->getName()).str();
+            mStructs[name].push_back(*it);
+        }
+    }
+
+    virtual llvm::Type *remapType(llvm::Type *type)
+    {
+        std::map<llvm::Type*, llvm::Type*>::const_iterator it =
+            mMapped.find(type);
+
+        if (it != mMapped.end())
+            return it->second;
+
+        llvm::Type *result = map(*type);
+        mMapped[type] = result;
+        return result;
+    }
+
+protected:
+    llvm::Type *map(llvm::Type &type)
+    {
+        llvm::StructType *structType = dynCast<llvm::StructType>(&type);
+        if (structType && structType->hasName())
+            return mapIdentifiedStruct(*structType);
+
+        if (type.getNumContainedTypes() == 0)
+            return &type;
+
+        std::vector<llvm::Type*> elements;
+        bool changed = false;
+        llvm::Type::subtype_iterator it = type.subtype_begin(),
+            itend = type.subtype_end();
+
+        for (; it != itend; ++it)
+        {
+            elements.push_back(remapType(*it));
+            changed |= (elements.back() != *it);
+        }
+
+        if (!changed)
+            return &type;
+
+        switch (type.getTypeID())
+        {
+        case llvm::Type::PointerTyID:
+            return llvm::PointerType::get(
+                elements[0],
+                checkedCast<llvm::PointerType>(type).getAddressSpace());
+        case llvm::Type::ArrayTyID:
+            return llvm::ArrayType::get(
+                elements[0],
+                checkedCast<llvm::ArrayType>(type).getNumElements());
+        case llvm::Type::VectorTyID:
+            return llvm::VectorType::get(
+                elements[0],
+                checkedCast<llvm::VectorType>(type).getNumElements());
+        case llvm::Type::StructTyID:
+            return llvm::StructType::get(type.getContext(),
+                                         elements,
+                                         structType->isPacked());
+        case llvm::Type::FunctionTyID:
+        {
+            std::vector<llvm::Type*> params(elements.begin() + 1,
+                                            elements.end());
+
+            return llvm::FunctionType::get(
+                elements[0],
+                params,
+                checkedCast<llvm::FunctionType>(type).isVarArg());
+        }
+        default:
+            CANAL_DIE_MSG("Unexpected type: " << type);
+        }
+    }
+
+    llvm::Type *mapIdentifiedStruct(llvm::StructType &type)
+    {
+        std::map<std::string, std::vector<llvm::StructType*> >::const_iterator
+            it = mStructs.find(getStructBaseName(type.getName()).str());
+
+        if (it == mStructs.end())
+            return &type;
+
+        std::vector<llvm::StructType*>::const_iterator sit = it->second.begin(),
+            sitend = it->second.end();
+
+        for (; sit != sitend; ++sit)
+        {
+            if (*sit == &type)
+                return &type;
+
+            if ((*sit)->isOpaque() != type.isOpaque() ||
+                (*sit)->isPacked() != type.isPacked() ||
+                (*sit)->getNumElements() != type.getNumElements())
+            {
+                continue;
+            }
+
+            // Assume the structures match while comparing their
+            // elements, so recursive structures terminate.
+            std::map<llvm::Type*, llvm::Type*> mapped(mMapped);
+            mMapped[&type] = *sit;
+            bool equal = true;
+            for (unsigned i = 0; equal && i < type.getNumElements(); ++i)
+                equal = (remapType(type.getElementType(i)) == (*sit)->getElementType(i));
+
+            if (equal)
+                return *sit;
+
+            mMapped.swap(mapped);
+        }
+
+        return &type;
+    }
+};
+
+/// Map the global values of a newly loaded module to the global
+/// values of the interpreted module of the same name.
+/// @returns
+///   False if the global values differ in their names, types or
+///   initializers.
+static bool
+mapGlobalValues(llvm::Module &module,
+                llvm::Module &newModule,
+                llvm::ValueToValueMapTy &valueMap,
+                StructTypeMapper &typeMapper)
+{
+    if (module.getDataLayout() != newModule.getDataLayout() ||
+        module.size() != newModule.size() ||
+        module.global_size() != newModule.global_size() ||
+        module.alias_size() != newModule.alias_size())
+    {
+        return false;
+    }
+
+    std::vector<llvm::GlobalValue*> globals;
+    for (llvm::Module::global_iterator it = newModule.global_begin();
+         it != newModule.global_end(); ++it)
+    {
+        globals.push_back(it);
+    }
+
+    for (llvm::Module::iterator it = newModule.begin();
+         it != newModule.end(); ++it)
+    {
+        globals.push_back(it);
+    }
+
+    for (llvm::Module::alias_iterator it = newModule.alias_begin();
+         it != newModule.alias_end(); ++it)
+    {
+        globals.push_back(it);
+    }
+
+    std::vector<llvm::GlobalValue*>::const_iterator it = globals.begin(),
+        itend = globals.end();
+
+    for (; it != itend; ++it)
+    {
+        if (!(*it)->hasName())
+            return false;
+
+        llvm::GlobalValue *global = module.getNamedValue((*it)->getName());
+        if (!global ||
+            global->getValueID() != (*it)->getValueID() ||
+            global->getType() != typeMapper.remapType((*it)->getType()))
+        {
+            return false;
+        }
+
+        valueMap[*it] = global;
+    }
+
+    // Initial values of global variables are a part of the initial
+    // state of all functions.
+    for (llvm::Module::global_iterator it = newModule.global_begin();
+         it != newModule.global_end(); ++it)
+    {
+        llvm::GlobalVariable &global =
+            checkedCast<llvm::GlobalVariable>(*valueMap[it]);
+
+        if (global.isConstant() != it->isConstant() ||
+            global.hasInitializer() != it->hasInitializer())
+        {
+            return false;
+        }
+
+        if (it->hasInitializer() &&
+            global.getInitializer() != llvm::MapValue(it->getInitializer(),
+                                                      valueMap,
+                                                      llvm::RF_None,
+                                                      &typeMapper))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif
+
 Interpreter::Interpreter(llvm::Module *module)
     : mEnvironment(module),
       mConstructors(mEnvironment),
       mModule(*module, mConstructors),
       mOperationsCallback(mModule, mConstructors),
       mOperations(mEnvironment, mConstructors, mOperationsCallback),
-      mIterator(mModule, mOperations, mWideningManager)
+      mIterator(mModule, mOperations, mWideningManager, mBudget),
+      mParallelIterator(mModule,
+                        mOperations,
+                        mOperationsCallback,
+                        mWideningManager,
+                        mBudget)
 {
 }
 
 Interpreter::~Interpreter()
 {
+    std::vector<llvm::Function*>::const_iterator it = mGraveyard.begin(),
+        itend = mGraveyard.end();
+
+    for (; it != itend; ++it)
+        (*it)->dropAllReferences();
+
+    llvm::DeleteContainerPointers(mGraveyard);
 }
 
 std::string
@@ -29,5 +268,94 @@ Interpreter::toString() const
     return ss.str();
 }
 
+bool
+Interpreter::update(llvm::Module *module, bool converged)
+{
+#if LLVM_VERSION_MAJOR > 2
+    llvm::Module &oldModule = mEnvironment.getModule();
+    StructTypeMapper typeMapper(oldModule);
+    llvm::ValueToValueMapTy valueMap;
+    if (!mapGlobalValues(oldModule, *module, valueMap, typeMapper))
+        return false;
+
+    std::set<const llvm::Function*> changed;
+    llvm::Module::iterator it = module->begin(), itend = module->end();
+    for (; it != itend; ++it)
+    {
+        llvm::Function &function = checkedCast<llvm::Function>(*valueMap[it]);
+        if (function.isDeclaration() == it->isDeclaration() &&
+            (function.isDeclaration() ||
+             getFingerprint(function) == getFingerprint(*it)))
+        {
+            continue;
+        }
+
+        changed.insert(&function);
+
+        // Move the old body away, as abstract values might refer to
+        // its instructions.
+        if (!function.isDeclaration())
+        {
+            llvm::Function *graveyard = llvm::Function::Create(
+                function.getFunctionType(),
+                llvm::GlobalValue::InternalLinkage,
+                function.getName());
+
+            graveyard->getBasicBlockList().splice(
+                graveyard->end(),
+                function.getBasicBlockList());
+
+            // The old body must not be found among the users of
+            // functions and globals of the module, otherwise it would
+            // be treated as a caller of the functions it called.
+            graveyard->dropAllReferences();
+            mGraveyard.push_back(graveyard);
+        }
+
+        if (!it->isDeclaration())
+        {
+            llvm::Function::arg_iterator ait = it->arg_begin(),
+                oit = function.arg_begin();
+
+            for (; ait != it->arg_end(); ++ait, ++oit)
+            {
+                oit->setName(ait->getName());
+                valueMap[ait] = oit;
+            }
+
+            llvm::SmallVector<llvm::ReturnInst*, 8> returns;
+            llvm::CloneFunctionInto(&function,
+                                    it,
+                                    valueMap,
+                                    true,
+                                    returns,
+                                    "",
+                                    NULL,
+                                    &typeMapper);
+        }
+    }
+
+    delete module;
+    if (changed.empty())
+        return true;
+
+    mEnvironment.getSlotTracker().reset();
+    mEnvironment.numberRegisters();
+    mModule.update(changed, mConstructors, converged);
+    mIterator.reset();
+
+    // The kept states might hold collapsed arrays, so the precision
+    // stays lowered for the arrays created from now on.
+    bool degraded = mBudget.isDegraded();
+    mBudget.reset();
+    if (degraded)
+        mBudget.degradePrecision(mModule);
+
+    return true;
+#else
+    return false;
+#endif
+}
+
 } // namespace Interpreter
 } // namespace Canal
@@ -4,8 +4,10 @@
 #include "Constructors.h"
 #include "Environment.h"
 #include "Operations.h"
+#include "InterpreterBudget.h"
 #include "InterpreterModule.h"
 #include "InterpreterIterator.h"
+#include "InterpreterParallelIterator.h"
 #include "InterpreterOperationsCallback.h"
 #include "WideningManager.h"
 #include <vector>
@@ -32,8 +34,18 @@ class Interpreter
 
     Widening::Manager mWideningManager;
 
+    Budget mBudget;
+
     Iterator mIterator;
 
+    ParallelIterator mParallelIterator;
+
+    /// Detached functions holding the bodies that have been replaced
+    /// by update().  Abstract values might still refer to their
+    /// instructions, so they are deleted together with the
+    /// interpreter.
+    std::vector<llvm::Function*> mGraveyard;
+
 public:
     /// @param module
     ///   Interpreter takes ownership of the module.
@@ -75,6 +87,16 @@ public:
         return mIterator;
     }
 
+    ParallelIterator &getParallelIterator()
+    {
+        return mParallelIterator;
+    }
+
+    const Budget &getBudget() const
+    {
+        return mBudget;
+    }
+
     const State &getCurrentState() const
     {
         return mIterator.getCurrentState();
@@ -96,6 +118,21 @@ public:
     }
 
     std::string toString() const;
+
+    /// Update the interpreted module to a new version of the same
+    /// program.  Bodies of the changed functions are copied to the
+    /// interpreted module, and only the changed functions and their
+    /// callers are interpreted again.
+    /// @param module
+    ///   Interpreter takes ownership of the module if the update
+    ///   succeeds.
+    /// @param converged
+    ///   Indication that the interpretation has reached a fixpoint.
+    /// @returns
+    ///   False if the modules differ in global variables, function
+    ///   declarations or types, and the module must be interpreted
+    ///   from scratch.
+    bool update(llvm::Module *module, bool converged);
 };
 
 } // namespace Interpreter
@@ -1,17 +1,42 @@
 #include "InterpreterBasicBlock.h"
 #include "Constructors.h"
 #include "Environment.h"
+#include "WideningManager.h"
 #include "Utils.h"
 
 namespace Canal {
 namespace Interpreter {
 
 BasicBlock::BasicBlock(const llvm::BasicBlock &basicBlock,
+                       unsigned id,
                        const Constructors &constructors)
-    : mBasicBlock(basicBlock), mEnvironment(constructors.getEnvironment())
+    : mBasicBlock(basicBlock),
+      mEnvironment(constructors.getEnvironment()),
+      mId(id)
 {
 }
 
+bool
+BasicBlock::updateOutputState(State &state,
+                              const Widening::Manager *wideningManager,
+                              StateDelta &delta)
+{
+    if (!wideningManager)
+        return mOutputState.merge(state, &delta);
+
+    // The changed entries are widened in place while they are
+    // merged.
+    Widening::Point widening(*wideningManager, mBasicBlock);
+    return mOutputState.merge(state, &delta, &widening);
+}
+
+void
+BasicBlock::transform(ValueTransform &transform)
+{
+    mInputState.transform(transform);
+    mOutputState.transform(transform);
+}
+
 size_t
 BasicBlock::memoryUsage() const
 {
@@ -8,6 +8,10 @@ namespace Canal {
 class Constructors;
 class Environment;
 
+namespace Widening {
+class Manager;
+} // namespace Widening
+
 namespace Interpreter {
 
 class BasicBlock
@@ -15,11 +19,22 @@ class BasicBlock
     const llvm::BasicBlock &mBasicBlock;
     const Environment &mEnvironment;
 
+    /// Position of the basic block in its function.
+    unsigned mId;
+
+    /// Join of the output states of the predecessors, and of the
+    /// function input state for the entry block.
     State mInputState;
+
+    /// Entries changed in the output states of the predecessors since
+    /// mInputState has been updated.
+    StateDelta mInputDelta;
+
     State mOutputState;
 
 public:
     BasicBlock(const llvm::BasicBlock &basicBlock,
+               unsigned id,
                const Constructors &constructors);
 
     const llvm::BasicBlock &getLlvmBasicBlock() const
@@ -27,6 +42,11 @@ public:
         return mBasicBlock;
     }
 
+    unsigned getId() const
+    {
+        return mId;
+    }
+
     llvm::BasicBlock::const_iterator begin() const
     {
         return mBasicBlock.begin();
@@ -42,11 +62,35 @@ public:
         return mInputState;
     }
 
+    StateDelta &getInputDelta()
+    {
+        return mInputDelta;
+    }
+
     State &getOutputState()
     {
         return mOutputState;
     }
 
+    /// Merge a state resulting from the interpretation of this basic
+    /// block to its output state.
+    /// @param state
+    ///   State at the end of the basic block.  It is modified.
+    /// @param wideningManager
+    ///   Widening applied to the changed entries before the merge, or
+    ///   NULL to skip widening.
+    /// @param delta
+    ///   The changed entries of the output state are recorded to it.
+    /// @returns
+    ///   True if the output state has been changed.
+    bool updateOutputState(State &state,
+                           const Widening::Manager *wideningManager,
+                           StateDelta &delta);
+
+    /// Replace the values of the input and output states by their
+    /// transformed copies.
+    void transform(ValueTransform &transform);
+
     /// Get memory usage (used byte count) of this basic block interpretation.
     size_t memoryUsage() const;
 
@@ -0,0 +1,279 @@
+#include "InterpreterBudget.h"
+#include "InterpreterFunction.h"
+#include "InterpreterModule.h"
+#include "ArrayExactSize.h"
+#include "ArrayStringTrie.h"
+#include "ArrayUtils.h"
+#include "IntegerSet.h"
+#include "ValueTransform.h"
+#include "WideningTop.h"
+#include "Utils.h"
+
+namespace Canal {
+namespace Interpreter {
+
+unsigned Budget::TIME = 0;
+unsigned Budget::VISITS = 0;
+size_t Budget::MEMORY = 0;
+unsigned Budget::FUNCTION_TIME = 0;
+unsigned Budget::FUNCTION_VISITS = 0;
+size_t Budget::FUNCTION_MEMORY = 0;
+size_t Budget::DEGRADATION_MEMORY = 0;
+
+/// Integer set threshold used after the precision is degraded.
+static const unsigned DEGRADED_SET_THRESHOLD = 4;
+
+/// String trie size limit used after the precision is degraded.
+static const size_t DEGRADED_TRIE_SIZE = 64;
+
+/// Collapses the exact-size arrays stored in states.
+class CollapseExactSize : public ValueTransform
+{
+protected:
+    virtual Domain *transform(const Domain &value) const
+    {
+        return Array::Utils::collapseExactSize(value);
+    }
+};
+
+Budget::Budget()
+    : mStarted(false),
+      mVisits(0),
+      mMemory(0),
+      mExhausted(false),
+      mExhaustedCount(0),
+      mDegraded(false),
+      mSetThreshold(0),
+      mCollapse(false),
+      mTrieSizeThreshold(0),
+      mTopWideningManager(new Widening::Top())
+{
+}
+
+Budget::~Budget()
+{
+    restorePrecision();
+}
+
+void
+Budget::reset()
+{
+    llvm::MutexGuard guard(mMutex);
+    mFunctions.clear();
+    mStarted = false;
+    mVisits = 0;
+    mMemory = 0;
+    mExhausted = false;
+    mExhaustedCount = 0;
+    restorePrecision();
+}
+
+void
+Budget::addVisit(const Function &function, llvm::sys::TimeValue start)
+{
+    llvm::sys::TimeValue now = llvm::sys::TimeValue::now();
+    llvm::MutexGuard guard(mMutex);
+    if (!mStarted)
+    {
+        mStart = start;
+        mStarted = true;
+    }
+
+    ++mVisits;
+    if ((TIME && (now - mStart).msec() > TIME * (uint64_t)1000) ||
+        (VISITS && mVisits > VISITS))
+    {
+        setExhausted(mExhausted);
+    }
+
+    Usage &usage = getUsage(function);
+    usage.mTime += (now - start).usec();
+    ++usage.mVisits;
+    checkExhausted(usage);
+}
+
+void
+Budget::updateMemoryUsage(const Function &function)
+{
+    if (!MEMORY && !FUNCTION_MEMORY)
+        return;
+
+    size_t memory = function.memoryUsage();
+    llvm::MutexGuard guard(mMutex);
+    Usage &usage = getUsage(function);
+    mMemory = mMemory - usage.mMemory + memory;
+    usage.mMemory = memory;
+    if (MEMORY && mMemory > MEMORY)
+        setExhausted(mExhausted);
+
+    checkExhausted(usage);
+}
+
+void
+Budget::updatePrecision(Module &module)
+{
+    if (DEGRADATION_MEMORY && !isDegraded() &&
+        Domain::getStoredMemory() > DEGRADATION_MEMORY)
+    {
+        degradePrecision(module);
+    }
+}
+
+void
+Budget::degradePrecision(Module &module)
+{
+    {
+        llvm::MutexGuard guard(mMutex);
+        if (mDegraded)
+            return;
+
+        mSetThreshold = Integer::Set::SET_THRESHOLD;
+        mCollapse = Array::ExactSize::COLLAPSE;
+        mTrieSizeThreshold = Array::StringTrie::SIZE_THRESHOLD;
+        mDegraded = true;
+    }
+
+    if (Integer::Set::SET_THRESHOLD > DEGRADED_SET_THRESHOLD)
+        Integer::Set::SET_THRESHOLD = DEGRADED_SET_THRESHOLD;
+
+    Array::ExactSize::COLLAPSE = true;
+
+    if (!Array::StringTrie::SIZE_THRESHOLD ||
+        Array::StringTrie::SIZE_THRESHOLD > DEGRADED_TRIE_SIZE)
+    {
+        Array::StringTrie::SIZE_THRESHOLD = DEGRADED_TRIE_SIZE;
+    }
+
+    // New arrays are created collapsed from now on, so the stored
+    // arrays must be collapsed to stay comparable with them.
+    CollapseExactSize transform;
+    module.transform(transform);
+}
+
+bool
+Budget::isDegraded() const
+{
+    llvm::MutexGuard guard(mMutex);
+    return mDegraded;
+}
+
+bool
+Budget::isExhausted(const Function &function) const
+{
+    if (!isExhausted())
+        return false;
+
+    llvm::MutexGuard guard(mMutex);
+    if (mExhausted)
+        return true;
+
+    std::map<const llvm::Function*, Usage>::const_iterator it =
+        mFunctions.find(&function.getLlvmFunction());
+
+    return it != mFunctions.end() && it->second.mExhausted;
+}
+
+const Widening::Manager *
+Budget::getWideningManager(const Function &function,
+                           const Widening::Manager *wideningManager) const
+{
+    if (isExhausted(function))
+        return &mTopWideningManager;
+
+    return wideningManager;
+}
+
+bool
+Budget::isExhausted() const
+{
+    return llvm::sys::AtomicAdd(&mExhaustedCount, 0) != 0;
+}
+
+std::string
+Budget::toString() const
+{
+    llvm::MutexGuard guard(mMutex);
+    StringStream ss;
+    if (mDegraded)
+    {
+        ss << "Precision degraded after storing "
+           << DEGRADATION_MEMORY << " bytes of abstract values.\n";
+    }
+
+    if (mExhausted)
+    {
+        ss << "Budget of the program exhausted after "
+           << mVisits << " basic blocks";
+
+        if (mStarted)
+        {
+            ss << " and "
+               << (llvm::sys::TimeValue::now() - mStart).msec()
+               << " ms";
+        }
+
+        ss << ".\n";
+    }
+
+    std::map<const llvm::Function*, Usage>::const_iterator it =
+        mFunctions.begin();
+
+    for (; it != mFunctions.end(); ++it)
+    {
+        if (!mExhausted && !it->second.mExhausted)
+            continue;
+
+        ss << "Function " << it->first->getName() << " cut short after "
+           << it->second.mVisits << " basic blocks, "
+           << it->second.mTime / 1000 << " ms";
+
+        if (it->second.mMemory)
+            ss << ", " << it->second.mMemory << " bytes";
+
+        ss << ".\n";
+    }
+
+    return ss.str();
+}
+
+Budget::Usage &
+Budget::getUsage(const Function &function)
+{
+    return mFunctions[&function.getLlvmFunction()];
+}
+
+void
+Budget::checkExhausted(Usage &usage)
+{
+    if ((FUNCTION_TIME && usage.mTime > FUNCTION_TIME * (uint64_t)1000000) ||
+        (FUNCTION_VISITS && usage.mVisits > FUNCTION_VISITS) ||
+        (FUNCTION_MEMORY && usage.mMemory > FUNCTION_MEMORY))
+    {
+        setExhausted(usage.mExhausted);
+    }
+}
+
+void
+Budget::setExhausted(bool &exhausted)
+{
+    if (exhausted)
+        return;
+
+    exhausted = true;
+    llvm::sys::AtomicIncrement(&mExhaustedCount);
+}
+
+void
+Budget::restorePrecision()
+{
+    if (!mDegraded)
+        return;
+
+    Integer::Set::SET_THRESHOLD = mSetThreshold;
+    Array::ExactSize::COLLAPSE = mCollapse;
+    Array::StringTrie::SIZE_THRESHOLD = mTrieSizeThreshold;
+    mDegraded = false;
+}
+
+} // namespace Interpreter
+} // namespace Canal
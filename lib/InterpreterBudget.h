@@ -0,0 +1,177 @@
+#ifndef LIBCANAL_INTERPRETER_BUDGET_H
+#define LIBCANAL_INTERPRETER_BUDGET_H
+
+#include "Prereq.h"
+#include "WideningManager.h"
+#include <map>
+#include <string>
+
+namespace Canal {
+namespace Interpreter {
+
+class Function;
+class Module;
+
+/// Limits of the resources spent by the interpretation, both for the
+/// whole program and for every function.  When a limit is exceeded,
+/// the interpretation of the affected functions stops refining
+/// abstract values.  Every value that still changes is set to top,
+/// so a sound fixpoint is reached quickly.
+class Budget
+{
+public:
+    /// Wall time in seconds spent by the interpretation.  Zero
+    /// disables the limit.
+    static unsigned TIME;
+
+    /// Number of interpreted basic blocks.  Zero disables the limit.
+    static unsigned VISITS;
+
+    /// Memory in bytes used by the abstract states.  Zero disables
+    /// the limit.
+    static size_t MEMORY;
+
+    /// Wall time in seconds spent by interpreting a single function.
+    /// Zero disables the limit.
+    static unsigned FUNCTION_TIME;
+
+    /// Number of interpreted basic blocks of a single function.  Zero
+    /// disables the limit.
+    static unsigned FUNCTION_VISITS;
+
+    /// Memory in bytes used by the abstract states of a single
+    /// function.  Zero disables the limit.
+    static size_t FUNCTION_MEMORY;
+
+    /// Memory in bytes of the abstract values stored in states.  When
+    /// exceeded, the precision of the memory-hungry domains is
+    /// lowered, so the interpretation can finish within the limit.
+    /// Zero disables the limit.
+    static size_t DEGRADATION_MEMORY;
+
+private:
+    struct Usage
+    {
+        /// Wall time in microseconds.  Most basic blocks are
+        /// interpreted in less than a millisecond, so coarser units
+        /// would round every visit to zero.
+        uint64_t mTime;
+
+        unsigned mVisits;
+
+        size_t mMemory;
+
+        bool mExhausted;
+
+        Usage() : mTime(0), mVisits(0), mMemory(0), mExhausted(false)
+        {
+        }
+    };
+
+    /// Resources used by functions.
+    std::map<const llvm::Function*, Usage> mFunctions;
+
+    /// Time of the first interpreted basic block.
+    llvm::sys::TimeValue mStart;
+
+    bool mStarted;
+
+    unsigned mVisits;
+
+    size_t mMemory;
+
+    /// Indication that the budget of the whole program is exhausted.
+    bool mExhausted;
+
+    /// Number of exhausted budgets, including the program budget.
+    /// It is read without the lock, so checking the budget at every
+    /// basic block does not serialize the threads until some budget
+    /// is exhausted.
+    mutable volatile llvm::sys::cas_flag mExhaustedCount;
+
+    /// Indication that the precision of the domains has been lowered.
+    bool mDegraded;
+
+    /// Precision parameters of the domains before they were lowered.
+    /// They are restored when the budget is reset.
+    unsigned mSetThreshold;
+    bool mCollapse;
+    size_t mTrieSizeThreshold;
+
+    /// Widening applied to the functions that exhausted their budget.
+    Widening::Manager mTopWideningManager;
+
+    /// Serializes access from multiple interpreter threads.
+    mutable llvm::sys::Mutex mMutex;
+
+public:
+    Budget();
+
+    /// Restores the precision of the domains, as the parameters are
+    /// shared with other interpreters.
+    ~Budget();
+
+    /// Forget all resources used so far and restore the precision of
+    /// the domains.
+    void reset();
+
+    /// Account an interpretation of a basic block of a function.
+    /// @param start
+    ///   Time when the interpretation of the basic block started.
+    void addVisit(const Function &function, llvm::sys::TimeValue start);
+
+    /// Account the memory used by the states of a function.  Does
+    /// nothing when no memory limit is set.
+    void updateMemoryUsage(const Function &function);
+
+    /// Lower the precision of the domains when the abstract values
+    /// stored in states exceed DEGRADATION_MEMORY.  The precision
+    /// parameters are shared by all threads, so this must be called
+    /// between the rounds of the interpretation, when no basic block
+    /// is being interpreted.
+    void updatePrecision(Module &module);
+
+    /// Lower the precision of the domains consuming most memory:
+    /// shrink integer sets, collapse exact-size arrays and widen
+    /// large string tries.  The arrays already stored in the states
+    /// of the module are collapsed as well.  The same restrictions
+    /// apply as for updatePrecision.
+    void degradePrecision(Module &module);
+
+    /// Check if the precision of the domains has been lowered.
+    bool isDegraded() const;
+
+    /// Check if a function is out of its budget or the whole program
+    /// is out of its budget.
+    bool isExhausted(const Function &function) const;
+
+    /// Get the widening to be applied to basic blocks of a function.
+    /// @param wideningManager
+    ///   Widening used when the function has some budget left.
+    const Widening::Manager *getWideningManager(
+        const Function &function,
+        const Widening::Manager *wideningManager) const;
+
+    /// Check if the interpretation of some function has been cut
+    /// short.
+    bool isExhausted() const;
+
+    /// Describe the exhausted budgets and the functions cut short.
+    std::string toString() const;
+
+protected:
+    Usage &getUsage(const Function &function);
+
+    void checkExhausted(Usage &usage);
+
+    /// Mark a budget as exhausted.  The lock must be held.
+    void setExhausted(bool &exhausted);
+
+    /// Restore the precision parameters saved by degradePrecision.
+    void restorePrecision();
+};
+
+} // namespace Interpreter
+} // namespace Canal
+
+#endif // LIBCANAL_INTERPRETER_BUDGET_H
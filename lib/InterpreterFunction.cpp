@@ -2,15 +2,217 @@
 #include "InterpreterBasicBlock.h"
 #include "Constructors.h"
 #include "Environment.h"
+#include "GarbageCollector.h"
+#include "GlobalStore.h"
 #include "Domain.h"
+#include "WideningManager.h"
 #include "Utils.h"
+#include <algorithm>
 
 namespace Canal {
 namespace Interpreter {
 
+/// Append basic blocks reachable from the entry block to the result
+/// in postorder.  Depth-first search is done without recursion,
+/// because the control flow graphs of generated code can be deep.
+static void
+computePostorder(const llvm::Function &function,
+                 std::vector<const llvm::BasicBlock*> &result)
+{
+    typedef std::pair<const llvm::BasicBlock*,
+                      llvm::succ_const_iterator> StackItem;
+
+    std::set<const llvm::BasicBlock*> visited;
+    std::vector<StackItem> stack;
+    const llvm::BasicBlock *entry = &function.getEntryBlock();
+    visited.insert(entry);
+    stack.push_back(StackItem(entry, llvm::succ_begin(entry)));
+    while (!stack.empty())
+    {
+        StackItem &top = stack.back();
+        if (top.second == llvm::succ_end(top.first))
+        {
+            result.push_back(top.first);
+            stack.pop_back();
+            continue;
+        }
+
+        const llvm::BasicBlock *successor = *top.second;
+        ++top.second;
+        if (visited.insert(successor).second)
+            stack.push_back(StackItem(successor, llvm::succ_begin(successor)));
+    }
+}
+
+/// Append the vertices to the result in a weak topological order.
+/// The order is computed by recursive decomposition of the graph to
+/// strongly connected components.  The vertex of every nontrivial
+/// component that comes first in reverse postorder is the head of
+/// the component.  The rest of the component is decomposed again
+/// without the head.
+/// @param successors
+///   Control flow graph with vertices numbered in reverse postorder.
+/// @param vertices
+///   Sorted vertices of the graph to be ordered.
+static void
+computeWeakTopologicalOrder(const std::vector<std::vector<unsigned> > &successors,
+                           const std::vector<unsigned> &vertices,
+                           std::vector<unsigned> &order,
+                           std::vector<bool> &heads)
+{
+    std::vector<std::vector<unsigned> > components;
+    findStronglyConnectedComponents(successors, vertices, components);
+
+    std::vector<std::vector<unsigned> >::iterator it = components.begin(),
+        itend = components.end();
+
+    for (; it != itend; ++it)
+    {
+        std::sort(it->begin(), it->end());
+        unsigned head = it->front();
+        const std::vector<unsigned> &headSuccessors = successors[head];
+        bool selfLoop = std::find(headSuccessors.begin(),
+                                  headSuccessors.end(),
+                                  head) != headSuccessors.end();
+
+        order.push_back(head);
+        if (it->size() == 1 && !selfLoop)
+            continue;
+
+        heads[head] = true;
+        std::vector<unsigned> rest(it->begin() + 1, it->end());
+        computeWeakTopologicalOrder(successors, rest, order, heads);
+    }
+}
+
+/// Compute the registers live at the end of every basic block.  A
+/// register is live when it might be read later without being
+/// redefined.  Incoming values of phi nodes are read at the end of
+/// the corresponding predecessor.
+/// @param successors
+///   Ids of the control flow graph successors of every basic block.
+/// @param reversePostorder
+///   Ids of the basic blocks in reverse postorder.
+/// @param result
+///   Filled by the live registers of every basic block, sorted by
+///   address and indexed by the basic block id.
+static void
+computeLiveRegisters(const std::vector<BasicBlock*> &basicBlocks,
+                     const llvm::DenseMap<const llvm::BasicBlock*, unsigned> &basicBlockIds,
+                     const std::vector<std::vector<unsigned> > &successors,
+                     const std::vector<unsigned> &reversePostorder,
+                     std::vector<std::vector<const llvm::Value*> > &result)
+{
+    std::vector<std::set<const llvm::Value*> > uses(basicBlocks.size()),
+        liveIn(basicBlocks.size()),
+        liveOut(basicBlocks.size());
+
+    for (unsigned i = 0; i < basicBlocks.size(); ++i)
+    {
+        llvm::BasicBlock::const_iterator iit = basicBlocks[i]->begin(),
+            iitend = basicBlocks[i]->end();
+
+        const llvm::BasicBlock &llvmBasicBlock =
+            basicBlocks[i]->getLlvmBasicBlock();
+
+        for (; iit != iitend; ++iit)
+        {
+            if (const llvm::PHINode *phi = llvm::dyn_cast<llvm::PHINode>(&*iit))
+            {
+                for (unsigned j = 0; j < phi->getNumIncomingValues(); ++j)
+                {
+                    const llvm::Value *value = phi->getIncomingValue(j);
+                    if (!llvm::isa<llvm::Argument>(value) &&
+                        !llvm::isa<llvm::Instruction>(value))
+                    {
+                        continue;
+                    }
+
+                    unsigned id = basicBlockIds.lookup(phi->getIncomingBlock(j));
+                    liveOut[id].insert(value);
+                }
+
+                continue;
+            }
+
+            llvm::User::const_op_iterator oit = iit->op_begin(),
+                oitend = iit->op_end();
+
+            for (; oit != oitend; ++oit)
+            {
+                const llvm::Value *operand = *oit;
+                const llvm::Instruction *instruction =
+                    llvm::dyn_cast<llvm::Instruction>(operand);
+
+                if (llvm::isa<llvm::Argument>(operand) ||
+                    (instruction && instruction->getParent() != &llvmBasicBlock))
+                {
+                    uses[i].insert(operand);
+                }
+            }
+        }
+    }
+
+    // Registers read by phi nodes are live at the end of the
+    // predecessor only.
+    std::vector<std::set<const llvm::Value*> > phiUses(liveOut);
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        std::vector<unsigned>::const_reverse_iterator it =
+            reversePostorder.rbegin(), itend = reversePostorder.rend();
+
+        for (; it != itend; ++it)
+        {
+            std::set<const llvm::Value*> out(phiUses[*it]);
+            std::vector<unsigned>::const_iterator sit =
+                successors[*it].begin(), sitend = successors[*it].end();
+
+            for (; sit != sitend; ++sit)
+                out.insert(liveIn[*sit].begin(), liveIn[*sit].end());
+
+            liveOut[*it].swap(out);
+            std::set<const llvm::Value*> in(uses[*it]);
+            std::set<const llvm::Value*>::const_iterator oit =
+                liveOut[*it].begin(), oitend = liveOut[*it].end();
+
+            for (; oit != oitend; ++oit)
+            {
+                const llvm::Instruction *instruction =
+                    llvm::dyn_cast<llvm::Instruction>(*oit);
+
+                if (!instruction ||
+                    instruction->getParent() !=
+                    &basicBlocks[*it]->getLlvmBasicBlock())
+                {
+                    in.insert(*oit);
+                }
+            }
+
+            // The sets only grow, so comparing their sizes is
+            // enough.
+            if (in.size() == liveIn[*it].size())
+                continue;
+
+            liveIn[*it].swap(in);
+            changed = true;
+        }
+    }
+
+    result.resize(basicBlocks.size());
+    for (unsigned i = 0; i < basicBlocks.size(); ++i)
+        result[i].assign(liveOut[i].begin(), liveOut[i].end());
+}
+
+bool Function::KEEP_DEAD_REGISTERS = false;
+
 Function::Function(const llvm::Function &function,
                    const Constructors &constructors)
-    : mFunction(function), mEnvironment(constructors.getEnvironment())
+    : mFunction(function),
+      mEnvironment(constructors.getEnvironment()),
+      mIterationOrder(ReversePostorder),
+      mGlobalStateShared(false)
 {
     // Initialize input state.
     {
@@ -30,13 +232,148 @@ Function::Function(const llvm::Function &function,
             itend = function.end();
 
         for (; it != itend; ++it)
-            mBasicBlocks.push_back(new BasicBlock(*it, constructors));
+        {
+            unsigned id = mBasicBlocks.size();
+            mBasicBlockIds[&*it] = id;
+            mBasicBlocks.push_back(new BasicBlock(*it, id, constructors));
+
+            llvm::BasicBlock::const_iterator iit = it->begin(),
+                iitend = it->end();
+
+            for (; iit != iitend; ++iit)
+            {
+                unsigned instructionId = mInstructionIds.size();
+                mInstructionIds[&*iit] = instructionId;
+            }
+        }
+    }
+
+    // Initialize the control flow graph.
+    {
+        mPredecessors.resize(mBasicBlocks.size());
+        mSuccessors.resize(mBasicBlocks.size());
+        for (unsigned i = 0; i < mBasicBlocks.size(); ++i)
+        {
+            const llvm::BasicBlock *block = &mBasicBlocks[i]->getLlvmBasicBlock();
+            llvm::succ_const_iterator it = llvm::succ_begin(block),
+                itend = llvm::succ_end(block);
+
+            for (; it != itend; ++it)
+            {
+                unsigned successor = mBasicBlockIds.lookup(*it);
+                mSuccessors[i].push_back(successor);
+                mPredecessors[successor].push_back(i);
+            }
+        }
     }
 
+    // Initialize the iteration order.
+    {
+        std::vector<const llvm::BasicBlock*> postorder;
+        computePostorder(function, postorder);
+
+        const unsigned unnumbered = mBasicBlocks.size();
+        mReversePostorderNumbers.resize(mBasicBlocks.size(), unnumbered);
+        std::vector<const llvm::BasicBlock*>::const_reverse_iterator
+            it = postorder.rbegin(), itend = postorder.rend();
+
+        for (; it != itend; ++it)
+        {
+            unsigned id = mBasicBlockIds.lookup(*it);
+            mReversePostorderNumbers[id] = mReversePostorder.size();
+            mReversePostorder.push_back(id);
+        }
+
+        // Unreachable blocks go last.
+        for (unsigned i = 0; i < mBasicBlocks.size(); ++i)
+        {
+            if (mReversePostorderNumbers[i] != unnumbered)
+                continue;
+
+            mReversePostorderNumbers[i] = mReversePostorder.size();
+            mReversePostorder.push_back(i);
+        }
+
+        // Compute the weak topological order on the control flow
+        // graph with blocks numbered in reverse postorder.
+        std::vector<std::vector<unsigned> > successors(mReversePostorder.size());
+        std::vector<unsigned> vertices;
+        for (unsigned i = 0; i < mReversePostorder.size(); ++i)
+        {
+            const std::vector<unsigned> &blockSuccessors =
+                mSuccessors[mReversePostorder[i]];
+
+            std::vector<unsigned>::const_iterator sit = blockSuccessors.begin(),
+                sitend = blockSuccessors.end();
+
+            for (; sit != sitend; ++sit)
+                successors[i].push_back(mReversePostorderNumbers[*sit]);
+
+            vertices.push_back(i);
+        }
+
+        std::vector<unsigned> order;
+        std::vector<bool> heads(vertices.size(), false);
+        computeWeakTopologicalOrder(successors, vertices, order, heads);
+        mWeakTopologicalOrderNumbers.resize(mBasicBlocks.size());
+        mComponentHeads.resize(mBasicBlocks.size(), false);
+        for (unsigned i = 0; i < order.size(); ++i)
+        {
+            unsigned id = mReversePostorder[order[i]];
+            mWeakTopologicalOrderNumbers[id] = i;
+            mWeakTopologicalOrder.push_back(id);
+            mComponentHeads[id] = heads[order[i]];
+        }
+    }
+
+    // Find the registers read by every basic block.
+    {
+        mUsedRegisters.resize(mBasicBlocks.size());
+        for (unsigned i = 0; i < mBasicBlocks.size(); ++i)
+        {
+            std::set<const llvm::Value*> registers;
+            llvm::BasicBlock::const_iterator iit = mBasicBlocks[i]->begin(),
+                iitend = mBasicBlocks[i]->end();
+
+            for (; iit != iitend; ++iit)
+            {
+                llvm::User::const_op_iterator oit = iit->op_begin(),
+                    oitend = iit->op_end();
+
+                for (; oit != oitend; ++oit)
+                {
+                    const llvm::Value *operand = *oit;
+                    if (llvm::isa<llvm::Instruction>(operand) ||
+                        llvm::isa<llvm::Argument>(operand))
+                    {
+                        registers.insert(operand);
+                    }
+                }
+            }
+
+            std::set<const llvm::Value*>::const_iterator rit = registers.begin();
+            for (; rit != registers.end(); ++rit)
+            {
+                mUsedRegisters[i].push_back(*rit);
+                mRegisterUsers[*rit].push_back(i);
+            }
+        }
+    }
+
+    // Find the registers live at the end of every basic block.
+    computeLiveRegisters(mBasicBlocks,
+                         mBasicBlockIds,
+                         mSuccessors,
+                         mReversePostorder,
+                         mLiveRegisters);
+
     // Initialize output state.
     const llvm::Type *returnType = mFunction.getReturnType();
     if (!returnType->isVoidTy())
         mOutputState.setReturnedValue(constructors.create(*returnType));
+
+    // Nothing has been interpreted yet.
+    scheduleAll();
 }
 
 Function::~Function()
@@ -53,14 +390,25 @@ Function::getLlvmEntryBlock() const
 BasicBlock &
 Function::getBasicBlock(const llvm::BasicBlock &llvmBasicBlock) const
 {
-    std::vector<BasicBlock*>::const_iterator it = mBasicBlocks.begin();
-    for (; it != mBasicBlocks.end(); ++it)
-    {
-        if (&(*it)->getLlvmBasicBlock() == &llvmBasicBlock)
-            return **it;
-    }
+    llvm::DenseMap<const llvm::BasicBlock*, unsigned>::const_iterator it =
+        mBasicBlockIds.find(&llvmBasicBlock);
+
+    CANAL_ASSERT_MSG(it != mBasicBlockIds.end(),
+                     "Failed to find certain basic block.");
+
+    return *mBasicBlocks[it->second];
+}
+
+unsigned
+Function::getInstructionId(const llvm::Instruction &instruction) const
+{
+    llvm::DenseMap<const llvm::Instruction*, unsigned>::const_iterator it =
+        mInstructionIds.find(&instruction);
+
+    CANAL_ASSERT_MSG(it != mInstructionIds.end(),
+                     "Failed to find certain instruction.");
 
-    CANAL_FATAL_ERROR("Failed to find certain basic block.");
+    return it->second;
 }
 
 llvm::StringRef
@@ -69,30 +417,335 @@ Function::getName() const
     return mFunction.getName();
 }
 
+bool
+Function::mergeInputState(const State &state)
+{
+    return mInputState.merge(state);
+}
+
+void
+Function::addPendingInputState(const llvm::Value &place, const State &state)
+{
+    llvm::MutexGuard guard(mPendingInputStatesMutex);
+    mPendingInputStates[&place].merge(state);
+}
+
+bool
+Function::mergePendingInputStates()
+{
+    if (mPendingInputStates.empty())
+        return false;
+
+    bool changed = false;
+    std::map<const llvm::Value*, State>::const_iterator it =
+        mPendingInputStates.begin();
+
+    for (; it != mPendingInputStates.end(); ++it)
+    {
+        if (mInputState.merge(it->second))
+            changed = true;
+    }
+
+    mPendingInputStates.clear();
+    return changed;
+}
+
+void
+Function::addCaller(Function &function,
+                    const llvm::BasicBlock &llvmBasicBlock)
+{
+    unsigned id = function.getBasicBlock(llvmBasicBlock).getId();
+    mCallers.push_back(std::make_pair(&function, id));
+}
+
+void
+Function::setIterationOrder(IterationOrder order)
+{
+    if (order == mIterationOrder)
+        return;
+
+    const std::vector<unsigned> &previousOrder =
+        (mIterationOrder == WeakTopologicalOrder
+         ? mWeakTopologicalOrder
+         : mReversePostorder);
+
+    std::vector<unsigned> scheduled;
+    std::set<unsigned>::const_iterator it = mScheduled.begin(),
+        itend = mScheduled.end();
+
+    for (; it != itend; ++it)
+        scheduled.push_back(previousOrder[*it]);
+
+    mIterationOrder = order;
+    mScheduled.clear();
+    std::vector<unsigned>::const_iterator sit = scheduled.begin();
+    for (; sit != scheduled.end(); ++sit)
+        schedule(*sit);
+}
+
+bool
+Function::isComponentHead(const BasicBlock &basicBlock) const
+{
+    return mComponentHeads[basicBlock.getId()];
+}
+
+void
+Function::schedule(const llvm::BasicBlock &llvmBasicBlock)
+{
+    schedule(getBasicBlock(llvmBasicBlock).getId());
+}
+
+void
+Function::schedule(const BasicBlock &basicBlock)
+{
+    schedule(basicBlock.getId());
+}
+
+void
+Function::schedule(unsigned id)
+{
+    const std::vector<unsigned> &numbers =
+        (mIterationOrder == WeakTopologicalOrder
+         ? mWeakTopologicalOrderNumbers
+         : mReversePostorderNumbers);
+
+    mScheduled.insert(numbers[id]);
+}
+
+void
+Function::scheduleAll()
+{
+    for (unsigned i = 0; i < mBasicBlocks.size(); ++i)
+        mScheduled.insert(i);
+}
+
+void
+Function::scheduleSuccessors(const BasicBlock &basicBlock)
+{
+    const std::vector<unsigned> &successors = mSuccessors[basicBlock.getId()];
+    std::vector<unsigned>::const_iterator it = successors.begin(),
+        itend = successors.end();
+
+    for (; it != itend; ++it)
+        schedule(*it);
+}
+
+void
+Function::scheduleCallers() const
+{
+    std::vector<std::pair<Function*, unsigned> >::const_iterator
+        it = mCallers.begin(), itend = mCallers.end();
+
+    for (; it != itend; ++it)
+        it->first->schedule(it->second);
+}
+
+void
+Function::scheduleUsers(const llvm::Value &value)
+{
+    std::map<const llvm::Value*, std::vector<unsigned> >::const_iterator
+        it = mRegisterUsers.find(&value);
+
+    if (it == mRegisterUsers.end())
+        return;
+
+    std::vector<unsigned>::const_iterator bit = it->second.begin(),
+        bitend = it->second.end();
+
+    for (; bit != bitend; ++bit)
+        schedule(*bit);
+}
+
+std::vector<BasicBlock*>::const_iterator
+Function::popScheduled()
+{
+    CANAL_ASSERT(!mScheduled.empty());
+    unsigned position = *mScheduled.begin();
+    mScheduled.erase(mScheduled.begin());
+    const std::vector<unsigned> &order =
+        (mIterationOrder == WeakTopologicalOrder
+         ? mWeakTopologicalOrder
+         : mReversePostorder);
+
+    return mBasicBlocks.begin() + order[position];
+}
+
 void
 Function::initializeInputState(BasicBlock &basicBlock, State &state) const
 {
     const llvm::BasicBlock &llvmBasicBlock = basicBlock.getLlvmBasicBlock();
-    state.merge(basicBlock.getInputState());
+    State &input = basicBlock.getInputState();
+    StateDelta &delta = basicBlock.getInputDelta();
 
-    // Merge out states of predecessors to input state of
-    // current block.
-    llvm::const_pred_iterator it = llvm::pred_begin(&llvmBasicBlock),
-        itend = llvm::pred_end(&llvmBasicBlock);
+    // Merge the entries changed in out states of predecessors to
+    // input state of current block.
+    if (!delta.empty())
+    {
+        const std::vector<unsigned> &predecessors =
+            mPredecessors[basicBlock.getId()];
 
-    for (; it != itend; ++it)
+        std::vector<unsigned>::const_iterator it = predecessors.begin(),
+            itend = predecessors.end();
+
+        for (; it != itend; ++it)
+            input.merge(mBasicBlocks[*it]->getOutputState(), delta);
+
+        delta.clear();
+    }
+
+    if (&llvmBasicBlock == &getLlvmEntryBlock())
+        input.merge(mInputState);
+
+    state.assign(input);
+}
+
+void
+Function::loadRegisters(const BasicBlock &basicBlock, State &state) const
+{
+    const std::vector<const llvm::Value*> &registers =
+        mUsedRegisters[basicBlock.getId()];
+
+    RegisterFile &variables = state.getFunctionVariables();
+    std::vector<const llvm::Value*>::const_iterator rit = registers.begin(),
+        ritend = registers.end();
+
+    for (; rit != ritend; ++rit)
+    {
+        StateMap::const_iterator value = mRegisters.find(*rit);
+        if (value != mRegisters.end() && variables.find(*rit) == variables.end())
+            variables.insert(*value);
+    }
+}
+
+/// Predicate selecting the results of the instructions of a basic
+/// block.
+struct DefinedIn
+{
+    const llvm::BasicBlock &mBasicBlock;
+
+    DefinedIn(const llvm::BasicBlock &basicBlock)
+        : mBasicBlock(basicBlock)
+    {
+    }
+
+    bool operator()(const llvm::Value *place) const
     {
-        BasicBlock &predBlock = getBasicBlock(**it);
-        state.merge(predBlock.getOutputState());
+        const llvm::Instruction *instruction =
+            llvm::dyn_cast<llvm::Instruction>(place);
+
+        return instruction && instruction->getParent() == &mBasicBlock;
     }
+};
 
+/// Predicate selecting the places of a sorted vector.
+struct ContainedIn
+{
+    const std::vector<const llvm::Value*> &mPlaces;
+
+    ContainedIn(const std::vector<const llvm::Value*> &places)
+        : mPlaces(places)
+    {
+    }
+
+    bool operator()(const llvm::Value *place) const
+    {
+        return std::binary_search(mPlaces.begin(), mPlaces.end(), place);
+    }
+};
+
+bool
+Function::storeRegisters(const BasicBlock &basicBlock,
+                         State &state,
+                         const Widening::Manager *wideningManager)
+{
+    const llvm::BasicBlock &llvmBasicBlock = basicBlock.getLlvmBasicBlock();
+    std::vector<const llvm::Value*> definitions;
+    llvm::BasicBlock::const_iterator iit = llvmBasicBlock.begin(),
+        iitend = llvmBasicBlock.end();
+
+    for (; iit != iitend; ++iit)
+    {
+        if (!iit->getType()->isVoidTy())
+            definitions.push_back(&*iit);
+    }
+
+    // Arguments are defined by the entry block.
     if (&llvmBasicBlock == &getLlvmEntryBlock())
-        state.merge(mInputState);
+    {
+        llvm::Function::const_arg_iterator ait = mFunction.arg_begin(),
+            aitend = mFunction.arg_end();
+
+        for (; ait != aitend; ++ait)
+            definitions.push_back(&*ait);
+    }
+
+    llvm::OwningPtr<Widening::Point> widening;
+    if (wideningManager)
+        widening.reset(new Widening::Point(*wideningManager, llvmBasicBlock));
+
+    bool changed = false;
+    RegisterFile &variables = state.getFunctionVariables();
+    std::vector<const llvm::Value*>::const_iterator it = definitions.begin(),
+        itend = definitions.end();
+
+    for (; it != itend; ++it)
+    {
+        RegisterFile::const_iterator variable = variables.find(*it);
+        if (variable == variables.end())
+            continue;
+
+        if (!mRegisters.join(*variable, widening.get()))
+            continue;
+
+        scheduleUsers(**it);
+        changed = true;
+    }
+
+    // Instruction results are kept in the output state of the basic
+    // block, so they can be printed.
+    variables.retain(DefinedIn(llvmBasicBlock));
+    return changed;
 }
 
 void
+Function::pruneRegisters(const BasicBlock &basicBlock, State &state) const
+{
+    if (KEEP_DEAD_REGISTERS)
+        return;
+
+    const std::vector<const llvm::Value*> &registers =
+        mLiveRegisters[basicBlock.getId()];
+
+    state.getFunctionVariables().retain(ContainedIn(registers));
+}
+
+bool
+Function::updateBasicBlockOutputState(BasicBlock &basicBlock,
+                                      State &state,
+                                      const Widening::Manager *wideningManager)
+{
+    StateDelta delta;
+    if (!basicBlock.updateOutputState(state, wideningManager, delta))
+        return false;
+
+    const std::vector<unsigned> &successors = mSuccessors[basicBlock.getId()];
+    std::vector<unsigned>::const_iterator it = successors.begin(),
+        itend = successors.end();
+
+    for (; it != itend; ++it)
+        mBasicBlocks[*it]->getInputDelta().merge(delta);
+
+    return true;
+}
+
+bool
 Function::updateOutputState()
 {
+    // The function has been interpreted, so its states might hold
+    // new copies of globals.
+    mGlobalStateShared = false;
+
+    bool changed = false;
     std::vector<BasicBlock*>::const_iterator it = mBasicBlocks.begin();
     for (; it != mBasicBlocks.end(); ++it)
     {
@@ -102,19 +755,83 @@ Function::updateOutputState()
         // Merge global blocks, global variables.  Merge function
         // blocks that do not belong to this function.  Merge returned
         // value.
-        mOutputState.mergeGlobal((*it)->getOutputState());
-        mOutputState.mergeReturnedValue((*it)->getOutputState());
-        mOutputState.mergeForeignFunctionBlocks((*it)->getOutputState(),
-                                                mFunction);
+        const State &output = (*it)->getOutputState();
+        if (!GarbageCollector::ENABLED)
+        {
+            if (mOutputState.mergeGlobal(output))
+                changed = true;
+
+            if (mOutputState.mergeReturnedValue(output))
+                changed = true;
+
+            if (mOutputState.mergeForeignFunctionBlocks(output, mFunction))
+                changed = true;
+
+            continue;
+        }
+
+        // Blocks are collected before the merge, so blocks collected
+        // once do not appear as a change on every return.  The
+        // arguments are roots, as they might point to the blocks of
+        // the caller.
+        State returned;
+        returned.mergeGlobal(output);
+        returned.mergeReturnedValue(output);
+        returned.mergeForeignFunctionBlocks(output, mFunction);
+
+        GarbageCollector collector;
+        collector.addRoots(mInputState);
+        collector.collect(returned);
+
+        if (mOutputState.merge(returned))
+            changed = true;
     }
+
+    return changed;
+}
+
+void
+Function::shareGlobalState(const GlobalStore &store)
+{
+    if (mGlobalStateShared)
+        return;
+
+    mGlobalStateShared = true;
+    store.share(mInputState);
+    store.share(mOutputState);
+    std::vector<BasicBlock*>::const_iterator it = mBasicBlocks.begin();
+    for (; it != mBasicBlocks.end(); ++it)
+    {
+        store.share((*it)->getInputState());
+        store.share((*it)->getOutputState());
+    }
+}
+
+void
+Function::transform(ValueTransform &transform)
+{
+    mInputState.transform(transform);
+    mOutputState.transform(transform);
+    mRegisters.transform(transform);
+
+    std::map<const llvm::Value*, State>::iterator it =
+        mPendingInputStates.begin();
+
+    for (; it != mPendingInputStates.end(); ++it)
+        it->second.transform(transform);
+
+    std::vector<BasicBlock*>::const_iterator bit = mBasicBlocks.begin();
+    for (; bit != mBasicBlocks.end(); ++bit)
+        (*bit)->transform(transform);
 }
 
 size_t
 Function::memoryUsage() const
 {
-    size_t result = sizeof(Function) - 2 * sizeof(State);
+    size_t result = sizeof(Function) - 2 * sizeof(State) - sizeof(StateMap);
     result += mInputState.memoryUsage();
     result += mOutputState.memoryUsage();
+    result += mRegisters.memoryUsage();
     std::vector<BasicBlock*>::const_iterator it = mBasicBlocks.begin();
     for (; it != mBasicBlocks.end(); ++it)
         result += (*it)->memoryUsage();
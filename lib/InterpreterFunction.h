@@ -2,12 +2,20 @@
 #define LIBCANAL_INTERPRETER_FUNCTION_H
 
 #include "State.h"
+#include <map>
+#include <set>
+#include <vector>
 
 namespace Canal {
 
 class Domain;
 class Constructors;
 class Environment;
+class GlobalStore;
+
+namespace Widening {
+class Manager;
+} // namespace Widening
 
 namespace Interpreter {
 
@@ -15,11 +23,109 @@ class BasicBlock;
 
 class Function
 {
+public:
+    /// Order in which the scheduled basic blocks are interpreted.
+    enum IterationOrder {
+        ReversePostorder,
+        /// Inner loops are stabilized before the outer ones.
+        WeakTopologicalOrder
+    };
+
+    /// Keep registers that are not read later in the output states
+    /// of basic blocks, so they can be printed.
+    static bool KEEP_DEAD_REGISTERS;
+
+private:
     const llvm::Function &mFunction;
     const Environment &mEnvironment;
 
+    /// Basic blocks in the order of the LLVM function.  The
+    /// position of a basic block is its id.
     std::vector<BasicBlock*> mBasicBlocks;
 
+    /// Ids of basic blocks.
+    llvm::DenseMap<const llvm::BasicBlock*, unsigned> mBasicBlockIds;
+
+    /// Ids of instructions.  Instructions are numbered in the order
+    /// of basic blocks.
+    llvm::DenseMap<const llvm::Instruction*, unsigned> mInstructionIds;
+
+    /// Ids of the control flow graph predecessors of every basic
+    /// block, indexed by the basic block id.
+    std::vector<std::vector<unsigned> > mPredecessors;
+
+    /// Ids of the control flow graph successors of every basic
+    /// block, indexed by the basic block id.
+    std::vector<std::vector<unsigned> > mSuccessors;
+
+    /// Ids of basic blocks in reverse postorder of the control flow
+    /// graph.  Blocks unreachable from the entry block are placed at
+    /// the end.
+    std::vector<unsigned> mReversePostorder;
+
+    /// Positions of basic blocks in mReversePostorder, indexed by the
+    /// basic block id.
+    std::vector<unsigned> mReversePostorderNumbers;
+
+    /// Ids of basic blocks in a weak topological order of the
+    /// control flow graph.  Every loop is a contiguous component
+    /// that starts with its head.
+    std::vector<unsigned> mWeakTopologicalOrder;
+
+    /// Positions of basic blocks in mWeakTopologicalOrder, indexed by
+    /// the basic block id.
+    std::vector<unsigned> mWeakTopologicalOrderNumbers;
+
+    /// Indication that a basic block is a head of a component of the
+    /// weak topological order, indexed by the basic block id.  These
+    /// are the basic blocks where widening needs to be applied.
+    std::vector<bool> mComponentHeads;
+
+    IterationOrder mIterationOrder;
+
+    /// Indication that the globals of the states have been shared
+    /// with the global store since the function was last
+    /// interpreted.  States that did not change keep referring to
+    /// the memory of an older version of the store, which stays
+    /// valid, so they are not walked again.
+    bool mGlobalStateShared;
+
+    /// Positions in the iteration order of the basic blocks that are
+    /// waiting to be interpreted.  Used by the worklist iteration.
+    std::set<unsigned> mScheduled;
+
+    /// Basic blocks of other functions (or this one) that call this
+    /// function.  They need to be interpreted again when the output
+    /// state of this function changes.
+    /// The basic blocks are identified by their ids.
+    std::vector<std::pair<Function*, unsigned> > mCallers;
+
+    /// Input states of the calls of this function that have not yet
+    /// been merged to mInputState, indexed by the call instruction.
+    /// Used by the parallel iteration, which must not modify the
+    /// input state while other threads interpret the function.
+    std::map<const llvm::Value*, State> mPendingInputStates;
+
+    /// Guards mPendingInputStates.
+    llvm::sys::Mutex mPendingInputStatesMutex;
+
+    /// Values of the registers (instructions and arguments of this
+    /// function) used by the sparse propagation.  A register has a
+    /// single value joined from all interpretations of its
+    /// definition.
+    StateMap mRegisters;
+
+    /// Registers defined outside of a basic block that are read by
+    /// its instructions, indexed by the basic block id.
+    std::vector<std::vector<const llvm::Value*> > mUsedRegisters;
+
+    /// Ids of basic blocks reading a register.
+    std::map<const llvm::Value*, std::vector<unsigned> > mRegisterUsers;
+
+    /// Registers that might be read after the end of a basic block,
+    /// indexed by the basic block id.  Sorted by address.
+    std::vector<std::vector<const llvm::Value*> > mLiveRegisters;
+
     // Function arguments, global variables.
     State mInputState;
 
@@ -41,6 +147,14 @@ public:
 
     BasicBlock &getBasicBlock(const llvm::BasicBlock &llvmBasicBlock) const;
 
+    BasicBlock &getBasicBlock(unsigned id) const
+    {
+        return *mBasicBlocks[id];
+    }
+
+    /// Get the id of an instruction of this function.
+    unsigned getInstructionId(const llvm::Instruction &instruction) const;
+
     std::vector<BasicBlock*>::const_iterator begin() const
     {
         return mBasicBlocks.begin();
@@ -73,20 +187,138 @@ public:
 
     llvm::StringRef getName() const;
 
+    /// Merge a state to the function input state.
+    /// @returns
+    ///   True if the input state has been changed by the merge.
+    bool mergeInputState(const State &state);
+
+    /// Store a state to be merged to the function input state later.
+    /// Can be called from multiple threads.
+    /// @param place
+    ///   Instruction calling this function.
+    void addPendingInputState(const llvm::Value &place, const State &state);
+
+    /// Merge all pending states to the function input state.
+    /// @returns
+    ///   True if the input state has been changed by the merge.
+    bool mergePendingInputStates();
+
+    /// Register a basic block that calls this function.
+    void addCaller(Function &function, const llvm::BasicBlock &llvmBasicBlock);
+
+    /// Unregister all callers.
+    void clearCallers()
+    {
+        mCallers.clear();
+    }
+
+    /// Set the order of worklist iteration.  The scheduled basic
+    /// blocks remain scheduled.
+    void setIterationOrder(IterationOrder order);
+
+    /// Check if a basic block is a head of a component in the weak
+    /// topological order.
+    bool isComponentHead(const BasicBlock &basicBlock) const;
+
+    /// Schedule a basic block of this function for interpretation.
+    void schedule(const llvm::BasicBlock &llvmBasicBlock);
+
+    /// Schedule all basic blocks of this function for interpretation.
+    void scheduleAll();
+
+    /// Schedule a basic block of this function for interpretation.
+    void schedule(const BasicBlock &basicBlock);
+
+    /// Schedule the CFG successors of a basic block.
+    void scheduleSuccessors(const BasicBlock &basicBlock);
+
+    /// Schedule all basic blocks calling this function.
+    void scheduleCallers() const;
+
+    bool hasScheduled() const
+    {
+        return !mScheduled.empty();
+    }
+
+    /// Remove all basic blocks from the schedule.
+    void clearSchedule()
+    {
+        mScheduled.clear();
+    }
+
+    /// Remove the scheduled basic block that is the first one in
+    /// the iteration order from the schedule.
+    /// @returns
+    ///   Position of the basic block in mBasicBlocks.
+    std::vector<BasicBlock*>::const_iterator popScheduled();
+
     /// Update basic block input state from its predecessors and
-    /// function input state.
+    /// function input state, and make the state equal to it.  Only
+    /// the entries changed in the output states of the predecessors
+    /// are merged.
     /// @param basicBlock
     ///    Must be a member of this function.
     ///    Its input state is updated.
     void initializeInputState(BasicBlock &basicBlock, State &state) const;
 
+    /// Add the values of registers read by a basic block to a state.
+    /// Used by the sparse propagation.
+    void loadRegisters(const BasicBlock &basicBlock, State &state) const;
+
+    /// Store the registers defined by a basic block to the register
+    /// file and schedule the basic blocks that read the changed ones.
+    /// Registers defined in other basic blocks are removed from the
+    /// state, so they are not propagated through the control flow
+    /// graph.  Used by the sparse propagation.
+    /// @param wideningManager
+    ///   Widening applied to changed registers, or NULL.
+    /// @returns
+    ///   True if some register has been changed.
+    bool storeRegisters(const BasicBlock &basicBlock,
+                        State &state,
+                        const Widening::Manager *wideningManager);
+
+    /// Remove the registers that are not read after the end of a
+    /// basic block from a state, unless KEEP_DEAD_REGISTERS is set.
+    /// Called before the state is merged to the output state of the
+    /// basic block.
+    void pruneRegisters(const BasicBlock &basicBlock, State &state) const;
+
+    /// Merge a state resulting from the interpretation of a basic
+    /// block to its output state.  The changed entries are recorded
+    /// in the input deltas of the successors of the basic block.
+    /// @returns
+    ///   True if the output state has been changed.
+    bool updateBasicBlockOutputState(BasicBlock &basicBlock,
+                                     State &state,
+                                     const Widening::Manager *wideningManager);
+
     /// Update function output state from basic block output states.
-    void updateOutputState();
+    /// @returns
+    ///   True if the output state has been changed.
+    bool updateOutputState();
+
+    /// Make the globals in the states of this function and its basic
+    /// blocks share the memory of the global store, where equal.
+    /// Does nothing unless the function has been interpreted since
+    /// the last call.
+    void shareGlobalState(const GlobalStore &store);
+
+    /// Replace the values of all states of the function by their
+    /// transformed copies.
+    void transform(ValueTransform &transform);
 
     /// Get memory usage (used byte count) of this function interpretation.
     size_t memoryUsage() const;
 
     std::string toString() const;
+
+protected:
+    /// Schedule a basic block identified by its id.
+    void schedule(unsigned id);
+
+    /// Schedule all basic blocks reading a register.
+    void scheduleUsers(const llvm::Value &value);
 };
 
 } // namespace Interpreter
@@ -1,4 +1,5 @@
 #include "InterpreterIterator.h"
+#include "InterpreterBudget.h"
 #include "InterpreterModule.h"
 #include "InterpreterFunction.h"
 #include "InterpreterBasicBlock.h"
@@ -14,17 +15,32 @@ namespace Interpreter {
 
 static IteratorCallback emptyCallback;
 
+Iterator::Strategy Iterator::STRATEGY = Iterator::RoundRobinStrategy;
+
+bool Iterator::SPARSE = false;
+
 Iterator::Iterator(Module &module,
                    Operations &operations,
-                   Widening::Manager &wideningManager)
+                   Widening::Manager &wideningManager,
+                   Budget &budget)
     : mModule(module),
       mOperations(operations),
       mWideningManager(wideningManager),
+      mBudget(budget),
+      mStrategy(STRATEGY),
+      mSparse(false),
       mChanged(true),
       mInitialized(false),
-      mState(new State()),
       mCallback(&emptyCallback)
 {
+    reset();
+}
+
+void
+Iterator::reset()
+{
+    mInitialized = false;
+    mChanged = true;
     if (!mModule.empty())
     {
         mFunction = --mModule.end();
@@ -39,19 +55,75 @@ Iterator::Iterator(Module &module,
 void
 Iterator::initialize()
 {
+    // A module without defined functions has nothing to interpret.
+    if (mModule.empty())
+    {
+        mCallback->onFixpointReached();
+        return;
+    }
+
+    // The basic block being interpreted by a worklist strategy has
+    // already been removed from the schedule.  The round-robin
+    // strategy does not use the schedule.
+    if (mInitialized &&
+        mStrategy != RoundRobinStrategy &&
+        STRATEGY != RoundRobinStrategy)
+    {
+        (*mFunction)->schedule((*mBasicBlock)->getLlvmBasicBlock());
+    }
+
     mInitialized = true;
-    nextInstruction();
+    mStrategy = STRATEGY;
+    mSparse = SPARSE && mStrategy != RoundRobinStrategy;
+    if (mStrategy == RoundRobinStrategy)
+    {
+        nextInstruction();
+        return;
+    }
+
+    Function::IterationOrder order = Function::ReversePostorder;
+    if (mStrategy == WeakTopologicalOrderStrategy)
+        order = Function::WeakTopologicalOrder;
+
+    std::vector<Function*>::const_iterator it = mModule.begin(),
+        itend = mModule.end();
+
+    for (; it != itend; ++it)
+        (*it)->setIterationOrder(order);
+
+    // Every defined function belongs to exactly one call graph
+    // component, so the components are not empty.
+    CANAL_ASSERT_MSG(!mModule.getCallGraphComponents().empty(),
+                     "Call graph components of a nonempty module are missing.");
+
+    mComponent = mModule.getCallGraphComponents().begin();
+    CANAL_ASSERT(!mComponent->empty());
+    mFunction = mComponent->begin();
+    mCallback->onModuleEnter();
+    if ((*mFunction)->hasScheduled())
+        mCallback->onFunctionEnter(**mFunction);
+    else
+        enterNextScheduledFunction();
+
+    enterBasicBlock((*mFunction)->popScheduled());
+    mCallback->onInstructionEnter(*mInstruction);
 }
 
 void
 Iterator::interpretInstruction()
 {
     // Interpret the instruction.
-    mOperations.interpretInstruction(*mInstruction, *mState);
+    mOperations.interpretInstruction(*mInstruction, mState);
 
     // Leave the instruction.
     mCallback->onInstructionExit(*mInstruction);
 
+    if (mStrategy != RoundRobinStrategy)
+    {
+        nextWorklistInstruction();
+        return;
+    }
+
     if (mInstruction == --(*mBasicBlock)->end())
     {
         mCallback->onBasicBlockExit(**mBasicBlock);
@@ -59,11 +131,13 @@ Iterator::interpretInstruction()
         if (mBasicBlock == --(*mFunction)->end())
         {
             (*mFunction)->updateOutputState();
+            mBudget.updateMemoryUsage(**mFunction);
             mCallback->onFunctionExit(**mFunction);
 
             if (mFunction == --mModule.end())
             {
                 mModule.updateGlobalState();
+                mBudget.updatePrecision(mModule);
                 mCallback->onModuleExit();
             }
         }
@@ -73,6 +147,20 @@ Iterator::interpretInstruction()
     nextInstruction();
 }
 
+void
+Iterator::runToFixpoint()
+{
+    reset();
+    mStrategy = STRATEGY;
+    mSparse = SPARSE && mStrategy != RoundRobinStrategy;
+
+    bool notifyFixpoint = (mCallback != &emptyCallback);
+    if (mStrategy == RoundRobinStrategy)
+        runRoundRobinToFixpoint(notifyFixpoint);
+    else
+        runWorklistToFixpoint(notifyFixpoint);
+}
+
 std::string
 Iterator::toString() const
 {
@@ -94,7 +182,7 @@ Iterator::toString() const
             if (it->getType()->isVoidTy())
                 continue;
 
-            ss << mState->toString(*it, slotTracker);
+            ss << mState.toString(*it, slotTracker);
         }
     }
     else
@@ -111,16 +199,8 @@ Iterator::nextInstruction()
 
     if (mInstruction == (*mBasicBlock)->end())
     {
-        mState->merge((*mBasicBlock)->getOutputState());
-        if (*mState != (*mBasicBlock)->getOutputState())
-        {
-            mWideningManager.widen((*mBasicBlock)->getLlvmBasicBlock(),
-                                   (*mBasicBlock)->getOutputState(),
-                                   *mState);
-
-            (*mBasicBlock)->getOutputState().merge(*mState);
+        if (updateBasicBlockOutputState())
             mChanged = true;
-        }
 
         ++mBasicBlock;
 
@@ -142,15 +222,262 @@ Iterator::nextInstruction()
             mCallback->onFunctionEnter(**mFunction);
         }
 
-        delete mState;
-        mState = new State((*mBasicBlock)->getInputState());
-        (*mFunction)->initializeInputState(**mBasicBlock, *mState);
-        mInstruction = (*mBasicBlock)->begin();
-        mCallback->onBasicBlockEnter(**mBasicBlock);
+        enterBasicBlock(mBasicBlock);
     }
 
     mCallback->onInstructionEnter(*mInstruction);
 }
 
+void
+Iterator::nextWorklistInstruction()
+{
+    ++mInstruction;
+
+    if (mInstruction == (*mBasicBlock)->end())
+    {
+        mCallback->onBasicBlockExit(**mBasicBlock);
+        if (updateBasicBlockOutputState())
+            (*mFunction)->scheduleSuccessors(**mBasicBlock);
+
+        if (!(*mFunction)->hasScheduled())
+        {
+            if ((*mFunction)->updateOutputState())
+                (*mFunction)->scheduleCallers();
+
+            mBudget.updateMemoryUsage(**mFunction);
+            mCallback->onFunctionExit(**mFunction);
+            enterNextScheduledFunction();
+        }
+
+        enterBasicBlock((*mFunction)->popScheduled());
+    }
+
+    mCallback->onInstructionEnter(*mInstruction);
+}
+
+void
+Iterator::enterNextScheduledFunction()
+{
+    const std::vector<std::vector<Function*> > &components =
+        mModule.getCallGraphComponents();
+
+    do
+    {
+        ++mFunction;
+        if (mFunction != mComponent->end())
+            continue;
+
+        // Iterate inside the call graph component until it
+        // converges, then move to its callers.
+        bool scheduled = false;
+        std::vector<Function*>::const_iterator it = mComponent->begin(),
+            itend = mComponent->end();
+
+        for (; it != itend && !scheduled; ++it)
+            scheduled = (*it)->hasScheduled();
+
+        if (!scheduled)
+            ++mComponent;
+
+        if (mComponent == components.end())
+        {
+            mModule.updateGlobalState();
+            mBudget.updatePrecision(mModule);
+            mCallback->onModuleExit();
+
+            it = mModule.begin();
+            itend = mModule.end();
+            for (; it != itend && !scheduled; ++it)
+                scheduled = (*it)->hasScheduled();
+
+            if (!scheduled)
+            {
+                mCallback->onFixpointReached();
+
+                // Continue with a new round over the whole program
+                // to keep the iterator running.
+                for (it = mModule.begin(); it != itend; ++it)
+                    (*it)->scheduleAll();
+            }
+
+            mComponent = components.begin();
+            mCallback->onModuleEnter();
+        }
+
+        CANAL_ASSERT(!mComponent->empty());
+        mFunction = mComponent->begin();
+    } while (!(*mFunction)->hasScheduled());
+
+    mCallback->onFunctionEnter(**mFunction);
+}
+
+void
+Iterator::enterBasicBlock(std::vector<BasicBlock*>::const_iterator basicBlock)
+{
+    mBasicBlock = basicBlock;
+    (*mFunction)->initializeInputState(**mBasicBlock, mState);
+    if (mSparse)
+        (*mFunction)->loadRegisters(**mBasicBlock, mState);
+
+    mInstruction = (*mBasicBlock)->begin();
+    mBasicBlockStart = llvm::sys::TimeValue::now();
+    mCallback->onBasicBlockEnter(**mBasicBlock);
+}
+
+void
+Iterator::runRoundRobinToFixpoint(bool notifyFixpoint)
+{
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        std::vector<Function*>::const_iterator it = mModule.begin(),
+            itend = mModule.end();
+
+        for (; it != itend; ++it)
+        {
+            std::vector<BasicBlock*>::const_iterator bit = (*it)->begin(),
+                bitend = (*it)->end();
+
+            for (; bit != bitend; ++bit)
+                changed |= interpretBasicBlock(**it, **bit);
+
+            (*it)->updateOutputState();
+            mBudget.updateMemoryUsage(**it);
+        }
+
+        mModule.updateGlobalState();
+        mBudget.updatePrecision(mModule);
+    }
+
+    if (notifyFixpoint)
+        mCallback->onFixpointReached();
+}
+
+void
+Iterator::runWorklistToFixpoint(bool notifyFixpoint)
+{
+    Function::IterationOrder order = Function::ReversePostorder;
+    if (mStrategy == WeakTopologicalOrderStrategy)
+        order = Function::WeakTopologicalOrder;
+
+    std::vector<Function*>::const_iterator it = mModule.begin(),
+        itend = mModule.end();
+
+    for (; it != itend; ++it)
+        (*it)->setIterationOrder(order);
+
+    const std::vector<std::vector<Function*> > &components =
+        mModule.getCallGraphComponents();
+
+    bool scheduled = true;
+    while (scheduled)
+    {
+        std::vector<std::vector<Function*> >::const_iterator
+            cit = components.begin(),
+            citend = components.end();
+
+        // Iterate inside every call graph component until it
+        // converges, then move to its callers.
+        for (; cit != citend; ++cit)
+        {
+            do
+            {
+                scheduled = false;
+                for (it = cit->begin(); it != cit->end(); ++it)
+                {
+                    Function &function = **it;
+                    if (!function.hasScheduled())
+                        continue;
+
+                    while (function.hasScheduled())
+                    {
+                        BasicBlock &basicBlock = **function.popScheduled();
+                        if (interpretBasicBlock(function, basicBlock))
+                            function.scheduleSuccessors(basicBlock);
+                    }
+
+                    if (function.updateOutputState())
+                        function.scheduleCallers();
+
+                    mBudget.updateMemoryUsage(function);
+                }
+
+                for (it = cit->begin(); it != cit->end() && !scheduled; ++it)
+                    scheduled = (*it)->hasScheduled();
+            } while (scheduled);
+        }
+
+        mModule.updateGlobalState();
+        mBudget.updatePrecision(mModule);
+        for (it = mModule.begin(); it != itend && !scheduled; ++it)
+            scheduled = (*it)->hasScheduled();
+    }
+
+    if (notifyFixpoint)
+        mCallback->onFixpointReached();
+}
+
+bool
+Iterator::interpretBasicBlock(Function &function, BasicBlock &basicBlock)
+{
+    llvm::sys::TimeValue start = llvm::sys::TimeValue::now();
+    function.initializeInputState(basicBlock, mState);
+    if (mSparse)
+        function.loadRegisters(basicBlock, mState);
+
+    llvm::BasicBlock::const_iterator it = basicBlock.begin(),
+        itend = basicBlock.end();
+
+    for (; it != itend; ++it)
+        mOperations.interpretInstruction(*it, mState);
+
+    const Widening::Manager *wideningManager = &mWideningManager;
+    if (mStrategy == WeakTopologicalOrderStrategy &&
+        !function.isComponentHead(basicBlock))
+    {
+        wideningManager = NULL;
+    }
+
+    mBudget.addVisit(function, start);
+    wideningManager = mBudget.getWideningManager(function, wideningManager);
+
+    if (mSparse)
+        function.storeRegisters(basicBlock, mState, wideningManager);
+
+    function.pruneRegisters(basicBlock, mState);
+
+    return function.updateBasicBlockOutputState(basicBlock,
+                                                mState,
+                                                wideningManager);
+}
+
+bool
+Iterator::updateBasicBlockOutputState()
+{
+    // Every cycle in the control flow graph goes through a component
+    // head, so widening elsewhere is not needed for termination.
+    const Widening::Manager *wideningManager = &mWideningManager;
+    if (mStrategy == WeakTopologicalOrderStrategy &&
+        !(*mFunction)->isComponentHead(**mBasicBlock))
+    {
+        wideningManager = NULL;
+    }
+
+    // Stop refining the values when the budget is exhausted.
+    mBudget.addVisit(**mFunction, mBasicBlockStart);
+    wideningManager = mBudget.getWideningManager(**mFunction,
+                                                 wideningManager);
+
+    if (mSparse)
+        (*mFunction)->storeRegisters(**mBasicBlock, mState, wideningManager);
+
+    (*mFunction)->pruneRegisters(**mBasicBlock, mState);
+
+    return (*mFunction)->updateBasicBlockOutputState(**mBasicBlock,
+                                                      mState,
+                                                      wideningManager);
+}
+
 } // namespace Interpreter
 } // namespace Canal
@@ -17,6 +17,7 @@ namespace Interpreter {
 
 class Module;
 class BasicBlock;
+class Budget;
 class Function;
 class IteratorCallback;
 
@@ -24,9 +25,42 @@ class IteratorCallback;
 /// fixpoint is reached.
 class Iterator
 {
+public:
+    enum Strategy {
+        /// Interpret all basic blocks of all functions in every
+        /// round until no abstract state changes.
+        RoundRobinStrategy,
+        /// Interpret only the basic blocks whose input might have
+        /// changed.  Blocks of a function are interpreted in reverse
+        /// postorder, functions bottom-up in the call graph.
+        WorklistStrategy,
+        /// Worklist iteration in a weak topological order of basic
+        /// blocks, which stabilizes inner loops before the outer
+        /// ones.  Widening is applied only at the loop heads.
+        WeakTopologicalOrderStrategy
+    };
+
+    /// Strategy used by iterators when they are initialized.
+    static Strategy STRATEGY;
+
+    /// Propagate the values of registers along def-use chains instead
+    /// of passing them through the states of all basic blocks.  Only
+    /// memory flows through the control flow graph then.  Used by the
+    /// worklist strategies.
+    static bool SPARSE;
+
+private:
     Module &mModule;
     Operations &mOperations;
     Widening::Manager &mWideningManager;
+    Budget &mBudget;
+
+    /// Strategy selected during initialization.
+    Strategy mStrategy;
+
+    /// Sparse propagation of registers selected during
+    /// initialization.
+    bool mSparse;
 
     /// Indication of changed abstract state during last loop through
     /// the program.
@@ -36,8 +70,13 @@ class Iterator
     /// iterating.
     bool mInitialized;
 
+    /// Call graph component of the current function.  Used by the
+    /// worklist strategies, which interpret the components bottom-up.
+    std::vector<std::vector<Function*> >::const_iterator mComponent;
+
     /// Function of the instruction that will be interpreted in the
-    /// next step.
+    /// next step.  The worklist strategies iterate over the functions
+    /// of mComponent instead of the whole module.
     std::vector<Function*>::const_iterator mFunction;
 
     /// Basic block of the instruction that will be interpreted in the
@@ -47,8 +86,13 @@ class Iterator
     /// The instruction that will be interpreted in the next step.
     llvm::BasicBlock::const_iterator mInstruction;
 
-    /// Current state.
-    State *mState;
+    /// Current state.  The same state is refilled for every basic
+    /// block.
+    State mState;
+
+    /// Time when the interpretation of the current basic block
+    /// started.
+    llvm::sys::TimeValue mBasicBlockStart;
 
     /// Callback functions.
     IteratorCallback *mCallback;
@@ -56,14 +100,31 @@ class Iterator
 public:
     Iterator(Module &module,
              Operations &operations,
-             Widening::Manager &wideningManager);
-
+             Widening::Manager &wideningManager,
+             Budget &budget);
+
+    /// Start the iteration.  Functions of the module are
+    /// interpreted until nothing remains scheduled, so the schedule
+    /// left by a previous run or a module update is respected.  A
+    /// module without defined functions reaches the fixpoint at once
+    /// and the iterator stays uninitialized.
     void initialize();
 
+    /// Forget the position of the iteration.  Must be called when
+    /// the functions of the module change.
+    void reset();
+
     /// One step of the interpreter.  Interprets the instruction
     /// and moves to the next one.
     void interpretInstruction();
 
+    /// Interpret the whole program until a fixpoint is reached.
+    /// Whole basic blocks are interpreted at once, and only the
+    /// fixpoint callback is called, so it is much faster than
+    /// stepping through the instructions.  The iterator is left
+    /// uninitialized.
+    void runToFixpoint();
+
     void setCallback(IteratorCallback &callback)
     {
         mCallback = &callback;
@@ -76,7 +137,7 @@ public:
 
     const State &getCurrentState() const
     {
-        return *mState;
+        return mState;
     }
 
     const Function &getCurrentFunction() const
@@ -94,10 +155,49 @@ public:
         return *mInstruction;
     }
 
+    Strategy getStrategy() const
+    {
+        return mStrategy;
+    }
+
     std::string toString() const;
 
 protected:
     void nextInstruction();
+
+    /// Move to the next instruction using a worklist strategy.
+    void nextWorklistInstruction();
+
+    /// Move to the next function that has some basic blocks
+    /// scheduled for interpretation.  Functions of a call graph
+    /// component are interpreted until none of them is scheduled,
+    /// before continuing with the next component.
+    void enterNextScheduledFunction();
+
+    /// Set the current basic block and prepare its input state.
+    void enterBasicBlock(std::vector<BasicBlock*>::const_iterator basicBlock);
+
+    /// Interpret the program using the round-robin strategy until a
+    /// fixpoint is reached.
+    /// @param notifyFixpoint
+    ///   Call the fixpoint callback when the fixpoint is reached.
+    void runRoundRobinToFixpoint(bool notifyFixpoint);
+
+    /// Interpret the program using a worklist strategy until a
+    /// fixpoint is reached.
+    void runWorklistToFixpoint(bool notifyFixpoint);
+
+    /// Interpret a basic block of a function and merge the result to
+    /// its output state.
+    /// @returns
+    ///   True if the output state has been changed.
+    bool interpretBasicBlock(Function &function, BasicBlock &basicBlock);
+
+    /// Merge the current state to the output state of the current
+    /// basic block.
+    /// @returns
+    ///   True if the output state has been changed.
+    bool updateBasicBlockOutputState();
 };
 
 } // namespace Interpreter
@@ -0,0 +1,219 @@
+#include "InterpreterModRef.h"
+#include "InterpreterFunction.h"
+#include "Utils.h"
+
+namespace Canal {
+namespace Interpreter {
+
+bool ModRef::ENABLED = false;
+
+/// Check if a value is a getelementptr or bitcast, either an
+/// instruction or a constant expression.  They derive a pointer from
+/// their first operand.
+static bool
+isAddressOperation(const llvm::Value &value)
+{
+    unsigned opcode;
+    if (const llvm::Instruction *instruction = dynCast<llvm::Instruction>(&value))
+        opcode = instruction->getOpcode();
+    else if (const llvm::ConstantExpr *expression = dynCast<llvm::ConstantExpr>(&value))
+        opcode = expression->getOpcode();
+    else
+        return false;
+
+    return opcode == llvm::Instruction::GetElementPtr ||
+        opcode == llvm::Instruction::BitCast;
+}
+
+/// Check if a pointer might be used elsewhere than as the address of
+/// a load or a store, following the pointers derived from it.
+static bool
+isEscaping(const llvm::Value &pointer)
+{
+    llvm::Value::const_use_iterator it = pointer.use_begin(),
+        itend = pointer.use_end();
+
+    for (; it != itend; ++it)
+    {
+        if (llvm::isa<llvm::LoadInst>(*it))
+            continue;
+
+        const llvm::StoreInst *store = dynCast<llvm::StoreInst>(*it);
+        if (store && store->getValueOperand() != &pointer)
+            continue;
+
+        if (isAddressOperation(**it) && (*it)->getOperand(0) == &pointer)
+        {
+            if (isEscaping(**it))
+                return true;
+
+            continue;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+/// Get the global a pointer has been derived from.
+/// @returns
+///   NULL if the pointer is not derived from a global variable.
+static const llvm::GlobalVariable *
+getAccessedGlobal(const llvm::Value &pointer)
+{
+    const llvm::Value *value = &pointer;
+    while (isAddressOperation(*value))
+        value = checkedCast<llvm::User>(value)->getOperand(0);
+
+    return dynCast<llvm::GlobalVariable>(value);
+}
+
+/// Add the global variables referenced by a value, including the
+/// operands of constant expressions.
+static void
+addReferencedGlobals(const llvm::Value &value, StateDelta::Places &places)
+{
+    if (llvm::isa<llvm::GlobalVariable>(value))
+    {
+        places.insert(&value);
+        return;
+    }
+
+    const llvm::Constant *constant = dynCast<llvm::Constant>(&value);
+    if (!constant || llvm::isa<llvm::GlobalValue>(value))
+        return;
+
+    llvm::Constant::const_op_iterator it = constant->op_begin(),
+        itend = constant->op_end();
+
+    for (; it != itend; ++it)
+        addReferencedGlobals(**it, places);
+}
+
+void
+ModRef::initialize(const llvm::Module &module,
+                   const std::vector<std::vector<Function*> > &components)
+{
+    clear();
+    llvm::Module::const_global_iterator git = module.global_begin(),
+        gitend = module.global_end();
+
+    for (; git != gitend; ++git)
+    {
+        if (isEscaping(*git))
+            mEscaping.insert(&*git);
+    }
+
+    // Callees precede their callers, so the summaries of the callees
+    // outside a component are known.  Functions of a component might
+    // call each other, so they share the summary.
+    std::vector<std::vector<Function*> >::const_iterator it = components.begin(),
+        itend = components.end();
+
+    for (; it != itend; ++it)
+    {
+        Summary summary;
+        summary.mReferences.mGlobalVariables = mEscaping;
+        summary.mReferences.mGlobalBlocks = mEscaping;
+        summary.mModifications.mGlobalBlocks = mEscaping;
+
+        std::vector<Function*>::const_iterator fit = it->begin();
+        for (; fit != it->end(); ++fit)
+        {
+            const llvm::Function &function = (*fit)->getLlvmFunction();
+            addAccesses(function, summary);
+
+            llvm::Function::const_iterator bit = function.begin(),
+                bitend = function.end();
+
+            for (; bit != bitend; ++bit)
+            {
+                llvm::BasicBlock::const_iterator iit = bit->begin(),
+                    iitend = bit->end();
+
+                for (; iit != iitend; ++iit)
+                {
+                    const llvm::Function *callee = getCalledFunction(*iit);
+                    if (!callee)
+                        continue;
+
+                    std::map<const llvm::Function*, Summary>::const_iterator
+                        sit = mSummaries.find(callee);
+
+                    if (sit == mSummaries.end())
+                        continue;
+
+                    summary.mReferences.merge(sit->second.mReferences);
+                    summary.mModifications.merge(sit->second.mModifications);
+                }
+            }
+        }
+
+        for (fit = it->begin(); fit != it->end(); ++fit)
+            mSummaries[&(*fit)->getLlvmFunction()] = summary;
+    }
+}
+
+void
+ModRef::clear()
+{
+    mSummaries.clear();
+    mEscaping.clear();
+}
+
+const ModRef::Summary *
+ModRef::getSummary(const llvm::Function &function) const
+{
+    std::map<const llvm::Function*, Summary>::const_iterator it =
+        mSummaries.find(&function);
+
+    return it == mSummaries.end() ? NULL : &it->second;
+}
+
+void
+ModRef::addAccesses(const llvm::Function &function,
+                    Summary &summary) const
+{
+    llvm::Function::const_iterator it = function.begin(),
+        itend = function.end();
+
+    for (; it != itend; ++it)
+    {
+        llvm::BasicBlock::const_iterator iit = it->begin(),
+            iitend = it->end();
+
+        for (; iit != iitend; ++iit)
+        {
+            llvm::Instruction::const_op_iterator oit = iit->op_begin(),
+                oitend = iit->op_end();
+
+            for (; oit != oitend; ++oit)
+                addReferencedGlobals(**oit, summary.mReferences.mGlobalVariables);
+
+            const llvm::Value *pointer = NULL;
+            bool modified = false;
+            if (const llvm::LoadInst *load = dynCast<llvm::LoadInst>(&*iit))
+                pointer = load->getPointerOperand();
+            else if (const llvm::StoreInst *store = dynCast<llvm::StoreInst>(&*iit))
+            {
+                pointer = store->getPointerOperand();
+                modified = true;
+            }
+
+            if (!pointer)
+                continue;
+
+            const llvm::GlobalVariable *global = getAccessedGlobal(*pointer);
+            if (!global)
+                continue;
+
+            summary.mReferences.mGlobalBlocks.insert(global);
+            if (modified)
+                summary.mModifications.mGlobalBlocks.insert(global);
+        }
+    }
+}
+
+} // namespace Interpreter
+} // namespace Canal
@@ -0,0 +1,71 @@
+#ifndef LIBCANAL_INTERPRETER_MOD_REF_H
+#define LIBCANAL_INTERPRETER_MOD_REF_H
+
+#include "StateDelta.h"
+#include <map>
+#include <vector>
+
+namespace Canal {
+namespace Interpreter {
+
+class Function;
+
+/// Pre-analysis of the globals that functions may read or write,
+/// including the globals accessed by the functions they call.  Calls
+/// propagate only these globals between the caller and the callee,
+/// so the cost of a call depends on what the callee touches, not on
+/// the number of globals in the program.
+///
+/// Only the globals accessed directly by loads and stores are
+/// tracked.  A global whose address is stored, passed to a function
+/// or used otherwise might be accessed through a pointer anywhere, so
+/// it is propagated by every call.
+class ModRef
+{
+public:
+    /// Propagate only the globals accessed by the called functions.
+    static bool ENABLED;
+
+    struct Summary
+    {
+        /// Global variables and global blocks the function may read
+        /// or write.
+        StateDelta mReferences;
+
+        /// Global blocks the function may write.
+        StateDelta mModifications;
+    };
+
+protected:
+    std::map<const llvm::Function*, Summary> mSummaries;
+
+    /// Globals whose address might be used elsewhere than in loads
+    /// and stores.
+    StateDelta::Places mEscaping;
+
+public:
+    /// Compute the summaries of functions.
+    /// @param components
+    ///   Strongly connected components of the call graph.  A callee
+    ///   precedes its callers unless they belong to the same
+    ///   component.
+    void initialize(const llvm::Module &module,
+                    const std::vector<std::vector<Function*> > &components);
+
+    void clear();
+
+    /// @returns
+    ///   NULL if the summary of the function has not been computed.
+    const Summary *getSummary(const llvm::Function &function) const;
+
+protected:
+    /// Add the globals accessed by the instructions of a function to
+    /// a summary.  Called functions are not considered.
+    void addAccesses(const llvm::Function &function,
+                     Summary &summary) const;
+};
+
+} // namespace Interpreter
+} // namespace Canal
+
+#endif // LIBCANAL_INTERPRETER_MOD_REF_H
@@ -6,6 +6,8 @@
 #include "Utils.h"
 #include "Constructors.h"
 #include "Environment.h"
+#include <algorithm>
+#include <map>
 #include <set>
 
 namespace Canal {
@@ -77,6 +79,7 @@ Module::Module(const llvm::Module &module,
     // Prepare the state with all globals.  Global pointers are
     // allocated automatically -- they point to globals section.
     {
+        State globalState;
         std::vector<const llvm::GlobalVariable*> sorted =
             getSortedGlobalVariables(module);
 
@@ -89,15 +92,15 @@ Module::Module(const llvm::Module &module,
             {
                 Domain *value = constructors.create(*(*it)->getInitializer(),
                                                     **it,
-                                                    &mGlobalState);
+                                                    &globalState);
 
-                mGlobalState.addGlobalVariable(**it, value);
+                globalState.addGlobalVariable(**it, value);
                 continue;
             }
 
             const llvm::Type &elementType = *(*it)->getType()->getElementType();
             Domain *block = constructors.create(elementType);
-            mGlobalState.addGlobalBlock(**it, block);
+            globalState.addGlobalBlock(**it, block);
 
             Domain *value = constructors.create(*(*it)->getType());
 
@@ -108,8 +111,10 @@ Module::Module(const llvm::Module &module,
                                       std::vector<Domain*>(),
                                       NULL);
 
-            mGlobalState.addGlobalVariable(**it, value);
+            globalState.addGlobalVariable(**it, value);
         }
+
+        mGlobalStore.commit(globalState);
     }
 
     // Prepare the initial state of all functions.
@@ -122,11 +127,17 @@ Module::Module(const llvm::Module &module,
             if (it->isDeclaration())
                 continue;
 
-            Function *function = new Function(*it, constructors);
-            function->getInputState().merge(mGlobalState);
-            mFunctions.push_back(function);
+            mFunctions.push_back(new Function(*it, constructors));
         }
     }
+
+    initializeCallGraph();
+
+    std::vector<Function*>::const_iterator it = mFunctions.begin(),
+        itend = mFunctions.end();
+
+    for (; it != itend; ++it)
+        initializeGlobals(**it);
 }
 
 Module::~Module()
@@ -137,28 +148,17 @@ Module::~Module()
 Function *
 Module::getFunction(const char *name) const
 {
-    llvm::StringRef nameString(name);
-    std::vector<Function*>::const_iterator it = mFunctions.begin();
-    for (; it != mFunctions.end(); ++it)
-    {
-        if ((*it)->getName().equals(nameString))
-            return *it;
-    }
-
-    return NULL;
+    const llvm::Function *function = mModule.getFunction(name);
+    return function ? getFunction(*function) : NULL;
 }
 
 Function *
 Module::getFunction(const llvm::Function &function) const
 {
-    std::vector<Function*>::const_iterator it = mFunctions.begin();
-    for (; it != mFunctions.end(); ++it)
-    {
-        if (&(*it)->getLlvmFunction() == &function)
-            return *it;
-    }
+    llvm::DenseMap<const llvm::Function*, unsigned>::const_iterator it =
+        mFunctionIds.find(&function);
 
-    return NULL;
+    return it == mFunctionIds.end() ? NULL : mFunctions[it->second];
 }
 
 std::string
@@ -175,7 +175,7 @@ Module::toString() const
         gitend = mModule.global_end();
 
     for (; git != gitend; ++git)
-        ss << mGlobalState.toString(*git, slotTracker);
+        ss << mGlobalStore.getState().toString(*git, slotTracker);
 
     if (mModule.global_begin() != gitend)
         ss << "\n";
@@ -198,11 +198,211 @@ Module::updateGlobalState()
 
     for (; it != itend; ++it)
     {
-        // Merge global blocks, global variables.  Merge function
-        // blocks that do not belong to this function.  Merge returned
-        // value.
-        mGlobalState.mergeGlobal((*it)->getOutputState());
+        // Merge global blocks, global variables.
+        mGlobalStore.commit((*it)->getOutputState());
+    }
+
+    // Replace the copies of globals equal to the store by the memory
+    // of the store.  Functions that have not been interpreted since
+    // the last update are skipped.
+    for (it = mFunctions.begin(); it != itend; ++it)
+        (*it)->shareGlobalState(mGlobalStore);
+}
+
+void
+Module::transform(ValueTransform &transform)
+{
+    mEnvironment.getInterningTable().clear();
+    mGlobalStore.transform(transform);
+    std::vector<Function*>::const_iterator it = mFunctions.begin(),
+        itend = mFunctions.end();
+
+    for (; it != itend; ++it)
+        (*it)->transform(transform);
+}
+
+void
+Module::update(const std::set<const llvm::Function*> &changed,
+               const Constructors &constructors,
+               bool converged)
+{
+    // Functions calling a changed function might get a different
+    // result from the call, so they are affected as well.
+    std::set<const llvm::Function*> affected;
+    std::vector<const llvm::Function*> worklist(changed.begin(), changed.end());
+    while (!worklist.empty())
+    {
+        const llvm::Function *function = worklist.back();
+        worklist.pop_back();
+        if (!affected.insert(function).second)
+            continue;
+
+        llvm::Value::const_use_iterator it = function->use_begin(),
+            itend = function->use_end();
+
+        for (; it != itend; ++it)
+        {
+            const llvm::Instruction *instruction =
+                dynCast<llvm::Instruction>(*it);
+
+            if (instruction && getCalledFunction(*instruction) == function)
+                worklist.push_back(instruction->getParent()->getParent());
+        }
+    }
+
+    std::map<const llvm::Function*, Function*> functions;
+    {
+        std::vector<Function*>::const_iterator it = mFunctions.begin(),
+            itend = mFunctions.end();
+
+        for (; it != itend; ++it)
+            functions[&(*it)->getLlvmFunction()] = *it;
+    }
+
+    // Keep the results of unaffected functions.  Interpret the
+    // affected functions from scratch.
+    std::vector<Function*> updated, created;
+    llvm::Module::const_iterator it = mModule.begin(),
+        itend = mModule.end();
+
+    for (; it != itend; ++it)
+    {
+        std::map<const llvm::Function*, Function*>::iterator fit =
+            functions.find(it);
+
+        Function *function = (fit == functions.end() ? NULL : fit->second);
+        if (function && affected.find(it) != affected.end())
+        {
+            delete function;
+            function = NULL;
+        }
+
+        if (fit != functions.end())
+            functions.erase(fit);
+
+        if (it->isDeclaration())
+        {
+            CANAL_ASSERT(!function);
+            continue;
+        }
+
+        if (!function)
+        {
+            function = new Function(*it, constructors);
+            created.push_back(function);
+        }
+        else if (converged)
+            function->clearSchedule();
+
+        updated.push_back(function);
+    }
+
+    CANAL_ASSERT(functions.empty());
+    mFunctions.swap(updated);
+    initializeCallGraph();
+
+    // Summaries of the kept functions do not change, because their
+    // callees are kept as well.
+    std::vector<Function*>::const_iterator cit = created.begin(),
+        citend = created.end();
+
+    for (; cit != citend; ++cit)
+        initializeGlobals(**cit);
+}
+
+void
+Module::initializeCallGraph()
+{
+    std::vector<Function*>::const_iterator fit = mFunctions.begin(),
+        fitend = mFunctions.end();
+
+    for (; fit != fitend; ++fit)
+        (*fit)->clearCallers();
+
+    mCallGraphComponents.clear();
+    mFunctionIds.clear();
+    for (unsigned i = 0; i < mFunctions.size(); ++i)
+        mFunctionIds[&mFunctions[i]->getLlvmFunction()] = i;
+
+    // Register call sites, so the callers can be interpreted again
+    // when the output state of a function changes.  Build the call
+    // graph with edges leading from callees to their callers.
+    std::vector<std::vector<unsigned> > callers(mFunctions.size());
+    {
+        for (unsigned i = 0; i < mFunctions.size(); ++i)
+        {
+            const llvm::Function &llvmFunction = mFunctions[i]->getLlvmFunction();
+            llvm::Function::const_iterator bit = llvmFunction.begin(),
+                bitend = llvmFunction.end();
+
+            for (; bit != bitend; ++bit)
+            {
+                llvm::BasicBlock::const_iterator iit = bit->begin(),
+                    iitend = bit->end();
+
+                for (; iit != iitend; ++iit)
+                {
+                    const llvm::Function *callee = getCalledFunction(*iit);
+                    if (!callee)
+                        continue;
+
+                    llvm::DenseMap<const llvm::Function*, unsigned>::const_iterator
+                        fit = mFunctionIds.find(callee);
+
+                    if (fit == mFunctionIds.end())
+                        continue;
+
+                    mFunctions[fit->second]->addCaller(*mFunctions[i], *bit);
+                    callers[fit->second].push_back(i);
+                }
+            }
+        }
+    }
+
+    // Strongly connected components of the call graph, callees
+    // first.  Functions inside a component keep the module order.
+    {
+        std::vector<unsigned> vertices;
+        for (unsigned i = 0; i < mFunctions.size(); ++i)
+            vertices.push_back(i);
+
+        std::vector<std::vector<unsigned> > components;
+        findStronglyConnectedComponents(callers, vertices, components);
+
+        std::vector<std::vector<unsigned> >::iterator it = components.begin(),
+            itend = components.end();
+
+        for (; it != itend; ++it)
+        {
+            std::sort(it->begin(), it->end());
+            std::vector<Function*> component;
+            std::vector<unsigned>::const_iterator vit = it->begin();
+            for (; vit != it->end(); ++vit)
+                component.push_back(mFunctions[*vit]);
+
+            mCallGraphComponents.push_back(component);
+        }
+    }
+
+    if (ModRef::ENABLED)
+        mModRef.initialize(mModule, mCallGraphComponents);
+    else
+        mModRef.clear();
+}
+
+void
+Module::initializeGlobals(Function &function)
+{
+    const ModRef::Summary *summary =
+        mModRef.getSummary(function.getLlvmFunction());
+
+    if (summary)
+    {
+        function.getInputState().mergeGlobal(mGlobalStore.getState(),
+                                              summary->mReferences);
     }
+    else
+        function.getInputState().mergeGlobal(mGlobalStore.getState());
 }
 
 } // namespace Interpreter
@@ -1,8 +1,10 @@
 #ifndef LIBCANAL_INTERPRETER_MODULE_H
 #define LIBCANAL_INTERPRETER_MODULE_H
 
-#include "State.h"
+#include "GlobalStore.h"
+#include "InterpreterModRef.h"
 #include <vector>
+#include <set>
 #include <string>
 
 namespace Canal {
@@ -24,7 +26,20 @@ class Module
     // Workers iterate on functions until the fixpoint is reached.
     std::vector<Function*> mFunctions;
 
-    State mGlobalState;
+    /// Positions of functions in mFunctions.
+    llvm::DenseMap<const llvm::Function*, unsigned> mFunctionIds;
+
+    /// Strongly connected components of the call graph.  A callee
+    /// precedes its callers unless they belong to the same
+    /// component, so function summaries can be computed bottom-up.
+    std::vector<std::vector<Function*> > mCallGraphComponents;
+
+    /// Join of the globals of all functions.
+    GlobalStore mGlobalStore;
+
+    /// Globals accessed by functions.  Computed only when
+    /// ModRef::ENABLED is set.
+    ModRef mModRef;
 
 public:
     Module(const llvm::Module &module,
@@ -47,6 +62,16 @@ public:
         return mFunctions.empty();
     }
 
+    const std::vector<std::vector<Function*> > &getCallGraphComponents() const
+    {
+        return mCallGraphComponents;
+    }
+
+    const ModRef &getModRef() const
+    {
+        return mModRef;
+    }
+
     Function *getFunction(const char *name) const;
 
     Function *getFunction(const std::string &name) const
@@ -58,7 +83,44 @@ public:
 
     std::string toString() const;
 
+    /// Merge the globals of the function output states to the global
+    /// store.  The states of the functions interpreted since the last
+    /// update are made to share the memory of the store.
     void updateGlobalState();
+
+    /// Replace the values of the global store and of all states of
+    /// the functions by their transformed copies.  The interning
+    /// table is cleared first, as the copies might not be comparable
+    /// to the original values.  Must not be called while basic blocks
+    /// are interpreted.
+    void transform(ValueTransform &transform);
+
+    /// Update the interpretation after the bodies of some functions
+    /// of the LLVM module have been replaced.  The changed functions
+    /// and all functions calling them, directly or indirectly, are
+    /// interpreted again from scratch.  The results of other
+    /// functions are kept.
+    /// @param changed
+    ///   Functions whose body has been replaced, including
+    ///   declarations that got a body and definitions that lost it.
+    ///   The set of functions itself must not change; modules that
+    ///   add or remove functions are rejected by Interpreter::update.
+    /// @param converged
+    ///   Indication that the kept functions have reached a fixpoint,
+    ///   so they need not be interpreted again.
+    void update(const std::set<const llvm::Function*> &changed,
+                const Constructors &constructors,
+                bool converged);
+
+protected:
+    /// Number the functions, register call sites in functions and
+    /// compute the strongly connected components of the call graph.
+    /// Computes the globals accessed by functions when enabled.
+    void initializeCallGraph();
+
+    /// Merge the globals accessed by a function from the global store
+    /// to its input state.
+    void initializeGlobals(Function &function);
 };
 
 } // namespace Interpreter
@@ -12,9 +12,15 @@ namespace Interpreter {
 
 bool printMissing = true;
 
+/// Serializes the messages about missing functions printed from
+/// multiple interpreter threads.
+static llvm::sys::Mutex printMissingMutex;
+
 OperationsCallback::OperationsCallback(Module &module,
                                        Constructors &constructors)
-    : mModule(module), mConstructors(constructors)
+    : mModule(module),
+      mConstructors(constructors),
+      mDeferInputStates(false)
 {
 }
 
@@ -57,6 +63,7 @@ OperationsCallback::onFunctionCall(const llvm::Function &function,
     {
         if (printMissing)
         {
+            llvm::MutexGuard guard(printMissingMutex);
             llvm::outs() << "Intrinsic function \""
                          << function.getName()
                          << "\" not available.\n";
@@ -73,6 +80,7 @@ OperationsCallback::onFunctionCall(const llvm::Function &function,
     {
         if (printMissing)
         {
+            llvm::MutexGuard guard(printMissingMutex);
             llvm::outs() << "External function \""
                          << function.getName()
                          << "\" not available.\n";
@@ -88,12 +96,30 @@ OperationsCallback::onFunctionCall(const llvm::Function &function,
     Function *func = mModule.getFunction(function);
     CANAL_ASSERT_MSG(func, "Function not found in module!");
 
+    // Pass only the globals the function might access.
+    const ModRef::Summary *summary = mModule.getModRef().getSummary(function);
+    const State *inputState = &callState;
+    State restrictedState;
+    if (summary)
+    {
+        restrictedState.assign(callState);
+        restrictedState.restrictGlobal(summary->mReferences);
+        inputState = &restrictedState;
+    }
+
     // Extend the input so the function can be re-interpreted.
-    func->getInputState().merge(callState);
+    if (mDeferInputStates)
+        func->addPendingInputState(resultPlace, *inputState);
+    else if (func->mergeInputState(*inputState))
+        func->schedule(func->getLlvmEntryBlock());
 
     // Take the current function interpretation results and use them
     // as a result of the function call.
-    resultState.mergeGlobal(func->getOutputState());
+    if (summary)
+        resultState.mergeGlobal(func->getOutputState(), summary->mModifications);
+    else
+        resultState.mergeGlobal(func->getOutputState());
+
     resultState.mergeFunctionBlocks(func->getOutputState());
     if (func->getOutputState().getReturnedValue())
     {
@@ -18,10 +18,19 @@ class OperationsCallback : public Canal::OperationsCallback
     Module &mModule;
     Constructors &mConstructors;
 
+    /// When set, the input states of called functions are stored as
+    /// pending instead of being merged immediately.
+    bool mDeferInputStates;
+
 public:
     OperationsCallback(Module &module,
                        Constructors &mConstructors);
 
+    void setDeferInputStates(bool defer)
+    {
+        mDeferInputStates = defer;
+    }
+
     virtual void onFunctionCall(const llvm::Function &function,
                                 const State &callState,
                                 State &resultState,
@@ -0,0 +1,237 @@
+#include "InterpreterParallelIterator.h"
+#include "InterpreterIterator.h"
+#include "InterpreterBudget.h"
+#include "InterpreterModule.h"
+#include "InterpreterBasicBlock.h"
+#include "InterpreterIteratorCallback.h"
+#include "InterpreterOperationsCallback.h"
+#include "Operations.h"
+#include "WideningManager.h"
+#include "State.h"
+#include "Utils.h"
+
+namespace Canal {
+namespace Interpreter {
+
+static IteratorCallback emptyCallback;
+
+unsigned ParallelIterator::THREAD_COUNT = 0;
+
+ParallelIterator::ParallelIterator(Module &module,
+                                   Operations &operations,
+                                   OperationsCallback &operationsCallback,
+                                   Widening::Manager &wideningManager,
+                                   Budget &budget)
+    : mModule(module),
+      mOperations(operations),
+      mOperationsCallback(operationsCallback),
+      mWideningManager(wideningManager),
+      mBudget(budget),
+      mIterationOrder(Function::ReversePostorder),
+      mSparse(false),
+      mCallback(&emptyCallback),
+      mNextTask(0),
+      mUnfinishedTasks(0),
+      mTerminate(false)
+{
+    pthread_mutex_init(&mMutex, NULL);
+    pthread_cond_init(&mTasksAvailable, NULL);
+    pthread_cond_init(&mTasksFinished, NULL);
+}
+
+ParallelIterator::~ParallelIterator()
+{
+    stopThreads();
+    pthread_cond_destroy(&mTasksFinished);
+    pthread_cond_destroy(&mTasksAvailable);
+    pthread_mutex_destroy(&mMutex);
+}
+
+void
+ParallelIterator::run()
+{
+    mIterationOrder = Function::ReversePostorder;
+    if (Iterator::STRATEGY == Iterator::WeakTopologicalOrderStrategy)
+        mIterationOrder = Function::WeakTopologicalOrder;
+
+    mSparse = Iterator::SPARSE;
+
+    std::vector<Function*>::const_iterator it = mModule.begin(),
+        itend = mModule.end();
+
+    for (; it != itend; ++it)
+        (*it)->setIterationOrder(mIterationOrder);
+
+    startThreads(THREAD_COUNT);
+    mOperationsCallback.setDeferInputStates(true);
+
+    while (true)
+    {
+        std::vector<Function*> functions;
+        for (it = mModule.begin(); it != itend; ++it)
+        {
+            if ((*it)->hasScheduled())
+                functions.push_back(*it);
+        }
+
+        if (functions.empty())
+            break;
+
+        mCallback->onModuleEnter();
+        interpretFunctions(functions);
+
+        // Exchange the states between functions.  Functions are
+        // processed in the module order to keep the result
+        // deterministic.
+        std::vector<Function*>::const_iterator fit = functions.begin();
+        for (; fit != functions.end(); ++fit)
+        {
+            if ((*fit)->updateOutputState())
+                (*fit)->scheduleCallers();
+        }
+
+        for (it = mModule.begin(); it != itend; ++it)
+        {
+            if ((*it)->mergePendingInputStates())
+                (*it)->schedule((*it)->getLlvmEntryBlock());
+        }
+
+        mModule.updateGlobalState();
+        mBudget.updatePrecision(mModule);
+        mCallback->onModuleExit();
+    }
+
+    mOperationsCallback.setDeferInputStates(false);
+    stopThreads();
+    mCallback->onFixpointReached();
+}
+
+void
+ParallelIterator::startThreads(unsigned count)
+{
+    CANAL_ASSERT(mThreads.empty());
+    if (count == 0)
+        count = 1;
+
+    mTerminate = false;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        pthread_t thread;
+        if (0 != pthread_create(&thread, NULL, threadMain, this))
+            CANAL_FATAL_ERROR("Failed to create an interpreter thread.");
+
+        mThreads.push_back(thread);
+    }
+}
+
+void
+ParallelIterator::stopThreads()
+{
+    pthread_mutex_lock(&mMutex);
+    mTerminate = true;
+    pthread_cond_broadcast(&mTasksAvailable);
+    pthread_mutex_unlock(&mMutex);
+
+    std::vector<pthread_t>::const_iterator it = mThreads.begin();
+    for (; it != mThreads.end(); ++it)
+        pthread_join(*it, NULL);
+
+    mThreads.clear();
+}
+
+void
+ParallelIterator::interpretFunctions(const std::vector<Function*> &functions)
+{
+    pthread_mutex_lock(&mMutex);
+    mTasks = functions;
+    mNextTask = 0;
+    mUnfinishedTasks = functions.size();
+    pthread_cond_broadcast(&mTasksAvailable);
+
+    while (mUnfinishedTasks > 0)
+        pthread_cond_wait(&mTasksFinished, &mMutex);
+
+    mTasks.clear();
+    pthread_mutex_unlock(&mMutex);
+}
+
+void
+ParallelIterator::interpretFunction(Function &function)
+{
+    // The state is refilled for every basic block.
+    State state;
+    while (function.hasScheduled())
+    {
+        llvm::sys::TimeValue start = llvm::sys::TimeValue::now();
+        BasicBlock &basicBlock = **function.popScheduled();
+        function.initializeInputState(basicBlock, state);
+        if (mSparse)
+            function.loadRegisters(basicBlock, state);
+
+        llvm::BasicBlock::const_iterator it = basicBlock.begin(),
+            itend = basicBlock.end();
+
+        for (; it != itend; ++it)
+            mOperations.interpretInstruction(*it, state);
+
+        const Widening::Manager *wideningManager = &mWideningManager;
+        if (mIterationOrder == Function::WeakTopologicalOrder &&
+            !function.isComponentHead(basicBlock))
+        {
+            wideningManager = NULL;
+        }
+
+        mBudget.addVisit(function, start);
+        wideningManager = mBudget.getWideningManager(function,
+                                                     wideningManager);
+
+        if (mSparse)
+            function.storeRegisters(basicBlock, state, wideningManager);
+
+        function.pruneRegisters(basicBlock, state);
+
+        if (function.updateBasicBlockOutputState(basicBlock,
+                                                 state,
+                                                 wideningManager))
+        {
+            function.scheduleSuccessors(basicBlock);
+        }
+    }
+
+    mBudget.updateMemoryUsage(function);
+}
+
+void
+ParallelIterator::processTasks()
+{
+    pthread_mutex_lock(&mMutex);
+    while (true)
+    {
+        while (!mTerminate && mNextTask == mTasks.size())
+            pthread_cond_wait(&mTasksAvailable, &mMutex);
+
+        if (mTerminate)
+            break;
+
+        Function &function = *mTasks[mNextTask++];
+        pthread_mutex_unlock(&mMutex);
+
+        interpretFunction(function);
+
+        pthread_mutex_lock(&mMutex);
+        if (--mUnfinishedTasks == 0)
+            pthread_cond_signal(&mTasksFinished);
+    }
+
+    pthread_mutex_unlock(&mMutex);
+}
+
+void *
+ParallelIterator::threadMain(void *iterator)
+{
+    static_cast<ParallelIterator*>(iterator)->processTasks();
+    return NULL;
+}
+
+} // namespace Interpreter
+} // namespace Canal
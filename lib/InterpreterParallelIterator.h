@@ -0,0 +1,120 @@
+#ifndef LIBCANAL_INTERPRETER_PARALLEL_ITERATOR_H
+#define LIBCANAL_INTERPRETER_PARALLEL_ITERATOR_H
+
+#include "InterpreterFunction.h"
+#include <pthread.h>
+#include <vector>
+
+namespace Canal {
+
+class Operations;
+
+namespace Widening {
+class Manager;
+} // namespace Widening
+
+namespace Interpreter {
+
+class Module;
+class Budget;
+class IteratorCallback;
+class OperationsCallback;
+
+/// Iterator that interprets multiple functions at once using a pool
+/// of threads.  The interpretation proceeds in rounds.  In every
+/// round, each function with scheduled basic blocks is interpreted to
+/// its local fixpoint by one of the threads.  States passed between
+/// functions (call inputs, function outputs) are exchanged only at
+/// the end of a round, in the order of functions in the module, so
+/// the result does not depend on the number of threads or on their
+/// timing.
+///
+/// Unlike Iterator, it does not support single stepping.  Only the
+/// module and fixpoint callbacks are called.
+class ParallelIterator
+{
+public:
+    /// Number of threads used by the interpreter.  Zero disables the
+    /// parallel iteration.
+    static unsigned THREAD_COUNT;
+
+private:
+    Module &mModule;
+    Operations &mOperations;
+    OperationsCallback &mOperationsCallback;
+    Widening::Manager &mWideningManager;
+    Budget &mBudget;
+
+    /// Order of basic blocks used in the current run.
+    Function::IterationOrder mIterationOrder;
+
+    /// Sparse propagation of registers used in the current run.
+    bool mSparse;
+
+    /// Callback functions.
+    IteratorCallback *mCallback;
+
+    std::vector<pthread_t> mThreads;
+
+    /// Guards all the following members.
+    pthread_mutex_t mMutex;
+
+    /// Signalled when new tasks are available or the threads
+    /// should terminate.
+    pthread_cond_t mTasksAvailable;
+
+    /// Signalled when all tasks of a round are finished.
+    pthread_cond_t mTasksFinished;
+
+    /// Functions to be interpreted in the current round.
+    std::vector<Function*> mTasks;
+
+    /// Index to mTasks of the first task not taken by a thread.
+    size_t mNextTask;
+
+    /// Number of tasks of the current round that are not finished.
+    size_t mUnfinishedTasks;
+
+    /// Indication that the threads should terminate.
+    bool mTerminate;
+
+public:
+    ParallelIterator(Module &module,
+                     Operations &operations,
+                     OperationsCallback &operationsCallback,
+                     Widening::Manager &wideningManager,
+                     Budget &budget);
+
+    virtual ~ParallelIterator();
+
+    void setCallback(IteratorCallback &callback)
+    {
+        mCallback = &callback;
+    }
+
+    /// Interpret the whole program until a fixpoint is reached.
+    void run();
+
+protected:
+    void startThreads(unsigned count);
+
+    void stopThreads();
+
+    /// Let the threads interpret the functions and wait until they
+    /// are finished.
+    void interpretFunctions(const std::vector<Function*> &functions);
+
+    /// Interpret the scheduled basic blocks of a function until none
+    /// remains scheduled.
+    void interpretFunction(Function &function);
+
+    /// Take tasks and interpret them until asked to terminate.
+    void processTasks();
+
+    static void *threadMain(void *iterator);
+};
+
+} // namespace Interpreter
+} // namespace Canal
+
+#endif // LIBCANAL_INTERPRETER_PARALLEL_ITERATOR_H
@@ -4,8 +4,11 @@
 #include "Constructors.h"
 #include "Environment.h"
 #include "FloatInterval.h"
+#include "GarbageCollector.h"
 #include "IntegerBitfield.h"
-#include "ProductVector.h"
+#include "IntegerInterval.h"
+#include "IntegerSet.h"
+#include "ProductStatic.h"
 #include "IntegerUtils.h"
 #include "OperationsCallback.h"
 #include "Pointer.h"
@@ -197,9 +200,6 @@ Operations::interpretCall(const T &instruction,
     State callingState;
     callingState.mergeGlobal(state);
 
-    // TODO: not all function blocks should be merged to the state.
-    // Only the function blocks accessible from the arguments and
-    // global variables should be merged.
     callingState.mergeFunctionBlocks(state);
 
     // Add function arguments to the calling state.
@@ -237,6 +237,14 @@ Operations::interpretCall(const T &instruction,
         callingState.addVariableArgument(instruction, value->clone());
     }
 
+    // Only the blocks accessible from the arguments and global
+    // variables are relevant for the called function.
+    if (GarbageCollector::ENABLED)
+    {
+        GarbageCollector collector;
+        collector.collect(callingState);
+    }
+
     mCallback.onFunctionCall(*function,
                              callingState,
                              state,
@@ -907,7 +915,7 @@ Operations::getelementptr(const llvm::GetElementPtrInst &instruction,
     const Pointer::Pointer &source =
         checkedCast<Pointer::Pointer>(*base);
 
-    // We get offsets. Either constants or Product::Vector.
+    // We get offsets. Either constants or Integer::Combined.
     // Pointer points either to an array (or array offset), or to a
     // struct (or struct member).  Pointer might have multiple
     // targets.
@@ -1130,8 +1138,8 @@ Operations::select(const llvm::SelectInst &instruction,
         falseConstant);
 
     Domain *resultValue;
-    const Product::Vector &conditionInt =
-        checkedCast<Product::Vector>(*condition);
+    const Integer::Combined &conditionInt =
+        checkedCast<Integer::Combined>(*condition);
 
     CANAL_ASSERT(Integer::Utils::getBitfield(conditionInt).getBitWidth() == 1);
     switch (Integer::Utils::getBitfield(conditionInt).getBitValue(0))
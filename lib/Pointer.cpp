@@ -267,6 +267,21 @@ Pointer::memoryUsage() const
     return size;
 }
 
+size_t
+Pointer::hash() const
+{
+    size_t result = combineHash(getKind(), (size_t)&mType);
+    result = combineHash(result, mTop);
+
+    // Targets are identified by their places.  The offsets are left
+    // to the equality operator.
+    PlaceTargetMap::const_iterator it = mTargets.begin();
+    for (; it != mTargets.end(); ++it)
+        result = combineHash(result, (size_t)it->first);
+
+    return result;
+}
+
 std::string
 Pointer::toString() const
 {
@@ -20,6 +20,7 @@
 
 #include <llvm/ADT/APFloat.h>
 #include <llvm/ADT/APInt.h>
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/OwningPtr.h>
 #include <llvm/ADT/STLExtras.h>
 #include <llvm/ADT/SmallVector.h>
@@ -31,6 +32,7 @@
 #include <llvm/GlobalVariable.h>
 #include <llvm/Instruction.h>
 #include <llvm/Instructions.h>
+#include <llvm/IntrinsicInst.h>
 #include <llvm/LLVMContext.h>
 #include <llvm/Module.h>
 #include <llvm/Support/CFG.h>
@@ -38,32 +40,43 @@
 #include <llvm/Support/CommandLine.h>
 #include <llvm/Support/IRReader.h>
 #include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/MutexGuard.h>
 #include <llvm/Support/raw_ostream.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/ValueMapper.h>
 #include <llvm/Type.h>
 #include <llvm/Value.h>
 
 // Includes with differences across LLVM version.
 #if LLVM_VERSION_MAJOR == 2 && LLVM_VERSION_MINOR == 8
+#  include <llvm/System/Atomic.h>
 #  include <llvm/System/Host.h>
+#  include <llvm/System/Mutex.h>
 #  include <llvm/System/TimeValue.h>
 #  include <llvm/Target/TargetSelect.h>
 #  include <llvm/Target/TargetData.h>
 #elif LLVM_VERSION_MAJOR == 2 && LLVM_VERSION_MINOR == 9
 #  include <llvm/InitializePasses.h>
+#  include <llvm/Support/Atomic.h>
 #  include <llvm/Support/Host.h>
+#  include <llvm/Support/Mutex.h>
 #  include <llvm/Support/TimeValue.h>
 #  include <llvm/Target/TargetData.h>
 #  include <llvm/Target/TargetSelect.h>
 #elif LLVM_VERSION_MAJOR == 3 && LLVM_VERSION_MINOR < 2
 #  include <llvm/InitializePasses.h>
+#  include <llvm/Support/Atomic.h>
 #  include <llvm/Support/Host.h>
+#  include <llvm/Support/Mutex.h>
 #  include <llvm/Support/TimeValue.h>
 #  include <llvm/Support/TargetSelect.h>
 #  include <llvm/Target/TargetData.h>
 #else // LLVM 3.2 and newer
 #  include <llvm/DataLayout.h>
 #  include <llvm/InitializePasses.h>
+#  include <llvm/Support/Atomic.h>
 #  include <llvm/Support/Host.h>
+#  include <llvm/Support/Mutex.h>
 #  include <llvm/Support/TimeValue.h>
 #  include <llvm/Support/TargetSelect.h>
 #endif
@@ -86,6 +99,7 @@ namespace Canal {
     class Operations;
     class OperationsCallback;
     class SlotTracker;
+    class ValueTransform;
 
     namespace Integer {
         class Bitfield;
@@ -107,12 +121,15 @@ namespace Canal {
 
     namespace Product {
         class Message;
+        template <typename First, typename Second, typename Third>
+        class Static;
     } // namespace Product
 
     namespace Widening {
         class DataInterface;
         class Interface;
         class Manager;
+        class Point;
     } // namespace Widening
 
 } // namespace Canal
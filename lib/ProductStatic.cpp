@@ -0,0 +1,540 @@
+#include "ProductStatic.h"
+#include "ProductMessage.h"
+#include "IntegerBitfield.h"
+#include "IntegerSet.h"
+#include "IntegerInterval.h"
+#include "Environment.h"
+#include "Constructors.h"
+#include "Utils.h"
+#include "Pointer.h"
+#include <algorithm>
+
+namespace Canal {
+namespace Product {
+
+template <typename First, typename Second, typename Third>
+Static<First, Second, Third>::Static(const Static &value)
+    : Domain(value),
+      mFirst(value.mFirst),
+      mSecond(value.mSecond),
+      mThird(value.mThird)
+{
+}
+
+template <typename First, typename Second, typename Third>
+Static<First, Second, Third> *
+Static<First, Second, Third>::clone() const
+{
+    return new Static(*this);
+}
+
+template <typename First, typename Second, typename Third>
+size_t
+Static<First, Second, Third>::memoryUsage() const
+{
+    // The components count their own size.
+    size_t size = sizeof(Static) - sizeof(First) - sizeof(Second) - sizeof(Third);
+    size += mFirst.First::memoryUsage();
+    size += mSecond.Second::memoryUsage();
+    size += mThird.Third::memoryUsage();
+    return size;
+}
+
+template <typename First, typename Second, typename Third>
+size_t
+Static<First, Second, Third>::hash() const
+{
+    size_t result = getKind();
+    result = combineHash(result, mFirst.First::hash());
+    result = combineHash(result, mSecond.Second::hash());
+    result = combineHash(result, mThird.Third::hash());
+    return result;
+}
+
+template <typename First, typename Second, typename Third>
+std::string
+Static<First, Second, Third>::toString() const
+{
+    StringStream ss;
+    ss << "productStatic\n";
+    ss << indent(mFirst.First::toString(), 4);
+    ss << indent(mSecond.Second::toString(), 4);
+    ss << indent(mThird.Third::toString(), 4);
+    return ss.str();
+}
+
+template <typename First, typename Second, typename Third>
+void
+Static<First, Second, Third>::setZero(const llvm::Value *place)
+{
+    mFirst.First::setZero(place);
+    mSecond.Second::setZero(place);
+    mThird.Third::setZero(place);
+}
+
+template <typename First, typename Second, typename Third>
+bool
+Static<First, Second, Third>::operator==(const Domain &value) const
+{
+    if (this == &value)
+        return true;
+
+    const Static &product = checkedCast<Static>(value);
+    return mFirst.First::operator==(product.mFirst) &&
+        mSecond.Second::operator==(product.mSecond) &&
+        mThird.Third::operator==(product.mThird);
+}
+
+template <typename First, typename Second, typename Third>
+bool
+Static<First, Second, Third>::operator<(const Domain &value) const
+{
+    if (this == &value)
+        return false;
+
+    const Static &product = checkedCast<Static>(value);
+    return mFirst.First::operator<(product.mFirst) &&
+        mSecond.Second::operator<(product.mSecond) &&
+        mThird.Third::operator<(product.mThird);
+}
+
+template <typename First, typename Second, typename Third>
+Static<First, Second, Third> &
+Static<First, Second, Third>::join(const Domain &value)
+{
+    const Static &product = checkedCast<Static>(value);
+    mFirst.First::join(product.mFirst);
+    mSecond.Second::join(product.mSecond);
+    mThird.Third::join(product.mThird);
+    collaborate();
+    return *this;
+}
+
+template <typename First, typename Second, typename Third>
+Static<First, Second, Third> &
+Static<First, Second, Third>::meet(const Domain &value)
+{
+    const Static &product = checkedCast<Static>(value);
+    mFirst.First::meet(product.mFirst);
+    mSecond.Second::meet(product.mSecond);
+    mThird.Third::meet(product.mThird);
+    collaborate();
+    return *this;
+}
+
+template <typename First, typename Second, typename Third>
+bool
+Static<First, Second, Third>::isBottom() const
+{
+    return mFirst.First::isBottom() &&
+        mSecond.Second::isBottom() &&
+        mThird.Third::isBottom();
+}
+
+template <typename First, typename Second, typename Third>
+void
+Static<First, Second, Third>::setBottom()
+{
+    mFirst.First::setBottom();
+    mSecond.Second::setBottom();
+    mThird.Third::setBottom();
+}
+
+template <typename First, typename Second, typename Third>
+bool
+Static<First, Second, Third>::isTop() const
+{
+    return mFirst.First::isTop() &&
+        mSecond.Second::isTop() &&
+        mThird.Third::isTop();
+}
+
+template <typename First, typename Second, typename Third>
+void
+Static<First, Second, Third>::setTop()
+{
+    mFirst.First::setTop();
+    mSecond.Second::setTop();
+    mThird.Third::setTop();
+}
+
+template <typename First, typename Second, typename Third>
+float
+Static<First, Second, Third>::accuracy() const
+{
+    return std::max(mFirst.First::accuracy(),
+                    std::max(mSecond.Second::accuracy(),
+                             mThird.Third::accuracy()));
+}
+
+/// Defines an operation that applies the operation of the same name
+/// to the corresponding components of the operands.
+#define CANAL_STATIC_BINARY_OPERATION(name)                             \
+    template <typename First, typename Second, typename Third>          \
+    Static<First, Second, Third> &                                      \
+    Static<First, Second, Third>::name(const Domain &a, const Domain &b) \
+    {                                                                   \
+        const Static &aa = checkedCast<Static>(a),                      \
+            &bb = checkedCast<Static>(b);                               \
+                                                                        \
+        mFirst.First::name(aa.mFirst, bb.mFirst);                       \
+        mSecond.Second::name(aa.mSecond, bb.mSecond);                   \
+        mThird.Third::name(aa.mThird, bb.mThird);                       \
+        collaborate();                                                  \
+        return *this;                                                   \
+    }
+
+CANAL_STATIC_BINARY_OPERATION(add)
+CANAL_STATIC_BINARY_OPERATION(sub)
+CANAL_STATIC_BINARY_OPERATION(mul)
+CANAL_STATIC_BINARY_OPERATION(udiv)
+CANAL_STATIC_BINARY_OPERATION(sdiv)
+CANAL_STATIC_BINARY_OPERATION(urem)
+CANAL_STATIC_BINARY_OPERATION(srem)
+CANAL_STATIC_BINARY_OPERATION(shl)
+CANAL_STATIC_BINARY_OPERATION(lshr)
+CANAL_STATIC_BINARY_OPERATION(ashr)
+CANAL_STATIC_BINARY_OPERATION(and_)
+CANAL_STATIC_BINARY_OPERATION(or_)
+CANAL_STATIC_BINARY_OPERATION(xor_)
+
+#undef CANAL_STATIC_BINARY_OPERATION
+
+template <typename First, typename Second, typename Third>
+Static<First, Second, Third> &
+Static<First, Second, Third>::icmp(const Domain &a, const Domain &b,
+                                   llvm::CmpInst::Predicate predicate)
+{
+    const Pointer::Pointer
+        *aPointer = dynCast<Pointer::Pointer>(&a),
+        *bPointer = dynCast<Pointer::Pointer>(&b);
+
+    if (aPointer && bPointer)
+    {
+        bool cmpSingle = aPointer->isConstant() && bPointer->isConstant(),
+            cmpeq = (*aPointer == *bPointer);
+
+        setBottom();
+        switch (predicate)
+        {
+        case llvm::CmpInst::ICMP_EQ:
+        case llvm::CmpInst::ICMP_UGE:
+        case llvm::CmpInst::ICMP_ULE:
+        case llvm::CmpInst::ICMP_SGE:
+        case llvm::CmpInst::ICMP_SLE:
+            if (cmpeq && cmpSingle)
+            {
+                Domain *one = mEnvironment.getConstructors().createInteger(llvm::APInt(1, 1, false));
+                join(*one);
+                delete one;
+            }
+            else
+            {
+                if (predicate == llvm::CmpInst::ICMP_EQ && cmpSingle)
+                {
+                    Domain *zero = mEnvironment.getConstructors().createInteger(llvm::APInt(1, 0, false));
+                    join(*zero);
+                    delete zero;
+                }
+                else
+                    setTop();
+            }
+            break;
+        case llvm::CmpInst::ICMP_NE:
+            if (cmpSingle)
+            {
+                llvm::APInt boolean(1, (cmpeq ? 0 : 1), false);
+                Domain *result = mEnvironment.getConstructors().createInteger(boolean);
+                join(*result);
+                delete result;
+            }
+            else
+                setTop();
+            break;
+        default:
+            setTop();
+        }
+
+        collaborate();
+
+        return *this;
+    }
+
+    const Static &aa = checkedCast<Static>(a),
+        &bb = checkedCast<Static>(b);
+
+    mFirst.First::icmp(aa.mFirst, bb.mFirst, predicate);
+    mSecond.Second::icmp(aa.mSecond, bb.mSecond, predicate);
+    mThird.Third::icmp(aa.mThird, bb.mThird, predicate);
+    collaborate();
+    return *this;
+}
+
+template <typename First, typename Second, typename Third>
+Static<First, Second, Third> &
+Static<First, Second, Third>::fcmp(const Domain &a, const Domain &b,
+                                   llvm::CmpInst::Predicate predicate)
+{
+    mFirst.First::fcmp(a, b, predicate);
+    mSecond.Second::fcmp(a, b, predicate);
+    mThird.Third::fcmp(a, b, predicate);
+    collaborate();
+    return *this;
+}
+
+template <typename First, typename Second, typename Third>
+Static<First, Second, Third> &
+Static<First, Second, Third>::trunc(const Domain &value)
+{
+    const Static &product = checkedCast<Static>(value);
+    mFirst.First::trunc(product.mFirst);
+    mSecond.Second::trunc(product.mSecond);
+    mThird.Third::trunc(product.mThird);
+    collaborate();
+    return *this;
+}
+
+template <typename First, typename Second, typename Third>
+Static<First, Second, Third> &
+Static<First, Second, Third>::zext(const Domain &value)
+{
+    const Static &product = checkedCast<Static>(value);
+    mFirst.First::zext(product.mFirst);
+    mSecond.Second::zext(product.mSecond);
+    mThird.Third::zext(product.mThird);
+    collaborate();
+    return *this;
+}
+
+template <typename First, typename Second, typename Third>
+Static<First, Second, Third> &
+Static<First, Second, Third>::sext(const Domain &value)
+{
+    const Static &product = checkedCast<Static>(value);
+    mFirst.First::sext(product.mFirst);
+    mSecond.Second::sext(product.mSecond);
+    mThird.Third::sext(product.mThird);
+    collaborate();
+    return *this;
+}
+
+template <typename First, typename Second, typename Third>
+Static<First, Second, Third> &
+Static<First, Second, Third>::fptoui(const Domain &value)
+{
+    mFirst.First::fptoui(value);
+    mSecond.Second::fptoui(value);
+    mThird.Third::fptoui(value);
+    collaborate();
+    return *this;
+}
+
+template <typename First, typename Second, typename Third>
+Static<First, Second, Third> &
+Static<First, Second, Third>::fptosi(const Domain &value)
+{
+    mFirst.First::fptosi(value);
+    mSecond.Second::fptosi(value);
+    mThird.Third::fptosi(value);
+    collaborate();
+    return *this;
+}
+
+/// Meets the value extracted from a component into the result.
+/// Takes ownership of the value.
+static void
+meetExtracted(Domain *&result, Domain *value)
+{
+    if (result)
+    {
+        result->meet(*value);
+        delete value;
+    }
+    else
+        result = value;
+}
+
+template <typename First, typename Second, typename Third>
+Domain *
+Static<First, Second, Third>::extractelement(const Domain &index) const
+{
+    Domain *result = NULL;
+    meetExtracted(result, mFirst.First::extractelement(index));
+    meetExtracted(result, mSecond.Second::extractelement(index));
+    meetExtracted(result, mThird.Third::extractelement(index));
+    return result;
+}
+
+template <typename First, typename Second, typename Third>
+Static<First, Second, Third> &
+Static<First, Second, Third>::insertelement(const Domain &array,
+                                            const Domain &element,
+                                            const Domain &index)
+{
+    const Static &product = checkedCast<Static>(array);
+    mFirst.First::insertelement(product.mFirst, element, index);
+    mSecond.Second::insertelement(product.mSecond, element, index);
+    mThird.Third::insertelement(product.mThird, element, index);
+    collaborate();
+    return *this;
+}
+
+template <typename First, typename Second, typename Third>
+Static<First, Second, Third> &
+Static<First, Second, Third>::shufflevector(const Domain &a,
+                                            const Domain &b,
+                                            const std::vector<uint32_t> &mask)
+{
+    const Static &aa = checkedCast<Static>(a),
+        &bb = checkedCast<Static>(b);
+
+    mFirst.First::shufflevector(aa.mFirst, bb.mFirst, mask);
+    mSecond.Second::shufflevector(aa.mSecond, bb.mSecond, mask);
+    mThird.Third::shufflevector(aa.mThird, bb.mThird, mask);
+    collaborate();
+    return *this;
+}
+
+template <typename First, typename Second, typename Third>
+Domain *
+Static<First, Second, Third>::extractvalue(const std::vector<unsigned> &indices) const
+{
+    Domain *result = NULL;
+    meetExtracted(result, mFirst.First::extractvalue(indices));
+    meetExtracted(result, mSecond.Second::extractvalue(indices));
+    meetExtracted(result, mThird.Third::extractvalue(indices));
+    return result;
+}
+
+template <typename First, typename Second, typename Third>
+Static<First, Second, Third> &
+Static<First, Second, Third>::insertvalue(const Domain &aggregate,
+                                          const Domain &element,
+                                          const std::vector<unsigned> &indices)
+{
+    const Static &product = checkedCast<Static>(aggregate);
+    mFirst.First::insertvalue(product.mFirst, element, indices);
+    mSecond.Second::insertvalue(product.mSecond, element, indices);
+    mThird.Third::insertvalue(product.mThird, element, indices);
+    collaborate();
+    return *this;
+}
+
+template <typename First, typename Second, typename Third>
+void
+Static<First, Second, Third>::insertvalue(const Domain &element,
+                                          const std::vector<unsigned> &indices)
+{
+    mFirst.First::insertvalue(element, indices);
+    mSecond.Second::insertvalue(element, indices);
+    mThird.Third::insertvalue(element, indices);
+    collaborate();
+}
+
+template <typename First, typename Second, typename Third>
+Domain *
+Static<First, Second, Third>::load(const llvm::Type &type,
+                                   const std::vector<Domain*> &offsets) const
+{
+    if (offsets.empty())
+    {
+        if (&type == &getValueType())
+            return clone();
+        else
+        {
+            Domain *result = mEnvironment.getConstructors().create(type);
+            result->setTop();
+            return result;
+        }
+    }
+
+    Domain *subitem = extractelement(*offsets[0]);
+    Domain *result = subitem->load(type, std::vector<Domain*>(offsets.begin() + 1,
+                                                              offsets.end()));
+
+    delete subitem;
+    return result;
+}
+
+template <typename First, typename Second, typename Third>
+Static<First, Second, Third> &
+Static<First, Second, Third>::store(const Domain &value,
+                                    const std::vector<Domain*> &offsets,
+                                    bool overwrite)
+{
+    if (offsets.empty())
+    {
+        const Static &product = checkedCast<Static>(value);
+        mFirst.First::store(product.mFirst, offsets, overwrite);
+        mSecond.Second::store(product.mSecond, offsets, overwrite);
+        mThird.Third::store(product.mThird, offsets, overwrite);
+    }
+    else
+    {
+        mFirst.First::store(value, offsets, overwrite);
+        mSecond.Second::store(value, offsets, overwrite);
+        mThird.Third::store(value, offsets, overwrite);
+    }
+
+    collaborate();
+    return *this;
+}
+
+template <typename First, typename Second, typename Third>
+const llvm::Type &
+Static<First, Second, Third>::getValueType() const
+{
+    const llvm::Type &result = mFirst.First::getValueType();
+    CANAL_ASSERT(&result == &mSecond.Second::getValueType());
+    CANAL_ASSERT(&result == &mThird.Third::getValueType());
+    return result;
+}
+
+/// Refines a component by the message of the previous components
+/// and adds the information of the component to the message.
+/// @returns
+///   False if the component became bottom.
+template <typename T>
+static bool
+collaborateComponent(T &component, Message &inputMessage, bool allBottom)
+{
+    CANAL_ASSERT(allBottom || !component.T::isBottom());
+
+    component.T::refine(inputMessage);
+    if (component.T::isBottom())
+        return false;
+
+    if (!component.T::isTop())
+    {
+        Message outputMessage;
+        component.T::extract(outputMessage);
+        inputMessage.meet(outputMessage);
+    }
+
+    return true;
+}
+
+template <typename First, typename Second, typename Third>
+void
+Static<First, Second, Third>::collaborate()
+{
+    Message inputMessage;
+    bool allBottom = isBottom();
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (!collaborateComponent(mFirst, inputMessage, allBottom) ||
+            !collaborateComponent(mSecond, inputMessage, allBottom) ||
+            !collaborateComponent(mThird, inputMessage, allBottom))
+        {
+            setBottom();
+            return;
+        }
+    }
+}
+
+// Reduced product of the integer domains.
+template class Static<Integer::Bitfield, Integer::Set, Integer::Interval>;
+
+} // namespace Product
+} // namespace Canal
@@ -0,0 +1,158 @@
+#ifndef LIBCANAL_PRODUCT_STATIC_H
+#define LIBCANAL_PRODUCT_STATIC_H
+
+#include "Domain.h"
+
+namespace Canal {
+namespace Product {
+
+/// @brief
+///   Reduced product of three domains known at compile time.
+///
+/// Unlike Product::Vector, the components are stored inline, so a
+/// value is a single allocation, and the operations are forwarded
+/// to the components by qualified calls instead of virtual
+/// dispatch.  The member functions are instantiated explicitly in
+/// ProductStatic.cpp for the domain combinations used by the
+/// library.  All instantiations share a single kind, so a value
+/// must only be cast to the instantiation it was created as.
+template <typename First, typename Second, typename Third>
+class Static : public Domain
+{
+public:
+    First mFirst;
+
+    Second mSecond;
+
+    Third mThird;
+
+public:
+    /// Creates the components from the same constructor argument,
+    /// such as a bit width or a constant.
+    template <typename Argument>
+    Static(const Environment &environment, const Argument &argument)
+        : Domain(environment, Domain::ProductStaticKind),
+          mFirst(environment, argument),
+          mSecond(environment, argument),
+          mThird(environment, argument)
+    {
+    }
+
+    /// Copy constructor.
+    Static(const Static &value);
+
+    static bool classof(const Domain *value)
+    {
+        return value->getKind() == ProductStaticKind;
+    }
+
+public: // Implementation of Domain.
+    /// Covariant return type.
+    virtual Static *clone() const;
+
+    virtual size_t memoryUsage() const;
+
+    virtual size_t hash() const;
+
+    virtual std::string toString() const;
+
+    virtual void setZero(const llvm::Value *place);
+
+    virtual bool operator==(const Domain &value) const;
+
+    virtual bool operator<(const Domain &value) const;
+
+    virtual Static &join(const Domain &value);
+
+    virtual Static &meet(const Domain &value);
+
+    virtual bool isBottom() const;
+
+    virtual void setBottom();
+
+    virtual bool isTop() const;
+
+    virtual void setTop();
+
+    virtual float accuracy() const;
+
+    virtual Static &add(const Domain &a, const Domain &b);
+
+    virtual Static &sub(const Domain &a, const Domain &b);
+
+    virtual Static &mul(const Domain &a, const Domain &b);
+
+    virtual Static &udiv(const Domain &a, const Domain &b);
+
+    virtual Static &sdiv(const Domain &a, const Domain &b);
+
+    virtual Static &urem(const Domain &a, const Domain &b);
+
+    virtual Static &srem(const Domain &a, const Domain &b);
+
+    virtual Static &shl(const Domain &a, const Domain &b);
+
+    virtual Static &lshr(const Domain &a, const Domain &b);
+
+    virtual Static &ashr(const Domain &a, const Domain &b);
+
+    virtual Static &and_(const Domain &a, const Domain &b);
+
+    virtual Static &or_(const Domain &a, const Domain &b);
+
+    virtual Static &xor_(const Domain &a, const Domain &b);
+
+    virtual Static &icmp(const Domain &a, const Domain &b,
+                         llvm::CmpInst::Predicate predicate);
+
+    virtual Static &fcmp(const Domain &a, const Domain &b,
+                         llvm::CmpInst::Predicate predicate);
+
+    virtual Static &trunc(const Domain &value);
+
+    virtual Static &zext(const Domain &value);
+
+    virtual Static &sext(const Domain &value);
+
+    virtual Static &fptoui(const Domain &value);
+
+    virtual Static &fptosi(const Domain &value);
+
+    virtual Domain *extractelement(const Domain &index) const;
+
+    virtual Static &insertelement(const Domain &array,
+                                  const Domain &element,
+                                  const Domain &index);
+
+    virtual Static &shufflevector(const Domain &a,
+                                  const Domain &b,
+                                  const std::vector<uint32_t> &mask);
+
+    virtual Domain *extractvalue(const std::vector<unsigned> &indices) const;
+
+    virtual Static &insertvalue(const Domain &aggregate,
+                                const Domain &element,
+                                const std::vector<unsigned> &indices);
+
+    virtual void insertvalue(const Domain &element,
+                             const std::vector<unsigned> &indices);
+
+    virtual Domain *load(const llvm::Type &type,
+                         const std::vector<Domain*> &offsets) const;
+
+    virtual Static &store(const Domain &value,
+                          const std::vector<Domain*> &offsets,
+                          bool overwrite);
+
+    virtual const llvm::Type &getValueType() const;
+
+public: // Reduced Product
+    /// Initiate communication between contained Domains
+    /// to enhance their accuracy
+    void collaborate();
+};
+
+} // namespace Product
+} // namespace Canal
+
+#endif // LIBCANAL_PRODUCT_STATIC_H
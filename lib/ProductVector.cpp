@@ -6,7 +6,6 @@
 #include "Environment.h"
 #include "Constructors.h"
 #include "Utils.h"
-#include "Pointer.h"
 
 namespace Canal {
 namespace Product {
@@ -46,6 +45,17 @@ Vector::memoryUsage() const
     return size;
 }
 
+size_t
+Vector::hash() const
+{
+    size_t result = getKind();
+    std::vector<Domain*>::const_iterator it = mValues.begin();
+    for (; it != mValues.end(); ++it)
+        result = combineHash(result, (*it)->hash());
+
+    return result;
+}
+
 std::string
 Vector::toString() const
 {
@@ -311,61 +321,6 @@ Vector &
 Vector::icmp(const Domain &a, const Domain &b,
                 llvm::CmpInst::Predicate predicate)
 {
-    const Pointer::Pointer
-        *aPointer = dynCast<Pointer::Pointer>(&a),
-        *bPointer = dynCast<Pointer::Pointer>(&b);
-
-    if (aPointer && bPointer)
-    {
-        bool cmpSingle = aPointer->isConstant() && bPointer->isConstant(),
-            cmpeq = (*aPointer == *bPointer);
-
-        setBottom();
-        switch (predicate)
-        {
-        case llvm::CmpInst::ICMP_EQ:
-        case llvm::CmpInst::ICMP_UGE:
-        case llvm::CmpInst::ICMP_ULE:
-        case llvm::CmpInst::ICMP_SGE:
-        case llvm::CmpInst::ICMP_SLE:
-            if (cmpeq && cmpSingle)
-            {
-                Domain *one = mEnvironment.getConstructors().createInteger(llvm::APInt(1, 1, false));
-                join(*one);
-                delete one;
-            }
-            else
-            {
-                if (predicate == llvm::CmpInst::ICMP_EQ && cmpSingle)
-                {
-                    Domain *zero = mEnvironment.getConstructors().createInteger(llvm::APInt(1, 0, false));
-                    join(*zero);
-                    delete zero;
-                }
-                else
-                    setTop();
-            }
-            break;
-        case llvm::CmpInst::ICMP_NE:
-            if (cmpSingle)
-            {
-                llvm::APInt boolean(1, (cmpeq ? 0 : 1), false);
-                Domain *result = mEnvironment.getConstructors().createInteger(boolean);
-                join(*result);
-                delete result;
-            }
-            else
-                setTop();
-            break;
-        default:
-            setTop();
-        }
-
-        collaborate();
-
-        return *this;
-    }
-
     const Vector &aa = checkedCast<Vector>(a),
         &bb = checkedCast<Vector>(b);
 
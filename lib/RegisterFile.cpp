@@ -0,0 +1,304 @@
+#include "RegisterFile.h"
+#include "Domain.h"
+#include "Environment.h"
+#include "Utils.h"
+#include "InterningTable.h"
+#include "ValueTransform.h"
+
+namespace Canal {
+
+bool
+RegisterFile::operator==(const RegisterFile &registers) const
+{
+    if (&registers == this)
+        return true;
+
+    if (size() != registers.size())
+        return false;
+
+    for (const_iterator it = begin(); it != end(); ++it)
+    {
+        const value_type *slot = registers.findSlot(it->first);
+        if (!slot || !equalValues(it->second, slot->second))
+            return false;
+    }
+
+    return true;
+}
+
+RegisterFile::iterator
+RegisterFile::begin()
+{
+    return makeIterator(mRegisters.begin(), true);
+}
+
+RegisterFile::const_iterator
+RegisterFile::begin() const
+{
+    return makeIterator(mRegisters.begin(), true);
+}
+
+RegisterFile::iterator
+RegisterFile::end()
+{
+    return makeIterator(mOverflow.end(), false);
+}
+
+RegisterFile::const_iterator
+RegisterFile::end() const
+{
+    return makeIterator(mOverflow.end(), false);
+}
+
+void
+RegisterFile::clear()
+{
+    Slots::iterator it = mRegisters.begin(), itend = mRegisters.end();
+    for (; it != itend; ++it)
+    {
+        it->first = NULL;
+        it->second = NULL;
+    }
+
+    mOverflow.clear();
+    mSize = 0;
+}
+
+RegisterFile::iterator
+RegisterFile::find(const key_type &x)
+{
+    int number = getNumber(x);
+    if (number >= 0 &&
+        (size_t)number < mRegisters.size() &&
+        mRegisters[number].first == x)
+    {
+        return makeIterator(mRegisters.begin() + number, true);
+    }
+
+    Slots::iterator it = mOverflow.begin(), itend = mOverflow.end();
+    for (; it != itend; ++it)
+    {
+        if (it->first == x)
+            return makeIterator(it, false);
+    }
+
+    return end();
+}
+
+RegisterFile::const_iterator
+RegisterFile::find(const key_type &x) const
+{
+    return const_cast<RegisterFile*>(this)->find(x);
+}
+
+std::pair<RegisterFile::iterator,bool>
+RegisterFile::insert(const value_type &x)
+{
+    CANAL_ASSERT_MSG(x.first, "Attempted to insert NULL place to registers.");
+    if (!mEnvironment && x.second.data())
+        mEnvironment = &x.second->getEnvironment();
+
+    int number = getNumber(x.first);
+    if (number >= 0)
+    {
+        if ((size_t)number >= mRegisters.size())
+            mRegisters.resize(number + 1);
+
+        // Removing places refills the emptied slots from the
+        // overflow list, so a place cannot be in the overflow list
+        // while its slot is empty.
+        value_type &slot = mRegisters[number];
+        if (!slot.first)
+        {
+            slot = x;
+            ++mSize;
+            return std::make_pair(makeIterator(mRegisters.begin() + number,
+                                               true),
+                                  true);
+        }
+
+        if (slot.first == x.first)
+        {
+            return std::make_pair(makeIterator(mRegisters.begin() + number,
+                                               true),
+                                  false);
+        }
+    }
+
+    iterator it = find(x.first);
+    if (it != end())
+        return std::make_pair(it, false);
+
+    mOverflow.push_back(x);
+    ++mSize;
+    return std::make_pair(makeIterator(mOverflow.end() - 1, false), true);
+}
+
+void
+RegisterFile::insert(const llvm::Value &place, Domain *value)
+{
+    CANAL_ASSERT_MSG(value,
+                     "Attempted to insert NULL variable to state.");
+
+    iterator it = find(&place);
+    if (it != end())
+    {
+        it->second.mutable_()->join(*value);
+        delete value;
+        intern(it->second);
+    }
+    else
+    {
+        SharedDataPointer<Domain> shared(value);
+        intern(shared);
+        insert(value_type(&place, shared));
+    }
+}
+
+bool
+RegisterFile::merge(const RegisterFile &registers,
+                    StateDelta::Places *changed,
+                    const Widening::Point *widening)
+{
+    bool result = false;
+    const_iterator it2 = registers.begin(), it2end = registers.end();
+    for (; it2 != it2end; ++it2)
+    {
+        if (mergeRegister(*it2, changed, widening))
+            result = true;
+    }
+
+    return result;
+}
+
+bool
+RegisterFile::merge(const RegisterFile &registers,
+                    const StateDelta::Places &places,
+                    StateDelta::Places *changed)
+{
+    bool result = false;
+    StateDelta::Places::const_iterator it = places.begin(),
+        itend = places.end();
+
+    for (; it != itend; ++it)
+    {
+        const value_type *slot = registers.findSlot(*it);
+        if (slot && mergeRegister(*slot, changed))
+            result = true;
+    }
+
+    return result;
+}
+
+void
+RegisterFile::assign(const RegisterFile &registers)
+{
+    if (&registers == this)
+        return;
+
+    // Assigning vectors reuses the allocated slots.
+    mRegisters = registers.mRegisters;
+    mOverflow = registers.mOverflow;
+    mSize = registers.mSize;
+    if (registers.mEnvironment)
+        mEnvironment = registers.mEnvironment;
+}
+
+void
+RegisterFile::transform(ValueTransform &transform)
+{
+    for (iterator it = begin(); it != end(); ++it)
+        transform.apply(it->second);
+}
+
+size_t
+RegisterFile::memoryUsage() const
+{
+    size_t result = sizeof(RegisterFile);
+    result += mRegisters.capacity() * sizeof(value_type);
+    result += mOverflow.capacity() * sizeof(value_type);
+    for (const_iterator it = begin(); it != end(); ++it)
+        result += it->second->memoryUsage();
+
+    return result;
+}
+
+RegisterFile::value_type *
+RegisterFile::findSlot(const llvm::Value *place)
+{
+    iterator it = find(place);
+    return it == end() ? NULL : &*it;
+}
+
+const RegisterFile::value_type *
+RegisterFile::findSlot(const llvm::Value *place) const
+{
+    const_iterator it = find(place);
+    return it == end() ? NULL : &*it;
+}
+
+bool
+RegisterFile::mergeRegister(const value_type &x,
+                            StateDelta::Places *changed,
+                            const Widening::Point *widening)
+{
+    std::pair<iterator,bool> result = insert(x);
+    if (!result.second &&
+        !joinValues(result.first->second, x.second, widening))
+        return false;
+
+    if (changed)
+        changed->insert(x.first);
+
+    return true;
+}
+
+int
+RegisterFile::getNumber(const llvm::Value *place) const
+{
+    if (!mEnvironment)
+        return -1;
+
+    return mEnvironment->getRegisterNumber(*place);
+}
+
+void
+RegisterFile::refillRegisters()
+{
+    Slots::iterator out = mOverflow.begin(), it = mOverflow.begin();
+    for (; it != mOverflow.end(); ++it)
+    {
+        int number = getNumber(it->first);
+        if (number >= 0 &&
+            (size_t)number < mRegisters.size() &&
+            !mRegisters[number].first)
+        {
+            mRegisters[number] = *it;
+            continue;
+        }
+
+        if (out != it)
+            *out = *it;
+
+        ++out;
+    }
+
+    mOverflow.erase(out, mOverflow.end());
+}
+
+RegisterFile::iterator
+RegisterFile::makeIterator(Slots::iterator it, bool inRegisters)
+{
+    return iterator(it, mRegisters.end(), mOverflow.begin(), inRegisters);
+}
+
+RegisterFile::const_iterator
+RegisterFile::makeIterator(Slots::const_iterator it, bool inRegisters) const
+{
+    return const_iterator(it,
+                          mRegisters.end(),
+                          mOverflow.begin(),
+                          inRegisters);
+}
+
+} // namespace Canal
@@ -0,0 +1,261 @@
+#ifndef LIBCANAL_REGISTER_FILE_H
+#define LIBCANAL_REGISTER_FILE_H
+
+#include "SharedDataPointer.h"
+#include "StateDelta.h"
+#include "Domain.h"
+#include <vector>
+#include <cstddef>
+
+namespace Canal {
+
+class Environment;
+
+/// Map from registers (arguments and instruction results) of a
+/// function to their abstract values.  Registers are stored in a
+/// vector indexed by their number within the function (see
+/// Environment::getRegisterNumber), so lookups, merges, and
+/// comparisons do not need to search a tree.  A slot is occupied
+/// when its place is not NULL.
+///
+/// Places without a number, or places whose slot is occupied by a
+/// register of another function, are kept in a small list searched
+/// linearly.
+class RegisterFile
+{
+public:
+    typedef std::pair<const llvm::Value*, SharedDataPointer<Domain> > value_type;
+    typedef size_t size_type;
+    typedef const llvm::Value *key_type;
+
+protected:
+    typedef std::vector<value_type> Slots;
+
+    /// Slots indexed by the register number.
+    Slots mRegisters;
+
+    /// Registers that could not be stored in mRegisters.
+    Slots mOverflow;
+
+    /// Number of occupied slots in mRegisters and mOverflow.
+    size_t mSize;
+
+    /// Environment of the stored values.  It is set when the first
+    /// value is inserted.
+    const Environment *mEnvironment;
+
+public:
+    /// Iterates over occupied slots.  Registers with a number are
+    /// visited first, in the order of their numbers.
+    template <typename Value, typename SlotIterator>
+    class Iterator
+    {
+        SlotIterator mIt, mRegistersEnd, mOverflowBegin;
+
+        /// Indication that mIt points to the numbered registers.
+        bool mInRegisters;
+
+    public:
+        Iterator() : mInRegisters(false) {}
+
+        Iterator(SlotIterator it,
+                 SlotIterator registersEnd,
+                 SlotIterator overflowBegin,
+                 bool inRegisters)
+            : mIt(it),
+              mRegistersEnd(registersEnd),
+              mOverflowBegin(overflowBegin),
+              mInRegisters(inRegisters)
+        {
+            skipEmpty();
+        }
+
+        /// Allows conversion from iterator to const_iterator.
+        template <typename OtherValue, typename OtherIterator>
+        Iterator(const Iterator<OtherValue, OtherIterator> &it)
+            : mIt(it.mIt),
+              mRegistersEnd(it.mRegistersEnd),
+              mOverflowBegin(it.mOverflowBegin),
+              mInRegisters(it.mInRegisters)
+        {
+        }
+
+        Value &operator*() const
+        {
+            return *mIt;
+        }
+
+        Value *operator->() const
+        {
+            return &*mIt;
+        }
+
+        Iterator &operator++()
+        {
+            ++mIt;
+            skipEmpty();
+            return *this;
+        }
+
+        bool operator==(const Iterator &it) const
+        {
+            return mInRegisters == it.mInRegisters && mIt == it.mIt;
+        }
+
+        bool operator!=(const Iterator &it) const
+        {
+            return !operator==(it);
+        }
+
+    protected:
+        void skipEmpty()
+        {
+            if (!mInRegisters)
+                return;
+
+            while (mIt != mRegistersEnd && !mIt->first)
+                ++mIt;
+
+            if (mIt == mRegistersEnd)
+            {
+                mIt = mOverflowBegin;
+                mInRegisters = false;
+            }
+        }
+
+        template <typename OtherValue, typename OtherIterator>
+        friend class Iterator;
+    };
+
+    typedef Iterator<value_type, Slots::iterator> iterator;
+    typedef Iterator<const value_type, Slots::const_iterator> const_iterator;
+
+public:
+    RegisterFile() : mSize(0), mEnvironment(NULL) {}
+
+    bool operator==(const RegisterFile &registers) const;
+
+    iterator begin();
+
+    const_iterator begin() const;
+
+    iterator end();
+
+    const_iterator end() const;
+
+    size_type size() const
+    {
+        return mSize;
+    }
+
+    /// Remove all registers.  The slots are kept allocated, so the
+    /// register file can be refilled without allocations.
+    void clear();
+
+    iterator find(const key_type &x);
+
+    const_iterator find(const key_type &x) const;
+
+    std::pair<iterator,bool> insert(const value_type &x);
+
+    void insert(const llvm::Value &place, Domain *value);
+
+    /// @param changed
+    ///   If not NULL, the changed registers are added to it.
+    /// @param widening
+    ///   If not NULL, the changed registers are widened.
+    /// @returns
+    ///   True if this register file has changed.
+    bool merge(const RegisterFile &registers,
+               StateDelta::Places *changed = NULL,
+               const Widening::Point *widening = NULL);
+
+    /// Merge the listed registers from another register file.
+    /// @param changed
+    ///   If not NULL, the changed registers are added to it.
+    /// @returns
+    ///   True if this register file has changed.
+    bool merge(const RegisterFile &registers,
+               const StateDelta::Places &places,
+               StateDelta::Places *changed = NULL);
+
+    /// Make this register file equal to another one.  The values are
+    /// shared with the other register file.
+    void assign(const RegisterFile &registers);
+
+    /// Remove the registers whose place does not satisfy a predicate.
+    /// The registers are removed in place and the slots are kept
+    /// allocated.
+    /// @param predicate
+    ///   Function object taking a place and returning true if the
+    ///   register should be kept.
+    template <typename Predicate>
+    void retain(Predicate predicate)
+    {
+        Slots::iterator it = mRegisters.begin(), itend = mRegisters.end();
+        for (; it != itend; ++it)
+        {
+            if (!it->first || predicate(it->first))
+                continue;
+
+            it->first = NULL;
+            it->second = NULL;
+            --mSize;
+        }
+
+        Slots::iterator out = mOverflow.begin();
+        for (it = mOverflow.begin(); it != mOverflow.end(); ++it)
+        {
+            if (!predicate(it->first))
+            {
+                --mSize;
+                continue;
+            }
+
+            if (out != it)
+                *out = *it;
+
+            ++out;
+        }
+
+        mOverflow.erase(out, mOverflow.end());
+        refillRegisters();
+    }
+
+    /// Replace the values of the registers by their transformed
+    /// copies.
+    void transform(ValueTransform &transform);
+
+    /// Get memory usage (used byte count) of this register file.
+    size_t memoryUsage() const;
+
+protected:
+    /// Get the slot of a place, or NULL if the place is not stored.
+    value_type *findSlot(const llvm::Value *place);
+
+    const value_type *findSlot(const llvm::Value *place) const;
+
+    /// Insert a register, or join it with the present one.
+    /// @returns
+    ///   True if the register has changed.
+    bool mergeRegister(const value_type &x,
+                       StateDelta::Places *changed,
+                       const Widening::Point *widening = NULL);
+
+    /// Get the number of a place, or -1 if it has none.
+    int getNumber(const llvm::Value *place) const;
+
+    /// Move registers from the overflow list to their slots emptied
+    /// by retain(), so a place is never in the overflow list while
+    /// its slot is empty.
+    void refillRegisters();
+
+    iterator makeIterator(Slots::iterator it, bool inRegisters);
+
+    const_iterator makeIterator(Slots::const_iterator it,
+                                bool inRegisters) const;
+};
+
+} // namespace Canal
+
+#endif // LIBCANAL_REGISTER_FILE_H
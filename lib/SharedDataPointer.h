@@ -8,7 +8,9 @@ namespace Canal {
 class SharedData
 {
 public:
-    int mReferenceCount;
+    /// Reference count is modified by atomic operations, so the
+    /// shared data can be referenced from multiple threads.
+    volatile llvm::sys::cas_flag mReferenceCount;
 
 public:
     SharedData() : mReferenceCount(0) {}
@@ -35,13 +37,13 @@ public:
     explicit SharedDataPointer(T *ptr) : mPointer(ptr)
     {
         if (mPointer)
-            ++mPointer->mReferenceCount;
+            llvm::sys::AtomicIncrement(&mPointer->mReferenceCount);
     }
 
     SharedDataPointer(const SharedDataPointer<T> &ptr) : mPointer(ptr.mPointer)
     {
         if (mPointer)
-            ++mPointer->mReferenceCount;
+            llvm::sys::AtomicIncrement(&mPointer->mReferenceCount);
     }
 
     ~SharedDataPointer()
@@ -49,21 +51,21 @@ public:
         if (!mPointer)
             return;
 
-        if (0 == --mPointer->mReferenceCount)
+        if (0 == llvm::sys::AtomicDecrement(&mPointer->mReferenceCount))
             delete mPointer;
     }
 
-    SharedDataPointer<T> &operator=(SharedDataPointer<T> &ptr)
+    SharedDataPointer<T> &operator=(const SharedDataPointer<T> &ptr)
     {
         if (ptr.mPointer == mPointer)
             return *this;
 
-        if (mPointer && 0 == --mPointer->mReferenceCount)
+        if (mPointer && 0 == llvm::sys::AtomicDecrement(&mPointer->mReferenceCount))
             delete mPointer;
 
         mPointer = ptr.mPointer;
         if (mPointer)
-            ++mPointer->mReferenceCount;
+            llvm::sys::AtomicIncrement(&mPointer->mReferenceCount);
 
         return *this;
     }
@@ -73,12 +75,12 @@ public:
         if (ptr == mPointer)
             return *this;
 
-        if (mPointer && 0 == --mPointer->mReferenceCount)
+        if (mPointer && 0 == llvm::sys::AtomicDecrement(&mPointer->mReferenceCount))
             delete mPointer;
 
         mPointer = ptr;
         if (mPointer)
-            ++mPointer->mReferenceCount;
+            llvm::sys::AtomicIncrement(&mPointer->mReferenceCount);
 
         return *this;
     }
@@ -125,10 +127,14 @@ private:
         if (!mPointer || 1 == mPointer->mReferenceCount)
             return;
 
-        // We decrease the reference count, which is larger than 1 here.
-        --mPointer->mReferenceCount;
-        mPointer = mPointer->clone();
-        ++mPointer->mReferenceCount;
+        // Clone first, another thread might release its reference
+        // meanwhile.
+        T *clone = mPointer->clone();
+        if (0 == llvm::sys::AtomicDecrement(&mPointer->mReferenceCount))
+            delete mPointer;
+
+        mPointer = clone;
+        llvm::sys::AtomicIncrement(&mPointer->mReferenceCount);
     }
  };
 
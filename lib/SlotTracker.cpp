@@ -13,6 +13,7 @@ SlotTracker::SlotTracker(const llvm::Module &module)
 void
 SlotTracker::setActiveFunction(const llvm::Function &function)
 {
+    llvm::MutexGuard guard(mMutex);
     if (mFunction == &function)
         return;
     else if (mFunction)
@@ -26,12 +27,34 @@ SlotTracker::setActiveFunction(const llvm::Function &function)
     mFunctionProcessed = false;
 }
 
+void
+SlotTracker::reset()
+{
+    llvm::MutexGuard guard(mMutex);
+    mModuleProcessed = false;
+    mModuleMap.clear();
+    mModuleList.clear();
+    mModuleNext = 0;
+    mFunction = NULL;
+    mFunctionProcessed = false;
+    mFunctionMap.clear();
+    mFunctionList.clear();
+    mFunctionNext = 0;
+    mMetadataMap.clear();
+    mMetadataNext = 0;
+}
+
 int
 SlotTracker::getLocalSlot(const llvm::Value &value)
 {
     CANAL_ASSERT_MSG(!llvm::isa<llvm::Constant>(value),
                      "Can't get a constant or global slot with this!");
 
+    llvm::MutexGuard guard(mMutex);
+    const llvm::Function *function = getParentFunction(value);
+    if (function)
+        setActiveFunction(*function);
+
     // Check for uninitialized state and do lazy initialization.
     initialize();
 
@@ -43,6 +66,8 @@ SlotTracker::getLocalSlot(const llvm::Value &value)
 const llvm::Value *
 SlotTracker::getLocalSlot(unsigned num)
 {
+    llvm::MutexGuard guard(mMutex);
+
     // Check for uninitialized state and do lazy initialization.
     initialize();
 
@@ -52,6 +77,8 @@ SlotTracker::getLocalSlot(unsigned num)
 int
 SlotTracker::getGlobalSlot(const llvm::Value &value)
 {
+    llvm::MutexGuard guard(mMutex);
+
     // Check for uninitialized state and do lazy initialization.
     initialize();
 
@@ -63,6 +90,8 @@ SlotTracker::getGlobalSlot(const llvm::Value &value)
 const llvm::Value *
 SlotTracker::getGlobalSlot(unsigned num)
 {
+    llvm::MutexGuard guard(mMutex);
+
     // Check for uninitialized state and do lazy initialization.
     initialize();
 
@@ -72,6 +101,8 @@ SlotTracker::getGlobalSlot(unsigned num)
 int
 SlotTracker::getMetadataSlot(const llvm::MDNode &node)
 {
+    llvm::MutexGuard guard(mMutex);
+
     // Check for uninitialized state and do lazy initialization.
     initialize();
 
@@ -227,4 +258,28 @@ SlotTracker::processFunction()
     mFunctionProcessed = true;
 }
 
+const llvm::Function *
+SlotTracker::getParentFunction(const llvm::Value &value)
+{
+    if (const llvm::Instruction *instruction =
+        llvm::dyn_cast<llvm::Instruction>(&value))
+    {
+        return instruction->getParent()->getParent();
+    }
+
+    if (const llvm::BasicBlock *block =
+        llvm::dyn_cast<llvm::BasicBlock>(&value))
+    {
+        return block->getParent();
+    }
+
+    if (const llvm::Argument *argument =
+        llvm::dyn_cast<llvm::Argument>(&value))
+    {
+        return argument->getParent();
+    }
+
+    return NULL;
+}
+
 } // namespace Canal
@@ -37,6 +37,10 @@ class SlotTracker
     std::map<const llvm::MDNode*, unsigned> mMetadataMap;
     unsigned mMetadataNext;
 
+    /// Serializes access from multiple interpreter threads.  The
+    /// mutex is recursive, so public methods can call each other.
+    llvm::sys::Mutex mMutex;
+
 public:
     /// Construct from a module.
     SlotTracker(const llvm::Module &module);
@@ -45,9 +49,16 @@ public:
     /// this method to get its data into the SlotTracker.
     void setActiveFunction(const llvm::Function &function);
 
+    /// Forget all slot numbers.  Must be called when the module
+    /// changes.
+    void reset();
+
     /// Get the slot number for a value that is local to a function.
     /// Return the slot number of the specified value in it's type
     /// plane.  If something is not in the SlotTracker, return -1.
+    /// The function containing the value is made active first, so
+    /// the result does not depend on a preceding setActiveFunction
+    /// call made by another thread.
     int getLocalSlot(const llvm::Value &value);
 
     const llvm::Value *getLocalSlot(unsigned num);
@@ -104,6 +115,9 @@ protected:
     /// Add all of the functions arguments, basic blocks, and
     /// instructions.
     void processFunction();
+
+    /// Returns the function a local value belongs to, or NULL.
+    static const llvm::Function *getParentFunction(const llvm::Value &value);
 };
 
 } // namespace Canal
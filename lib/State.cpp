@@ -3,6 +3,7 @@
 #include "Utils.h"
 #include "Environment.h"
 #include "SlotTracker.h"
+#include "ValueTransform.h"
 
 namespace Canal {
 
@@ -55,38 +56,163 @@ State::operator!=(const State &state) const
 }
 
 void
-State::merge(const State &state)
+State::assign(const State &state)
 {
-    mFunctionVariables.merge(state.mFunctionVariables);
-    mFunctionBlocks.merge(state.mFunctionBlocks);
-    mergeGlobal(state);
-    mergeReturnedValue(state);
-    mVariableArguments.merge(state.mVariableArguments);
+    if (&state == this)
+        return;
+
+    mGlobalVariables.assign(state.mGlobalVariables);
+    mGlobalBlocks.assign(state.mGlobalBlocks);
+    mFunctionVariables.assign(state.mFunctionVariables);
+    mFunctionBlocks.assign(state.mFunctionBlocks);
+    delete mReturnedValue;
+    mReturnedValue = (state.mReturnedValue
+                      ? state.mReturnedValue->clone()
+                      : NULL);
+
+    mVariableArguments.assign(state.mVariableArguments);
 }
 
-void
+bool
+State::merge(const State &state,
+             StateDelta *delta,
+             const Widening::Point *widening)
+{
+    // Avoid short-circuit evaluation, everything must be merged.
+    bool changed = mFunctionVariables.merge(
+        state.mFunctionVariables,
+        delta ? &delta->mFunctionVariables : NULL,
+        widening);
+
+    changed = mFunctionBlocks.merge(
+        state.mFunctionBlocks,
+        delta ? &delta->mFunctionBlocks : NULL,
+        widening) || changed;
+
+    changed = mGlobalVariables.merge(
+        state.mGlobalVariables,
+        delta ? &delta->mGlobalVariables : NULL,
+        widening) || changed;
+
+    changed = mGlobalBlocks.merge(
+        state.mGlobalBlocks,
+        delta ? &delta->mGlobalBlocks : NULL,
+        widening) || changed;
+
+    if (mergeReturnedValue(state))
+    {
+        changed = true;
+        if (delta)
+            delta->mReturnedValue = true;
+    }
+
+    if (mVariableArguments.merge(state.mVariableArguments))
+    {
+        changed = true;
+        if (delta)
+            delta->mVariableArguments = true;
+    }
+
+    return changed;
+}
+
+bool
+State::merge(const State &state,
+             const StateDelta &delta,
+             StateDelta *changes)
+{
+    bool changed = mFunctionVariables.merge(
+        state.mFunctionVariables,
+        delta.mFunctionVariables,
+        changes ? &changes->mFunctionVariables : NULL);
+
+    changed = mFunctionBlocks.merge(
+        state.mFunctionBlocks,
+        delta.mFunctionBlocks,
+        changes ? &changes->mFunctionBlocks : NULL) || changed;
+
+    changed = mGlobalVariables.merge(
+        state.mGlobalVariables,
+        delta.mGlobalVariables,
+        changes ? &changes->mGlobalVariables : NULL) || changed;
+
+    changed = mGlobalBlocks.merge(
+        state.mGlobalBlocks,
+        delta.mGlobalBlocks,
+        changes ? &changes->mGlobalBlocks : NULL) || changed;
+
+    if (delta.mReturnedValue && mergeReturnedValue(state))
+    {
+        changed = true;
+        if (changes)
+            changes->mReturnedValue = true;
+    }
+
+    if (delta.mVariableArguments &&
+        mVariableArguments.merge(state.mVariableArguments))
+    {
+        changed = true;
+        if (changes)
+            changes->mVariableArguments = true;
+    }
+
+    return changed;
+}
+
+bool
 State::mergeGlobal(const State &state)
 {
-    mGlobalVariables.merge(state.mGlobalVariables);
-    mGlobalBlocks.merge(state.mGlobalBlocks);
+    bool changed = mGlobalVariables.merge(state.mGlobalVariables);
+    changed = mGlobalBlocks.merge(state.mGlobalBlocks) || changed;
+    return changed;
+}
+
+bool
+State::mergeGlobal(const State &state, const StateDelta &places)
+{
+    bool changed = mGlobalVariables.merge(state.mGlobalVariables,
+                                          places.mGlobalVariables);
+
+    changed = mGlobalBlocks.merge(state.mGlobalBlocks,
+                                  places.mGlobalBlocks) || changed;
+
+    return changed;
 }
 
 void
+State::restrictGlobal(const StateDelta &places)
+{
+    StateMap variables, blocks;
+    variables.merge(mGlobalVariables, places.mGlobalVariables);
+    blocks.merge(mGlobalBlocks, places.mGlobalBlocks);
+    mGlobalVariables.assign(variables);
+    mGlobalBlocks.assign(blocks);
+}
+
+bool
 State::mergeReturnedValue(const State &state)
 {
     if (!state.mReturnedValue)
-        return;
+        return false;
 
-    if (mReturnedValue)
-        mReturnedValue->join(*state.mReturnedValue);
-    else
+    if (!mReturnedValue)
+    {
         mReturnedValue = state.mReturnedValue->clone();
+        return true;
+    }
+
+    if (*mReturnedValue == *state.mReturnedValue)
+        return false;
+
+    llvm::OwningPtr<Domain> original(mReturnedValue->clone());
+    mReturnedValue->join(*state.mReturnedValue);
+    return *original != *mReturnedValue;
 }
 
-void
+bool
 State::mergeFunctionBlocks(const State &state)
 {
-    mFunctionBlocks.merge(state.mFunctionBlocks);
+    return mFunctionBlocks.merge(state.mFunctionBlocks);
 }
 
 static bool
@@ -121,27 +247,26 @@ containsPlace(const llvm::Function &function,
     return false;
 }
 
-void
+bool
 State::mergeForeignFunctionBlocks(const State &state,
                                   const llvm::Function &currentFunction)
 {
     // Merge function blocks that do not belong to current function.
+    // Blocks already present are merged regardless.
+    StateMap foreign;
     StateMap::const_iterator it2 = state.mFunctionBlocks.begin(),
         it2end = state.mFunctionBlocks.end();
 
     for (; it2 != it2end; ++it2)
     {
-	StateMap::iterator it1 = mFunctionBlocks.find(it2->first);
-	if (it1 == mFunctionBlocks.end())
+	if (mFunctionBlocks.find(it2->first) != mFunctionBlocks.end() ||
+            !containsPlace(currentFunction, it2->first))
         {
-            if (containsPlace(currentFunction, it2->first))
-                continue;
-
-            mFunctionBlocks.insert(*it2);
+            foreign.insert(*it2);
         }
-	else if (*it1->second != *it2->second)
-            it1->second.mutable_()->join(*it2->second);
     }
+
+    return mFunctionBlocks.merge(foreign);
 }
 
 void State::addGlobalVariable(const llvm::Value &place, Domain *value)
@@ -196,9 +321,9 @@ State::findVariable(const llvm::Value &place) const
     if (it != mGlobalVariables.end())
         return it->second.data();
 
-    it = mFunctionVariables.find(&place);
-    if (it != mFunctionVariables.end())
-        return it->second.data();
+    RegisterFile::const_iterator rit = mFunctionVariables.find(&place);
+    if (rit != mFunctionVariables.end())
+        return rit->second.data();
 
     return NULL;
 }
@@ -223,6 +348,17 @@ State::hasGlobalBlock(const llvm::Value &place) const
     return (mGlobalBlocks.find(&place) != mGlobalBlocks.end());
 }
 
+void
+State::transform(ValueTransform &transform)
+{
+    mGlobalVariables.transform(transform);
+    mGlobalBlocks.transform(transform);
+    mFunctionVariables.transform(transform);
+    mFunctionBlocks.transform(transform);
+    transform.apply(mReturnedValue);
+    mVariableArguments.transform(transform);
+}
+
 size_t
 State::memoryUsage() const
 {
@@ -261,15 +397,15 @@ State::toString(const llvm::Value &place,
             name << slotTracker.getGlobalSlot(place);
     }
 
-    StateMap::const_iterator it = mFunctionVariables.find(&place);
-    if (it != mFunctionVariables.end())
+    RegisterFile::const_iterator rit = mFunctionVariables.find(&place);
+    if (rit != mFunctionVariables.end())
     {
         ss << "%" << name.str() << " = "
-           << Canal::indentExceptFirstLine(it->second->toString(),
+           << Canal::indentExceptFirstLine(rit->second->toString(),
                                            name.str().length() + 4);
     }
 
-    it = mFunctionBlocks.find(&place);
+    StateMap::const_iterator it = mFunctionBlocks.find(&place);
     if (it != mFunctionBlocks.end())
     {
         ss << "%^" << name.str() << " = "
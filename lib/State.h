@@ -3,6 +3,8 @@
 
 #include "VariableArguments.h"
 #include "StateMap.h"
+#include "StateDelta.h"
+#include "RegisterFile.h"
 #include <string>
 
 namespace Canal {
@@ -37,8 +39,9 @@ class State
     ///
     /// The key (llvm::Value*) is not owned by this class.  It is not
     /// deleted.  The value (Domain*) memory is owned by this
-    /// class, so it is deleted in state destructor.
-    StateMap mFunctionVariables;
+    /// class, so it is deleted in state destructor.  Registers are
+    /// indexed by their number within the function.
+    RegisterFile mFunctionVariables;
 
     /// Nameless memory/values allocated on the stack.  The values are
     /// referenced either by a pointer in mFunctionVariables or
@@ -65,23 +68,54 @@ public:
     bool operator==(const State &state) const;
     bool operator!=(const State &state) const;
 
-    /// Merge everything.
-    void merge(const State &state);
+    /// Make this state equal to another state.  Reuses the memory
+    /// of this state, so a single state can be refilled for every
+    /// basic block instead of copying a new one.
+    void assign(const State &state);
+
+    /// Merge everything.  The merge functions return true if this
+    /// state has changed.  Values shared by both states are skipped,
+    /// so detecting a change costs time proportional to the values
+    /// that differ, unlike comparing the whole states.
+    /// @param delta
+    ///   If not NULL, the changed entries are recorded to it.
+    /// @param widening
+    ///   If not NULL, the changed variables and blocks are widened in
+    ///   place before they are joined.
+    bool merge(const State &state,
+               StateDelta *delta = NULL,
+               const Widening::Point *widening = NULL);
+
+    /// Merge the entries of another state listed in a delta.  The
+    /// other entries are not visited, so the cost is proportional to
+    /// the size of the delta.
+    /// @param changes
+    ///   If not NULL, the changed entries are recorded to it.
+    bool merge(const State &state,
+               const StateDelta &delta,
+               StateDelta *changes = NULL);
 
     /// Merge global variables and blocks.
-    void mergeGlobal(const State &state);
+    bool mergeGlobal(const State &state);
+
+    /// Merge the global variables and blocks listed in a delta.
+    bool mergeGlobal(const State &state, const StateDelta &places);
+
+    /// Remove the global variables and blocks that are not listed in
+    /// a delta.  The cost is proportional to the size of the delta.
+    void restrictGlobal(const StateDelta &places);
 
     /// Merge the returned value.
-    void mergeReturnedValue(const State &state);
+    bool mergeReturnedValue(const State &state);
 
     /// Merge function blocks only.
-    void mergeFunctionBlocks(const State &state);
+    bool mergeFunctionBlocks(const State &state);
 
     /// Merge function memory blocks external to a function.
     /// This is used after a function call, where the modifications of
     /// the global state need to be merged to the state of the caller,
     /// but its local state is not relevant.
-    void mergeForeignFunctionBlocks(const State &state,
+    bool mergeForeignFunctionBlocks(const State &state,
                                     const llvm::Function &currentFunction);
 
     /// @param place
@@ -117,6 +151,11 @@ public:
 
     void addVariableArgument(const llvm::Instruction &place, Domain *argument);
 
+    const VariableArguments &getVariableArguments() const
+    {
+        return mVariableArguments;
+    }
+
     const StateMap &getGlobalVariables() const
     {
         return mGlobalVariables;
@@ -137,12 +176,12 @@ public:
         return mGlobalBlocks;
     }
 
-    const StateMap &getFunctionVariables() const
+    const RegisterFile &getFunctionVariables() const
     {
         return mFunctionVariables;
     }
 
-    StateMap &getFunctionVariables()
+    RegisterFile &getFunctionVariables()
     {
         return mFunctionVariables;
     }
@@ -169,6 +208,9 @@ public:
 
     bool hasGlobalBlock(const llvm::Value &place) const;
 
+    /// Replace all values of the state by their transformed copies.
+    void transform(ValueTransform &transform);
+
     /// Get memory usage (used byte count) of this abstract state.
     size_t memoryUsage() const;
 
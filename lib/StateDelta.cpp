@@ -0,0 +1,46 @@
+#include "StateDelta.h"
+
+namespace Canal {
+
+bool
+StateDelta::empty() const
+{
+    return mGlobalVariables.empty() &&
+        mGlobalBlocks.empty() &&
+        mFunctionVariables.empty() &&
+        mFunctionBlocks.empty() &&
+        !mReturnedValue &&
+        !mVariableArguments;
+}
+
+void
+StateDelta::clear()
+{
+    mGlobalVariables.clear();
+    mGlobalBlocks.clear();
+    mFunctionVariables.clear();
+    mFunctionBlocks.clear();
+    mReturnedValue = false;
+    mVariableArguments = false;
+}
+
+void
+StateDelta::merge(const StateDelta &delta)
+{
+    mGlobalVariables.insert(delta.mGlobalVariables.begin(),
+                            delta.mGlobalVariables.end());
+
+    mGlobalBlocks.insert(delta.mGlobalBlocks.begin(),
+                         delta.mGlobalBlocks.end());
+
+    mFunctionVariables.insert(delta.mFunctionVariables.begin(),
+                              delta.mFunctionVariables.end());
+
+    mFunctionBlocks.insert(delta.mFunctionBlocks.begin(),
+                           delta.mFunctionBlocks.end());
+
+    mReturnedValue = mReturnedValue || delta.mReturnedValue;
+    mVariableArguments = mVariableArguments || delta.mVariableArguments;
+}
+
+} // namespace Canal
@@ -0,0 +1,43 @@
+#ifndef LIBCANAL_STATE_DELTA_H
+#define LIBCANAL_STATE_DELTA_H
+
+#include "Prereq.h"
+#include <set>
+
+namespace Canal {
+
+/// Places whose entries have changed in a state.  The delta is
+/// recorded while merging states, so the changes can be propagated
+/// further by merging only the changed entries instead of the whole
+/// states.
+class StateDelta
+{
+public:
+    typedef std::set<const llvm::Value*> Places;
+
+    Places mGlobalVariables;
+    Places mGlobalBlocks;
+    Places mFunctionVariables;
+    Places mFunctionBlocks;
+
+    /// Indication that the returned value has changed.
+    bool mReturnedValue;
+
+    /// Indication that the variable arguments have changed.  They are
+    /// always merged as a whole.
+    bool mVariableArguments;
+
+public:
+    StateDelta() : mReturnedValue(false), mVariableArguments(false) {}
+
+    bool empty() const;
+
+    void clear();
+
+    /// Add the changes recorded in another delta.
+    void merge(const StateDelta &delta);
+};
+
+} // namespace Canal
+
+#endif // LIBCANAL_STATE_DELTA_H
@@ -1,15 +1,520 @@
 #include "StateMap.h"
 #include "Domain.h"
 #include "Utils.h"
-#if 0 //Print differences in state map for fixpoint calculation
-#include <iostream>
-#endif
+#include "InterningTable.h"
+#include "ValueTransform.h"
+
 namespace Canal {
 
-StateMap::StateMap(const StateMap &map) : mMap(map.mMap)
+typedef StateMap::Node Node;
+
+static const unsigned LEVEL_MASK = (1 << StateMap::LEVEL_BITS) - 1;
+
+static unsigned
+hashPlace(const llvm::Value *place)
+{
+    return llvm::DenseMapInfo<const llvm::Value*>::getHashValue(place);
+}
+
+static unsigned
+countBits(uint32_t bits)
+{
+    unsigned result = 0;
+    for (; bits; ++result)
+        bits &= bits - 1;
+
+    return result;
+}
+
+/// Get the position in mChildren of a child for a bit of the bitmap.
+static unsigned
+getChildPosition(const Node &node, unsigned bit)
+{
+    return countBits(node.mBitmap & ((1u << bit) - 1));
+}
+
+static unsigned
+getBit(unsigned hash, unsigned shift)
+{
+    return (hash >> shift) & LEVEL_MASK;
+}
+
+static void
+updateSize(Node &node)
+{
+    node.mSize = 0;
+    std::vector<SharedDataPointer<Node> >::const_iterator it =
+        node.mChildren.begin(), itend = node.mChildren.end();
+
+    for (; it != itend; ++it)
+        node.mSize += (*it)->mSize;
+}
+
+static const StateMap::value_type *
+lookup(const Node *node,
+       unsigned hash,
+       unsigned shift,
+       const llvm::Value *place)
+{
+    while (node)
+    {
+        if (node->isLeaf())
+        {
+            if (node->mHash != hash)
+                return NULL;
+
+            std::vector<StateMap::value_type>::const_iterator it =
+                node->mEntries.begin(), itend = node->mEntries.end();
+
+            for (; it != itend; ++it)
+            {
+                if (it->first == place)
+                    return &*it;
+            }
+
+            return NULL;
+        }
+
+        unsigned bit = getBit(hash, shift);
+        if (!(node->mBitmap & (1u << bit)))
+            return NULL;
+
+        node = node->mChildren[getChildPosition(*node, bit)].data();
+        shift += StateMap::LEVEL_BITS;
+    }
+
+    return NULL;
+}
+
+/// Replace a leaf by a branch that has the leaf as its only child.
+static void
+splitLeaf(SharedDataPointer<Node> &node, unsigned shift)
+{
+    Node *branch = new Node();
+    branch->mBitmap = 1u << getBit(node->mHash, shift);
+    branch->mChildren.push_back(node);
+    branch->mSize = node->mSize;
+    node = branch;
+}
+
+/// Insert an entry to a subtree, or join it with the value of the
+/// same place.
+/// @param widening
+///   If not NULL, a present value is widened before the join.
+/// @returns
+///   True if the subtree has changed.
+static bool
+mergeEntry(SharedDataPointer<Node> &node,
+           unsigned hash,
+           unsigned shift,
+           const StateMap::value_type &entry,
+           const Widening::Point *widening = NULL)
+{
+    if (!node)
+    {
+        node = new Node(hash, entry);
+        return true;
+    }
+
+    if (node->isLeaf())
+    {
+        if (node->mHash == hash)
+        {
+            Node *leaf = node.mutable_();
+            std::vector<StateMap::value_type>::iterator it =
+                leaf->mEntries.begin(), itend = leaf->mEntries.end();
+
+            for (; it != itend; ++it)
+            {
+                if (it->first != entry.first)
+                    continue;
+
+                return joinValues(it->second, entry.second, widening);
+            }
+
+            leaf->mEntries.push_back(entry);
+            ++leaf->mSize;
+            return true;
+        }
+
+        // Hashes differ, so they differ in the bits of this or
+        // a deeper level.
+        splitLeaf(node, shift);
+    }
+
+    Node *branch = node.mutable_();
+    unsigned bit = getBit(hash, shift);
+    unsigned position = getChildPosition(*branch, bit);
+    bool changed = true;
+    if (branch->mBitmap & (1u << bit))
+    {
+        changed = mergeEntry(branch->mChildren[position],
+                             hash,
+                             shift + StateMap::LEVEL_BITS,
+                             entry,
+                             widening);
+    }
+    else
+    {
+        branch->mBitmap |= 1u << bit;
+        branch->mChildren.insert(branch->mChildren.begin() + position,
+                                 SharedDataPointer<Node>(new Node(hash, entry)));
+    }
+
+    updateSize(*branch);
+    return changed;
+}
+
+/// Remove the entry of a place from a subtree that contains it.
+/// Branches left with a single leaf are replaced by the leaf, so the
+/// shape of the trie stays determined by the places it contains.
+static void
+eraseEntry(SharedDataPointer<Node> &node,
+           unsigned hash,
+           unsigned shift,
+           const llvm::Value *place)
+{
+    if (node->isLeaf())
+    {
+        if (node->mEntries.size() == 1)
+        {
+            node = NULL;
+            return;
+        }
+
+        Node *leaf = node.mutable_();
+        std::vector<StateMap::value_type>::iterator it =
+            leaf->mEntries.begin();
+
+        while (it->first != place)
+            ++it;
+
+        leaf->mEntries.erase(it);
+        --leaf->mSize;
+        return;
+    }
+
+    Node *branch = node.mutable_();
+    unsigned bit = getBit(hash, shift);
+    unsigned position = getChildPosition(*branch, bit);
+    eraseEntry(branch->mChildren[position],
+               hash,
+               shift + StateMap::LEVEL_BITS,
+               place);
+
+    if (!branch->mChildren[position])
+    {
+        branch->mBitmap &= ~(1u << bit);
+        branch->mChildren.erase(branch->mChildren.begin() + position);
+    }
+
+    if (branch->mChildren.empty())
+        node = NULL;
+    else if (branch->mChildren.size() == 1 && branch->mChildren[0]->isLeaf())
+    {
+        SharedDataPointer<Node> leaf(branch->mChildren[0]);
+        node = leaf;
+    }
+    else
+        updateSize(*branch);
+}
+
+static void
+collectPlaces(const Node &node, StateDelta::Places &places)
+{
+    std::vector<SharedDataPointer<Node> >::const_iterator it =
+        node.mChildren.begin(), itend = node.mChildren.end();
+
+    for (; it != itend; ++it)
+        collectPlaces(**it, places);
+
+    std::vector<StateMap::value_type>::const_iterator eit =
+        node.mEntries.begin(), eitend = node.mEntries.end();
+
+    for (; eit != eitend; ++eit)
+        places.insert(eit->first);
+}
+
+/// Merge the second subtree to the first one.  Subtrees shared by
+/// both of them are skipped, so the cost is proportional to the
+/// entries that differ.
+/// @param places
+///   If not NULL, the places of changed entries are added to it.
+/// @param widening
+///   If not NULL, the changed entries are widened.
+/// @returns
+///   True if the first subtree has changed.
+static bool
+mergeNodes(SharedDataPointer<Node> &first,
+           const SharedDataPointer<Node> &second,
+           unsigned shift,
+           StateDelta::Places *places,
+           const Widening::Point *widening)
+{
+    if (first == second || !second)
+        return false;
+
+    if (!first)
+    {
+        first = second;
+        if (places)
+            collectPlaces(*second, *places);
+
+        return true;
+    }
+
+    bool changed = false;
+    if (second->isLeaf())
+    {
+        std::vector<StateMap::value_type>::const_iterator it =
+            second->mEntries.begin(), itend = second->mEntries.end();
+
+        for (; it != itend; ++it)
+        {
+            // Avoid copying the path when nothing changes.
+            const StateMap::value_type *value =
+                lookup(first.data(), second->mHash, shift, it->first);
+
+            if (value && equalValues(value->second, it->second))
+                continue;
+
+            if (mergeEntry(first, second->mHash, shift, *it, widening))
+            {
+                changed = true;
+                if (places)
+                    places->insert(it->first);
+            }
+        }
+
+        return changed;
+    }
+
+    if (first->isLeaf())
+        splitLeaf(first, shift);
+
+    // A shared branch is copied only when some child changes, so
+    // merging equal subtrees does not duplicate the path to them.
+    Node *branch = NULL;
+    if (first->mReferenceCount == 1)
+        branch = first.mutable_();
+
+    for (unsigned bit = 0; bit <= LEVEL_MASK; ++bit)
+    {
+        if (!(second->mBitmap & (1u << bit)))
+            continue;
+
+        const SharedDataPointer<Node> &child =
+            second->mChildren[getChildPosition(*second, bit)];
+
+        unsigned position = getChildPosition(*first, bit);
+        bool present = first->mBitmap & (1u << bit);
+        if (present && first->mChildren[position] == child)
+            continue;
+
+        if (present && !branch)
+        {
+            SharedDataPointer<Node> merged(first->mChildren[position]);
+            if (!mergeNodes(merged,
+                            child,
+                            shift + StateMap::LEVEL_BITS,
+                            places,
+                            widening))
+            {
+                continue;
+            }
+
+            branch = first.mutable_();
+            branch->mChildren[position] = merged;
+            changed = true;
+        }
+        else if (present)
+        {
+            if (mergeNodes(branch->mChildren[position],
+                           child,
+                           shift + StateMap::LEVEL_BITS,
+                           places,
+                           widening))
+            {
+                changed = true;
+            }
+        }
+        else
+        {
+            if (!branch)
+                branch = first.mutable_();
+
+            branch->mBitmap |= 1u << bit;
+            branch->mChildren.insert(branch->mChildren.begin() + position,
+                                     child);
+            changed = true;
+            if (places)
+                collectPlaces(*child, *places);
+        }
+    }
+
+    if (branch)
+        updateSize(*branch);
+
+    return changed;
+}
+
+static bool
+equalNodes(const Node *first, const Node *second)
+{
+    if (first == second)
+        return true;
+
+    if (!first || !second || first->mSize != second->mSize)
+        return false;
+
+    // The shape of the trie is determined by the places it contains,
+    // so maps with the same places have the same shape.
+    if (first->isLeaf() != second->isLeaf())
+        return false;
+
+    if (first->isLeaf())
+    {
+        std::vector<StateMap::value_type>::const_iterator it =
+            first->mEntries.begin(), itend = first->mEntries.end();
+
+        for (; it != itend; ++it)
+        {
+            const StateMap::value_type *value =
+                lookup(second, first->mHash, 0, it->first);
+
+            if (!value || !equalValues(value->second, it->second))
+                return false;
+        }
+
+        return true;
+    }
+
+    if (first->mBitmap != second->mBitmap)
+        return false;
+
+    for (size_t i = 0; i < first->mChildren.size(); ++i)
+    {
+        if (!equalNodes(first->mChildren[i].data(),
+                        second->mChildren[i].data()))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// Replace the subtrees of the first node that are equal to the
+/// subtrees of the second node by the subtrees of the second node.
+/// @returns
+///   True if the first node has become the second node.
+static bool
+shareNodes(SharedDataPointer<Node> &first,
+           const SharedDataPointer<Node> &second)
+{
+    if (first == second)
+        return true;
+
+    if (!first || !second)
+        return false;
+
+    // Only branches with the same children can be shared partially.
+    if (first->isLeaf() || second->isLeaf() ||
+        first->mBitmap != second->mBitmap)
+    {
+        if (!equalNodes(first.data(), second.data()))
+            return false;
+
+        first = second;
+        return true;
+    }
+
+    bool equal = true;
+    Node *branch = NULL;
+    for (size_t i = 0; i < second->mChildren.size(); ++i)
+    {
+        if (first->mChildren[i] == second->mChildren[i])
+            continue;
+
+        SharedDataPointer<Node> child(first->mChildren[i]);
+        if (!shareNodes(child, second->mChildren[i]))
+            equal = false;
+
+        if (child == first->mChildren[i])
+            continue;
+
+        if (!branch)
+            branch = first.mutable_();
+
+        branch->mChildren[i] = child;
+    }
+
+    if (equal)
+        first = second;
+
+    return equal;
+}
+
+static size_t
+nodeMemoryUsage(const Node &node)
+{
+    size_t result = sizeof(Node);
+    result += node.mChildren.capacity() * sizeof(SharedDataPointer<Node>);
+    result += node.mEntries.capacity() * sizeof(StateMap::value_type);
+
+    std::vector<SharedDataPointer<Node> >::const_iterator it =
+        node.mChildren.begin(), itend = node.mChildren.end();
+
+    for (; it != itend; ++it)
+        result += nodeMemoryUsage(**it);
+
+    std::vector<StateMap::value_type>::const_iterator eit =
+        node.mEntries.begin(), eitend = node.mEntries.end();
+
+    for (; eit != eitend; ++eit)
+        result += eit->second->memoryUsage();
+
+    return result;
+}
+
+StateMap::const_iterator &
+StateMap::const_iterator::operator++()
+{
+    CANAL_ASSERT_MSG(mDepth > 0, "Incrementing the end iterator.");
+    if (++mIndices[mDepth - 1] < mNodes[mDepth - 1]->mEntries.size())
+        return *this;
+
+    // Leave the leaf and the branches with no further children.
+    while (--mDepth > 0)
+    {
+        if (++mIndices[mDepth - 1] < mNodes[mDepth - 1]->mChildren.size())
+        {
+            descend();
+            break;
+        }
+    }
+
+    return *this;
+}
+
+void
+StateMap::const_iterator::descend()
+{
+    while (true)
+    {
+        const Node *node = mNodes[mDepth - 1];
+        if (node->isLeaf())
+            return;
+
+        CANAL_ASSERT(mDepth < MAX_DEPTH);
+        mNodes[mDepth] = node->mChildren[mIndices[mDepth - 1]].data();
+        mIndices[mDepth] = 0;
+        ++mDepth;
+    }
+}
+
+StateMap::StateMap(const StateMap &map) : mRoot(map.mRoot)
 {
-    for (iterator it = begin(); it != end(); ++it)
-        it->second = it->second->clone();
 }
 
 StateMap::~StateMap()
@@ -22,36 +527,133 @@ StateMap::operator==(const StateMap &map) const
     if (&map == this)
         return true;
 
-    if (size() != map.size())
-        return false;
+    return equalNodes(mRoot.data(), map.mRoot.data());
+}
+
+StateMap::const_iterator
+StateMap::begin() const
+{
+    const_iterator result;
+    if (!mRoot)
+        return result;
+
+    result.mNodes[0] = mRoot.data();
+    result.mIndices[0] = 0;
+    result.mDepth = 1;
+    result.descend();
+    return result;
+}
 
-    for (const_iterator it = begin(); it != end(); ++it)
+StateMap::const_iterator
+StateMap::find(const key_type &x) const
+{
+    const_iterator result;
+    const Node *node = mRoot.data();
+    unsigned hash = hashPlace(x), shift = 0;
+    while (node)
     {
-        StateMap::const_iterator mapit = map.find(it->first);
-        if (mapit == map.end() || *it->second != *mapit->second) {
-#if 0 //Print differences in state map for fixpoint calculation
-            if (mapit == map.end()) std::cout << "Map ended" << std::endl;
-            else std::cout << (*it->second).toString() << (*mapit->second).toString() << std::endl;
-#endif
-            return false;
+        result.mNodes[result.mDepth] = node;
+        if (node->isLeaf())
+        {
+            if (node->mHash != hash)
+                return end();
+
+            for (unsigned i = 0; i < node->mEntries.size(); ++i)
+            {
+                if (node->mEntries[i].first != x)
+                    continue;
+
+                result.mIndices[result.mDepth++] = i;
+                return result;
+            }
+
+            return end();
         }
+
+        unsigned bit = getBit(hash, shift);
+        if (!(node->mBitmap & (1u << bit)))
+            return end();
+
+        unsigned position = getChildPosition(*node, bit);
+        result.mIndices[result.mDepth++] = position;
+        node = node->mChildren[position].data();
+        shift += LEVEL_BITS;
     }
 
+    return end();
+}
+
+bool
+StateMap::insert(const value_type &x)
+{
+    unsigned hash = hashPlace(x.first);
+    if (lookup(mRoot.data(), hash, 0, x.first))
+        return false;
+
+    mergeEntry(mRoot, hash, 0, x);
     return true;
 }
 
-void
-StateMap::merge(const StateMap &map)
+bool
+StateMap::erase(const key_type &x)
+{
+    unsigned hash = hashPlace(x);
+    if (!lookup(mRoot.data(), hash, 0, x))
+        return false;
+
+    eraseEntry(mRoot, hash, 0, x);
+    return true;
+}
+
+bool
+StateMap::merge(const StateMap &map,
+                StateDelta::Places *changed,
+                const Widening::Point *widening)
+{
+    return mergeNodes(mRoot, map.mRoot, 0, changed, widening);
+}
+
+bool
+StateMap::merge(const StateMap &map,
+                const StateDelta::Places &places,
+                StateDelta::Places *changed)
 {
-    const_iterator it2 = map.begin(), it2end = map.end();
-    for (; it2 != it2end; ++it2)
+    bool result = false;
+    StateDelta::Places::const_iterator it = places.begin(),
+        itend = places.end();
+
+    for (; it != itend; ++it)
     {
-	iterator it1 = find(it2->first);
-	if (it1 == end())
-            insert(*it2);
-	else if (*it1->second != *it2->second)
-            it1->second.mutable_()->join(*it2->second);
+        unsigned hash = hashPlace(*it);
+        const value_type *entry = lookup(map.mRoot.data(), hash, 0, *it);
+        if (!entry)
+            continue;
+
+        const value_type *value = lookup(mRoot.data(), hash, 0, *it);
+        if (value && equalValues(value->second, entry->second))
+            continue;
+
+        if (!mergeEntry(mRoot, hash, 0, *entry))
+            continue;
+
+        result = true;
+        if (changed)
+            changed->insert(*it);
     }
+
+    return result;
+}
+
+void
+StateMap::assign(const StateMap &map)
+{
+    mRoot = map.mRoot;
+}
+
+bool
+StateMap::share(const StateMap &map)
+{
+    return shareNodes(mRoot, map.mRoot);
 }
 
 void
@@ -60,22 +662,79 @@ StateMap::insert(const llvm::Value &place, Domain *value)
     CANAL_ASSERT_MSG(value,
                      "Attempted to insert NULL variable to state.");
 
-    iterator it = find(&place);
-    if (it != end())
+    value_type *existing = findMutable(&place);
+    if (existing)
     {
-        it->second.mutable_()->join(*value);
+        existing->second.mutable_()->join(*value);
         delete value;
+        intern(existing->second);
     }
     else
-        insert(value_type(&place, SharedDataPointer<Domain>(value)));
+    {
+        SharedDataPointer<Domain> shared(value);
+        intern(shared);
+        insert(value_type(&place, shared));
+    }
+}
+
+bool
+StateMap::join(const value_type &x, const Widening::Point *widening)
+{
+    return mergeEntry(mRoot, hashPlace(x.first), 0, x, widening);
+}
+
+StateMap::value_type *
+StateMap::findMutable(const llvm::Value *place)
+{
+    unsigned hash = hashPlace(place);
+    if (!lookup(mRoot.data(), hash, 0, place))
+        return NULL;
+
+    SharedDataPointer<Node> *node = &mRoot;
+    unsigned shift = 0;
+    while (true)
+    {
+        Node *mutableNode = node->mutable_();
+        if (mutableNode->isLeaf())
+        {
+            std::vector<value_type>::iterator it =
+                mutableNode->mEntries.begin();
+
+            while (it->first != place)
+                ++it;
+
+            return &*it;
+        }
+
+        unsigned bit = getBit(hash, shift);
+        node = &mutableNode->mChildren[getChildPosition(*mutableNode, bit)];
+        shift += LEVEL_BITS;
+    }
+}
+
+void
+StateMap::transform(ValueTransform &transform)
+{
+    std::vector<value_type> changed;
+    const_iterator it = begin(), itend = end();
+    for (; it != itend; ++it)
+    {
+        SharedDataPointer<Domain> value(it->second);
+        if (transform.apply(value))
+            changed.push_back(value_type(it->first, value));
+    }
+
+    std::vector<value_type>::const_iterator cit = changed.begin();
+    for (; cit != changed.end(); ++cit)
+        findMutable(cit->first)->second = cit->second;
 }
 
 size_t
 StateMap::memoryUsage() const
 {
-    size_t result = sizeof(StateMap) + mMap.size() * (sizeof(const llvm::Value*) + sizeof(Domain*));
-    for (const_iterator it = begin(); it != end(); ++it)
-        result += it->second->memoryUsage();
+    size_t result = sizeof(StateMap);
+    if (mRoot.data())
+        result += nodeMemoryUsage(*mRoot);
 
     return result;
 }
@@ -2,88 +2,228 @@
 #define LIBCANAL_STATE_MAP_H
 
 #include "SharedDataPointer.h"
+#include "StateDelta.h"
 #include "Domain.h"
-#include <map>
+#include <vector>
 #include <cstddef>
 
 namespace Canal {
 
 class Domain;
 
+/// Persistent map from places to abstract values.  It is a hash array
+/// mapped trie whose nodes are shared between copies of the map, so
+/// copying a map is a constant time operation and a modification
+/// copies only the nodes on the path to the modified entry.  Merging
+/// and comparing maps skips subtrees that are shared by both maps.
 class StateMap
 {
+public:
     /// llvm::Value represents a place in the program (an instruction,
     /// instance of llvm::Instruction).
-    typedef std::map<const llvm::Value*, SharedDataPointer<Domain> > Map;
-    Map mMap;
+    typedef std::pair<const llvm::Value*, SharedDataPointer<Domain> > value_type;
+    typedef size_t size_type;
+    typedef const llvm::Value *key_type;
 
-public:
-    typedef Map::iterator iterator;
-    typedef Map::const_iterator const_iterator;
-    typedef Map::value_type value_type;
-    typedef Map::size_type size_type;
-    typedef Map::key_type key_type;
+    /// Number of hash bits consumed by a level of the trie.
+    static const unsigned LEVEL_BITS = 5;
+
+    /// Maximal number of nodes on a path from the root to a leaf.
+    static const unsigned MAX_DEPTH = 8;
+
+    /// Node of the trie.  A node is either a branch with up to 32
+    /// children, or a leaf with entries that have the same hash.
+    class Node : public SharedData
+    {
+    public:
+        /// Bit i is set when the branch has a child for the hash
+        /// bits i at its level.
+        uint32_t mBitmap;
+
+        /// Children of a branch, in the order of bits in mBitmap.
+        std::vector<SharedDataPointer<Node> > mChildren;
+
+        /// Hash of the entries of a leaf.
+        unsigned mHash;
+
+        /// Entries of a leaf.  Leaves have at least one entry; more
+        /// than one only when the hashes of places collide.
+        std::vector<value_type> mEntries;
+
+        /// Number of entries in the subtree.
+        size_t mSize;
+
+    public:
+        Node() : mBitmap(0), mHash(0), mSize(0) {}
+
+        Node(unsigned hash, const value_type &entry)
+            : mBitmap(0), mHash(hash), mEntries(1, entry), mSize(1) {}
+
+        bool isLeaf() const
+        {
+            return !mEntries.empty();
+        }
+
+        Node *clone() const
+        {
+            return new Node(*this);
+        }
+    };
+
+    /// Iterates over the entries of the map in the order of hashes.
+    class const_iterator
+    {
+        /// Path from the root to the current leaf.  For branches, the
+        /// index is the position of the child on the path.  For the
+        /// leaf, it is the position of the current entry.
+        const Node *mNodes[MAX_DEPTH];
+        unsigned mIndices[MAX_DEPTH];
+
+        /// Number of nodes on the path.  Zero at the end of the map.
+        unsigned mDepth;
+
+    public:
+        const_iterator() : mDepth(0) {}
+
+        const value_type &operator*() const
+        {
+            return mNodes[mDepth - 1]->mEntries[mIndices[mDepth - 1]];
+        }
+
+        const value_type *operator->() const
+        {
+            return &operator*();
+        }
+
+        const_iterator &operator++();
+
+        bool operator==(const const_iterator &it) const
+        {
+            if (mDepth != it.mDepth)
+                return false;
+
+            return mDepth == 0 ||
+                (mNodes[mDepth - 1] == it.mNodes[mDepth - 1] &&
+                 mIndices[mDepth - 1] == it.mIndices[mDepth - 1]);
+        }
+
+        bool operator!=(const const_iterator &it) const
+        {
+            return !operator==(it);
+        }
+
+    protected:
+        /// Descend to the first entry of the subtree of the last node
+        /// on the path.
+        void descend();
+
+        friend class StateMap;
+    };
+
+    typedef const_iterator iterator;
+
+protected:
+    SharedDataPointer<Node> mRoot;
 
 public:
     StateMap() {}
 
+    /// The whole trie is shared with the copied map until it is
+    /// modified.
     StateMap(const StateMap &map);
 
     ~StateMap();
 
     bool operator==(const StateMap &map) const;
 
-    iterator begin()
-    {
-        return mMap.begin();
-    }
-
-    const_iterator begin() const
-    {
-        return mMap.begin();
-    }
-
-    iterator end()
-    {
-        return mMap.end();
-    }
+    const_iterator begin() const;
 
     const_iterator end() const
     {
-        return mMap.end();
+        return const_iterator();
     }
 
     size_type size() const
     {
-        return mMap.size();
+        return mRoot.data() ? mRoot->mSize : 0;
     }
 
     void clear()
     {
-        mMap.clear();
+        mRoot = NULL;
     }
 
-    iterator find(const key_type &x)
-    {
-        return mMap.find(x);
-    }
-
-    const_iterator find(const key_type &x) const
-    {
-        return mMap.find(x);
-    }
-
-    std::pair<iterator,bool> insert(const value_type &x)
-    {
-        return mMap.insert(x);
-    }
-
-    void merge(const StateMap &map);
+    const_iterator find(const key_type &x) const;
+
+    /// Insert an entry unless the place is already present.
+    /// @returns
+    ///   True if the entry has been inserted.
+    bool insert(const value_type &x);
+
+    /// Remove the entry of a place.  Shared nodes on the path to the
+    /// entry are copied; the map is not modified when the place is not
+    /// present.
+    /// @returns
+    ///   True if the entry has been removed.
+    bool erase(const key_type &x);
+
+    /// Merge another map into this one.  Entries whose values are
+    /// shared by both maps are skipped.
+    /// @param changed
+    ///   If not NULL, the places of changed entries are added to it.
+    /// @param widening
+    ///   If not NULL, the changed entries are widened.
+    /// @returns
+    ///   True if this map has changed.
+    bool merge(const StateMap &map,
+               StateDelta::Places *changed = NULL,
+               const Widening::Point *widening = NULL);
+
+    /// Merge the entries of the listed places from another map into
+    /// this one.  Other entries are not visited.
+    /// @param changed
+    ///   If not NULL, the places of changed entries are added to it.
+    /// @returns
+    ///   True if this map has changed.
+    bool merge(const StateMap &map,
+               const StateDelta::Places &places,
+               StateDelta::Places *changed = NULL);
+
+    /// Make this map equal to another map.  The trie is shared with
+    /// the other map, so it is a constant time operation.
+    void assign(const StateMap &map);
+
+    /// Make the entries of this map that are equal to the entries of
+    /// another map share the memory of the other map.  The content
+    /// of this map does not change.
+    /// @returns
+    ///   True if this map shares the whole trie with the other map.
+    bool share(const StateMap &map);
 
     void insert(const llvm::Value &place, Domain *value);
 
+    /// Insert an entry, or join its value to the value of the same
+    /// place.  The joined value is interned, so its memory is
+    /// accounted.
+    /// @param widening
+    ///   If not NULL, a present value is widened before the join.
+    /// @returns
+    ///   True if this map has changed.
+    bool join(const value_type &x,
+              const Widening::Point *widening = NULL);
+
+    /// Replace the values of the map by their transformed copies.
+    /// Shared nodes are copied only on the paths to the changed
+    /// entries.
+    void transform(ValueTransform &transform);
+
     /// Get memory usage (used byte count) of this state map.
     size_t memoryUsage() const;
+
+protected:
+    /// Find the entry of a place and copy the shared nodes on the
+    /// path to it.  The value itself is not copied.
+    value_type *findMutable(const llvm::Value *place);
 };
 
 } // namespace Canal
@@ -63,6 +63,17 @@ Structure::memoryUsage() const
     return size;
 }
 
+size_t
+Structure::hash() const
+{
+    size_t result = getKind();
+    std::vector<Domain*>::const_iterator it = mMembers.begin();
+    for (; it != mMembers.end(); ++it)
+        result = combineHash(result, (*it)->hash());
+
+    return result;
+}
+
 std::string
 Structure::toString() const
 {
@@ -373,9 +384,10 @@ Structure::store(const Domain &value,
             // If some offset from the set points out of the
             // array bounds, we ignore it FOR NOW.  It might be caused
             // either by a bug in the code, or by imprecision of the
-            // interpreter.
+            // interpreter.  Offsets are sorted, so all the following
+            // ones are out of bounds as well.
             if (numOffset >= mMembers.size())
-                continue;
+                break;
 
             mMembers[numOffset]->store(value,
                                        std::vector<Domain*>(offsets.begin() + 1,
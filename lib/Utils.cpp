@@ -2,6 +2,8 @@
 #include "SlotTracker.h"
 #include <execinfo.h>
 #include <cxxabi.h>
+#include <algorithm>
+#include <map>
 
 namespace Canal {
 
@@ -161,4 +163,319 @@ getCurrentBacktrace()
     return ss.str();
 }
 
+void
+findStronglyConnectedComponents(
+    const std::vector<std::vector<unsigned> > &successors,
+    const std::vector<unsigned> &vertices,
+    std::vector<std::vector<unsigned> > &components)
+{
+    // Tarjan's algorithm.  The recursion is replaced by an explicit
+    // stack of vertices and positions in their successor lists.
+    const unsigned unvisited = ~0U;
+    std::vector<unsigned> index(successors.size(), unvisited),
+        lowlink(successors.size(), 0);
+
+    std::vector<bool> member(successors.size(), false),
+        onStack(successors.size(), false);
+
+    std::vector<unsigned>::const_iterator it = vertices.begin(),
+        itend = vertices.end();
+
+    for (; it != itend; ++it)
+        member[*it] = true;
+
+    std::vector<unsigned> stack;
+    std::vector<std::pair<unsigned, unsigned> > callStack;
+    std::vector<std::vector<unsigned> > found;
+    unsigned counter = 0;
+    for (it = vertices.begin(); it != itend; ++it)
+    {
+        if (index[*it] != unvisited)
+            continue;
+
+        index[*it] = lowlink[*it] = counter++;
+        stack.push_back(*it);
+        onStack[*it] = true;
+        callStack.push_back(std::make_pair(*it, 0U));
+        while (!callStack.empty())
+        {
+            unsigned vertex = callStack.back().first;
+            unsigned position = callStack.back().second;
+            if (position < successors[vertex].size())
+            {
+                ++callStack.back().second;
+                unsigned successor = successors[vertex][position];
+                if (!member[successor])
+                    continue;
+
+                if (index[successor] == unvisited)
+                {
+                    index[successor] = lowlink[successor] = counter++;
+                    stack.push_back(successor);
+                    onStack[successor] = true;
+                    callStack.push_back(std::make_pair(successor, 0U));
+                }
+                else if (onStack[successor])
+                    lowlink[vertex] = std::min(lowlink[vertex], index[successor]);
+
+                continue;
+            }
+
+            callStack.pop_back();
+            if (!callStack.empty())
+            {
+                unsigned parent = callStack.back().first;
+                lowlink[parent] = std::min(lowlink[parent], lowlink[vertex]);
+            }
+
+            if (lowlink[vertex] != index[vertex])
+                continue;
+
+            found.push_back(std::vector<unsigned>());
+            unsigned top;
+            do
+            {
+                top = stack.back();
+                stack.pop_back();
+                onStack[top] = false;
+                found.back().push_back(top);
+            } while (top != vertex);
+        }
+    }
+
+    // Tarjan's algorithm finds the components in reverse topological
+    // order.
+    components.insert(components.end(), found.rbegin(), found.rend());
+}
+
+llvm::StringRef
+getStructBaseName(llvm::StringRef name)
+{
+    while (true)
+    {
+        size_t dot = name.rfind('.');
+        if (dot == llvm::StringRef::npos || dot + 1 == name.size())
+            return name;
+
+        llvm::StringRef suffix = name.substr(dot + 1);
+        if (suffix.find_first_not_of("0123456789") != llvm::StringRef::npos)
+            return name;
+
+        name = name.substr(0, dot);
+    }
+}
+
+size_t
+getHash(const llvm::APInt &value)
+{
+    size_t result = value.getBitWidth();
+    const uint64_t *words = value.getRawData();
+    for (unsigned i = 0; i < value.getNumWords(); ++i)
+        result = combineHash(result, words[i]);
+
+    return result;
+}
+
+/// Helper for getFingerprint().  One step of the FNV-1a hash.
+static void
+hashCombine(uint64_t &hash, uint64_t value)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        hash ^= (value >> (i * 8)) & 0xff;
+        hash *= 1099511628211ULL;
+    }
+}
+
+/// Helper for getFingerprint().
+static void
+hashString(uint64_t &hash, llvm::StringRef string)
+{
+    hashCombine(hash, string.size());
+    for (size_t i = 0; i < string.size(); ++i)
+    {
+        hash ^= (unsigned char)string[i];
+        hash *= 1099511628211ULL;
+    }
+}
+
+/// Helper for getFingerprint().  Identified structure types are
+/// hashed by their names, which also stops the recursion.
+static void
+hashType(uint64_t &hash, const llvm::Type &type, unsigned depth)
+{
+    hashCombine(hash, type.getTypeID());
+    if (depth > 16)
+        return;
+
+    if (const llvm::IntegerType *integerType =
+        llvm::dyn_cast<llvm::IntegerType>(&type))
+    {
+        hashCombine(hash, integerType->getBitWidth());
+    }
+
+    if (const llvm::ArrayType *arrayType =
+        llvm::dyn_cast<llvm::ArrayType>(&type))
+    {
+        hashCombine(hash, arrayType->getNumElements());
+    }
+
+    if (const llvm::VectorType *vectorType =
+        llvm::dyn_cast<llvm::VectorType>(&type))
+    {
+        hashCombine(hash, vectorType->getNumElements());
+    }
+
+#if LLVM_VERSION_MAJOR > 2
+    if (const llvm::StructType *structType =
+        llvm::dyn_cast<llvm::StructType>(&type))
+    {
+        if (structType->hasName())
+        {
+            hashString(hash, getStructBaseName(structType->getName()));
+            return;
+        }
+    }
+#endif
+
+    hashCombine(hash, type.getNumContainedTypes());
+    for (unsigned i = 0; i < type.getNumContainedTypes(); ++i)
+        hashType(hash, *type.getContainedType(i), depth + 1);
+}
+
+/// Helper for getFingerprint().
+static void
+hashValue(uint64_t &hash,
+          const llvm::Value &value,
+          const std::map<const llvm::Value*, unsigned> &positions)
+{
+    hashCombine(hash, value.getValueID());
+    std::map<const llvm::Value*, unsigned>::const_iterator it =
+        positions.find(&value);
+
+    if (it != positions.end())
+    {
+        hashCombine(hash, it->second);
+        return;
+    }
+
+    hashType(hash, *value.getType(), 0);
+    if (const llvm::GlobalValue *globalValue =
+        llvm::dyn_cast<llvm::GlobalValue>(&value))
+    {
+        hashString(hash, globalValue->getName());
+    }
+    else if (const llvm::ConstantInt *constantInt =
+             llvm::dyn_cast<llvm::ConstantInt>(&value))
+    {
+        hashString(hash, constantInt->getValue().toString(16, false));
+    }
+    else if (const llvm::ConstantFP *constantFP =
+             llvm::dyn_cast<llvm::ConstantFP>(&value))
+    {
+        llvm::APInt bits = constantFP->getValueAPF().bitcastToAPInt();
+        hashString(hash, bits.toString(16, false));
+    }
+    else if (const llvm::Constant *constant =
+             llvm::dyn_cast<llvm::Constant>(&value))
+    {
+        if (const llvm::ConstantExpr *constantExpr =
+            llvm::dyn_cast<llvm::ConstantExpr>(constant))
+        {
+            hashCombine(hash, constantExpr->getOpcode());
+            if (constantExpr->isCompare())
+                hashCombine(hash, constantExpr->getPredicate());
+        }
+
+        hashCombine(hash, constant->getNumOperands());
+        for (unsigned i = 0; i < constant->getNumOperands(); ++i)
+            hashValue(hash, *constant->getOperand(i), positions);
+    }
+}
+
+uint64_t
+getFingerprint(const llvm::Function &function)
+{
+    // Local values are identified by their position in the function.
+    std::map<const llvm::Value*, unsigned> positions;
+    llvm::Function::const_arg_iterator ait = function.arg_begin(),
+        aitend = function.arg_end();
+
+    for (; ait != aitend; ++ait)
+        positions.insert(std::make_pair(&*ait, positions.size()));
+
+    llvm::Function::const_iterator it = function.begin(),
+        itend = function.end();
+
+    for (; it != itend; ++it)
+    {
+        positions.insert(std::make_pair(&*it, positions.size()));
+        llvm::BasicBlock::const_iterator iit = it->begin(),
+            iitend = it->end();
+
+        for (; iit != iitend; ++iit)
+            positions.insert(std::make_pair(&*iit, positions.size()));
+    }
+
+    uint64_t hash = 14695981039346656037ULL;
+    hashType(hash, *function.getFunctionType(), 0);
+    for (it = function.begin(); it != itend; ++it)
+    {
+        hashCombine(hash, it->size());
+        llvm::BasicBlock::const_iterator iit = it->begin(),
+            iitend = it->end();
+
+        for (; iit != iitend; ++iit)
+        {
+            // Debug information changes with unrelated edits of the
+            // source file.
+            if (llvm::isa<llvm::DbgInfoIntrinsic>(*iit))
+                continue;
+
+            hashCombine(hash, iit->getOpcode());
+            hashType(hash, *iit->getType(), 0);
+            hashCombine(hash, iit->getNumOperands());
+            for (unsigned i = 0; i < iit->getNumOperands(); ++i)
+                hashValue(hash, *iit->getOperand(i), positions);
+
+            if (const llvm::CmpInst *cmp = llvm::dyn_cast<llvm::CmpInst>(&*iit))
+                hashCombine(hash, cmp->getPredicate());
+
+            if (const llvm::PHINode *phi = llvm::dyn_cast<llvm::PHINode>(&*iit))
+            {
+                for (unsigned i = 0; i < phi->getNumIncomingValues(); ++i)
+                    hashValue(hash, *phi->getIncomingBlock(i), positions);
+            }
+
+            if (const llvm::ExtractValueInst *extract =
+                llvm::dyn_cast<llvm::ExtractValueInst>(&*iit))
+            {
+                for (unsigned i = 0; i < extract->getNumIndices(); ++i)
+                    hashCombine(hash, extract->getIndices()[i]);
+            }
+
+            if (const llvm::InsertValueInst *insert =
+                llvm::dyn_cast<llvm::InsertValueInst>(&*iit))
+            {
+                for (unsigned i = 0; i < insert->getNumIndices(); ++i)
+                    hashCombine(hash, insert->getIndices()[i]);
+            }
+        }
+    }
+
+    return hash;
+}
+
+const llvm::Function *
+getCalledFunction(const llvm::Instruction &instruction)
+{
+    if (llvm::isa<llvm::CallInst>(instruction))
+        return checkedCast<llvm::CallInst>(instruction).getCalledFunction();
+
+    if (llvm::isa<llvm::InvokeInst>(instruction))
+        return checkedCast<llvm::InvokeInst>(instruction).getCalledFunction();
+
+    return NULL;
+}
+
 } // namespace Canal
@@ -5,6 +5,7 @@
 #include <cstdlib>
 #include <string>
 #include <typeinfo>
+#include <vector>
 
 /// Fatal error.  Writes a message to stderr and terminates the
 /// application.
@@ -117,6 +118,44 @@ std::string getName(const llvm::Value &value,
 
 std::string getCurrentBacktrace();
 
+/// Find strongly connected components of a directed graph.  Vertices
+/// are numbered from zero, and successors[v] lists the successors of
+/// the vertex v.  Only the listed vertices are considered, edges
+/// leading to other vertices are ignored.
+/// @param components
+///   Found components are appended in a topological order: when an
+///   edge leads from a component A to a component B, A precedes B.
+void findStronglyConnectedComponents(
+    const std::vector<std::vector<unsigned> > &successors,
+    const std::vector<unsigned> &vertices,
+    std::vector<std::vector<unsigned> > &components);
+
+/// Get the name of an identified structure type without the numeric
+/// suffix LLVM appends when a type of the same name already exists in
+/// the context, for example when a module is loaded again.
+llvm::StringRef getStructBaseName(llvm::StringRef name);
+
+/// Compute a structural hash of a function body.  The hash is equal
+/// for functions that are identical after the module is compiled and
+/// loaded again: global values are identified by their names, local
+/// values by their positions, and debug metadata are ignored.
+uint64_t getFingerprint(const llvm::Function &function);
+
+/// Get the function called by a call or invoke instruction.
+/// @returns
+///   NULL for other instructions and for indirect calls.
+const llvm::Function *getCalledFunction(const llvm::Instruction &instruction);
+
+/// Mix a value into a hash of an abstract value.
+inline size_t
+combineHash(size_t hash, size_t value)
+{
+    return hash ^ (value + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+}
+
+/// Compute a hash of an integer including its bit width.
+size_t getHash(const llvm::APInt &value);
+
 template <class X, class Y> inline typename llvm::cast_retty<X, Y>::ret_type
 checkedCast(const Y &val)
 {
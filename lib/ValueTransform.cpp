@@ -0,0 +1,50 @@
+#include "ValueTransform.h"
+#include "Domain.h"
+#include "InterningTable.h"
+
+namespace Canal {
+
+bool
+ValueTransform::apply(SharedDataPointer<Domain> &value)
+{
+    if (!value)
+        return false;
+
+    std::map<const Domain*, SharedDataPointer<Domain> >::const_iterator it =
+        mResults.find(value.data());
+
+    if (it == mResults.end())
+    {
+        mVisited.push_back(value);
+        SharedDataPointer<Domain> result(transform(*value));
+        if (result.data())
+            intern(result);
+        else
+            result = value;
+
+        it = mResults.insert(std::make_pair(value.data(), result)).first;
+    }
+
+    if (it->second == value)
+        return false;
+
+    value = it->second;
+    return true;
+}
+
+bool
+ValueTransform::apply(Domain *&value)
+{
+    if (!value)
+        return false;
+
+    Domain *result = transform(*value);
+    if (!result)
+        return false;
+
+    delete value;
+    value = result;
+    return true;
+}
+
+} // namespace Canal
@@ -0,0 +1,48 @@
+#ifndef LIBCANAL_VALUE_TRANSFORM_H
+#define LIBCANAL_VALUE_TRANSFORM_H
+
+#include "SharedDataPointer.h"
+#include <map>
+#include <vector>
+
+namespace Canal {
+
+/// Replaces the abstract values stored in states by their transformed
+/// copies.  A value shared by several states is transformed once, so
+/// the states keep sharing its copy.
+class ValueTransform
+{
+protected:
+    /// Transformed copies of the visited shared values.  Values not
+    /// changed by the transformation map to themselves.
+    std::map<const Domain*, SharedDataPointer<Domain> > mResults;
+
+    /// The visited shared values are kept alive until the
+    /// transformation ends, so their addresses are not reused by the
+    /// copies.
+    std::vector<SharedDataPointer<Domain> > mVisited;
+
+public:
+    virtual ~ValueTransform() {}
+
+    /// Replace a shared value by its transformed copy.
+    /// @returns
+    ///   True if the value has changed.
+    bool apply(SharedDataPointer<Domain> &value);
+
+    /// Replace a value owned by the caller by its transformed copy.
+    /// @returns
+    ///   True if the value has changed.
+    bool apply(Domain *&value);
+
+protected:
+    /// Get a transformed copy of a value.
+    /// @returns
+    ///   A newly allocated value, or NULL if the transformation does
+    ///   not change the value.
+    virtual Domain *transform(const Domain &value) const = 0;
+};
+
+} // namespace Canal
+
+#endif // LIBCANAL_VALUE_TRANSFORM_H
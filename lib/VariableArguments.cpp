@@ -1,6 +1,7 @@
 #include "VariableArguments.h"
 #include "Domain.h"
 #include "Utils.h"
+#include "ValueTransform.h"
 
 namespace Canal {
 
@@ -29,6 +30,21 @@ VariableArguments::~VariableArguments()
         llvm::DeleteContainerPointers(it->second);
 }
 
+void
+VariableArguments::assign(const VariableArguments &arguments)
+{
+    if (this == &arguments || (mCalls.empty() && arguments.mCalls.empty()))
+        return;
+
+    CallMap::iterator it = mCalls.begin();
+    for (; it != mCalls.end(); ++it)
+        llvm::DeleteContainerPointers(it->second);
+
+    mCalls = arguments.mCalls;
+    for (it = mCalls.begin(); it != mCalls.end(); ++it)
+        cloneDomains(it->second);
+}
+
 static bool
 equal(const std::vector<Domain*> &first, const std::vector<Domain*> &second)
 {
@@ -69,21 +85,33 @@ VariableArguments::operator==(const VariableArguments &arguments) const
     return true;
 }
 
-static void
+static bool
 mergeDomains(std::vector<Domain*> &first, const std::vector<Domain*> &second)
 {
     CANAL_ASSERT_MSG(first.size() == second.size(),
                      "Argument lists must have the same length.");
 
+    bool changed = false;
     std::vector<Domain*>::iterator it1 = first.begin();
     std::vector<Domain*>::const_iterator it2 = second.begin();
     for (; it1 != first.end(); ++it1, ++it2)
+    {
+        if (**it1 == **it2)
+            continue;
+
+        llvm::OwningPtr<Domain> original((*it1)->clone());
         (*it1)->join(**it2);
+        if (*original != **it1)
+            changed = true;
+    }
+
+    return changed;
 }
 
-void
+bool
 VariableArguments::merge(const VariableArguments &arguments)
 {
+    bool changed = false;
     // Merge all values.
     CallMap::const_iterator it2 = arguments.mCalls.begin(),
         it2end = arguments.mCalls.end();
@@ -97,10 +125,13 @@ VariableArguments::merge(const VariableArguments &arguments)
             cloneDomains(arguments);
             mCalls.insert(CallMap::value_type(it2->first,
                                               arguments));
+            changed = true;
         }
-	else
-            mergeDomains(it1->second, it2->second);
+	else if (mergeDomains(it1->second, it2->second))
+            changed = true;
     }
+
+    return changed;
 }
 
 void
@@ -119,4 +150,16 @@ VariableArguments::addArgument(const llvm::Instruction &place,
         it->second.push_back(argument);
 }
 
+void
+VariableArguments::transform(ValueTransform &transform)
+{
+    CallMap::iterator it = mCalls.begin(), itend = mCalls.end();
+    for (; it != itend; ++it)
+    {
+        std::vector<Domain*>::iterator ait = it->second.begin();
+        for (; ait != it->second.end(); ++ait)
+            transform.apply(*ait);
+    }
+}
+
 } // namespace Canal
@@ -11,10 +11,12 @@ class Domain;
 
 class VariableArguments
 {
+public:
     // llvm::Instruction represents the calling instruction providing
     // the variable arguments.
     typedef std::map<const llvm::Instruction*, std::vector<Domain*> > CallMap;
 
+protected:
     CallMap mCalls;
 
 public:
@@ -29,13 +31,26 @@ public:
 
     bool operator==(const VariableArguments &arguments) const;
 
+    /// Replace all arguments by a deep copy of other arguments.
+    void assign(const VariableArguments &arguments);
+
     /// Merges the arguments per every instruction.
-    void merge(const VariableArguments &arguments);
+    /// @returns
+    ///   True if the arguments have changed.
+    bool merge(const VariableArguments &arguments);
 
     /// Adds an argument at the end of the argument list for an
     /// instruction.
     void addArgument(const llvm::Instruction &place, Domain *argument);
 
+    /// Replace all arguments by their transformed copies.
+    void transform(ValueTransform &transform);
+
+    const CallMap &getCalls() const
+    {
+        return mCalls;
+    }
+
 private:
     /// Assignment operator declaration.  Prevents accidental
     /// assignments.  Do not implement!
@@ -14,7 +14,8 @@ class Interface
 public:
     enum InterfaceKind {
         NumericalInfinityKind,
-        PointersKind
+        PointersKind,
+        TopKind
     };
 
     const InterfaceKind mKind;
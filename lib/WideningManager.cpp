@@ -1,14 +1,7 @@
 #include "WideningManager.h"
 #include "WideningNumericalInfinity.h"
 #include "WideningPointers.h"
-#include "State.h"
-#include "StateMap.h"
 #include "Domain.h"
-#if 0 //Debug info for fixpoint calculation
-#include "Utils.h"
-#include "Environment.h"
-#include <iostream>
-#endif
 
 namespace Canal {
 namespace Widening {
@@ -19,58 +12,14 @@ Manager::Manager()
     mWidenings.push_back(new Pointers());
 }
 
-Manager::~Manager()
+Manager::Manager(Interface *widening)
 {
-    llvm::DeleteContainerPointers(mWidenings);
+    mWidenings.push_back(widening);
 }
 
-void
-Manager::widen(const llvm::BasicBlock &wideningPoint,
-               State &first,
-               const State &second) const
-{
-    widen(wideningPoint,
-          first.getFunctionVariables(),
-          second.getFunctionVariables());
-
-    widen(wideningPoint,
-          first.getFunctionBlocks(),
-          second.getFunctionBlocks());
-
-    widen(wideningPoint,
-          first.getGlobalVariables(),
-          second.getGlobalVariables());
-
-    widen(wideningPoint,
-          first.getGlobalBlocks(),
-          second.getGlobalBlocks());
-}
-
-void
-Manager::widen(const llvm::BasicBlock &wideningPoint,
-               StateMap &first,
-               const StateMap &second) const
+Manager::~Manager()
 {
-    StateMap::const_iterator it2 = second.begin(),
-        it2end = second.end();
-
-    for (; it2 != it2end; ++it2)
-    {
-	StateMap::iterator it1 = first.find(it2->first);
-	if (it1 != first.end() && *it1->second != *it2->second)
-        {
-#if 0 //Debug info for fixpoint calculation
-            std::cout << ((it1->second)->toString()) << "\n";
-            std::cout << Canal::getName(*it1->first,
-                                        it1->second->getEnvironment().getSlotTracker())
-                      << "\n";
-
-            std::cout << ((it2->second)->toString()) << "\n";
-#endif
-
-            widen(wideningPoint, *it1->second.mutable_(), *it2->second);
-        }
-    }
+    llvm::DeleteContainerPointers(mWidenings);
 }
 
 void
@@ -7,8 +7,6 @@
 namespace Canal {
 
 class Domain;
-class State;
-class StateMap;
 
 namespace Widening {
 
@@ -18,24 +16,45 @@ class Manager
 {
 public:
     Manager();
-    virtual ~Manager();
 
-    void widen(const llvm::BasicBlock &wideningPoint,
-               State &first,
-               const State &second) const;
+    /// Create a manager applying a single widening.
+    /// @param widening
+    ///   Manager takes ownership of the widening.
+    explicit Manager(Interface *widening);
 
-protected:
-    void widen(const llvm::BasicBlock &wideningPoint,
-               StateMap &first,
-               const StateMap &second) const;
+    virtual ~Manager();
 
     void widen(const llvm::BasicBlock &wideningPoint,
                Domain &first,
                const Domain &second) const;
 
+protected:
     std::vector<Interface*> mWidenings;
 };
 
+/// Widening point with the widening applied there.  It is passed to
+/// the merge functions of states, so the values are widened in
+/// place while the changed entries are merged.
+class Point
+{
+public:
+    const Manager &mManager;
+
+    const llvm::BasicBlock &mBasicBlock;
+
+public:
+    Point(const Manager &manager, const llvm::BasicBlock &basicBlock)
+        : mManager(manager), mBasicBlock(basicBlock)
+    {
+    }
+
+    /// Widen a value before another value is joined to it.
+    void widen(Domain &first, const Domain &second) const
+    {
+        mManager.widen(mBasicBlock, first, second);
+    }
+};
+
 } // namespace Widening
 } // namespace Canal
 
@@ -1,6 +1,11 @@
 #include "WideningNumericalInfinity.h"
 #include "WideningDataIterationCount.h"
+#include "ProductStatic.h"
 #include "ProductVector.h"
+#include "IntegerBitfield.h"
+#include "IntegerInterval.h"
+#include "IntegerSet.h"
+#include "IntegerUtils.h"
 #include "FloatInterval.h"
 #include "Utils.h"
 
@@ -15,8 +20,9 @@ NumericalInfinity::widen(const llvm::BasicBlock &wideningPoint,
     Product::Vector *firstContainer =
         dynCast<Product::Vector>(&first);
 
+    Integer::Combined *integer = dynCast<Integer::Combined>(&first);
     Float::Interval *f = dynCast<Float::Interval>(&first);
-    if (!firstContainer && !f)
+    if (!firstContainer && !integer && !f)
         return;
 
     DataInterface *data = first.getWideningData();
@@ -36,6 +42,7 @@ NumericalInfinity::widen(const llvm::BasicBlock &wideningPoint,
 
     // Widening.
     if (firstContainer) firstContainer->setTop();
+    else if (integer) integer->setTop();
     else f->setTop();
 }
 
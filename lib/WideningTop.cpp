@@ -0,0 +1,16 @@
+#include "WideningTop.h"
+#include "Domain.h"
+
+namespace Canal {
+namespace Widening {
+
+void
+Top::widen(const llvm::BasicBlock &wideningPoint,
+           Domain &first,
+           const Domain &second)
+{
+    first.setTop();
+}
+
+} // namespace Widening
+} // namespace Canal
@@ -0,0 +1,32 @@
+#ifndef LIBCANAL_WIDENING_TOP_H
+#define LIBCANAL_WIDENING_TOP_H
+
+#include "WideningInterface.h"
+
+namespace Canal {
+namespace Widening {
+
+/// Sets every value that has changed to top.  Used when the
+/// interpretation runs out of its budget, so a fixpoint is reached
+/// after a single change of each value.
+class Top : public Interface
+{
+public:
+    Top() : Interface(Interface::TopKind)
+    {
+    }
+
+    virtual void widen(const llvm::BasicBlock &wideningPoint,
+                       Domain &first,
+                       const Domain &second);
+
+    static bool classof(const Interface *value)
+    {
+        return value->getKind() == TopKind;
+    }
+};
+
+} // namespace Widening
+} // namespace Canal
+
+#endif // LIBCANAL_WIDENING_TOP_H
@@ -1,5 +1,10 @@
 #include "lib/ArrayExactSize.h"
+#include "lib/ArraySingleItem.h"
+#include "lib/ArrayUtils.h"
+#include "lib/Constructors.h"
 #include "lib/IntegerInterval.h"
+#include "lib/IntegerUtils.h"
+#include "lib/ProductVector.h"
 #include "lib/Utils.h"
 #include "lib/Environment.h"
 #include "lib/Interpreter.h"
@@ -22,6 +27,34 @@ testConstructors()
     CANAL_ASSERT(array == array);
 }
 
+static void
+testCollapse()
+{
+    const Environment &environment = gInterpreter->getEnvironment();
+    const Constructors &constructors = environment.getConstructors();
+    const llvm::ArrayType &typeI2 = *llvm::ArrayType::get(
+        llvm::Type::getInt32Ty(environment.getContext()), 2);
+
+    std::vector<Domain*> values;
+    values.push_back(constructors.createInteger(llvm::APInt(32, 1)));
+    values.push_back(constructors.createInteger(llvm::APInt(32, 2)));
+    llvm::OwningPtr<Domain> array(constructors.createArray(typeI2, values));
+
+    llvm::OwningPtr<Domain> collapsed(Array::Utils::collapseExactSize(*array));
+    CANAL_ASSERT(collapsed);
+    CANAL_ASSERT(!Array::Utils::collapseExactSize(*collapsed));
+
+    // The exact-size domain is replaced by a single item holding
+    // the join of the items.
+    const Product::Vector &vector = checkedCast<Product::Vector>(*collapsed);
+    const Array::SingleItem &item =
+        checkedCast<Array::SingleItem>(*vector.mValues[0]);
+
+    llvm::APInt min, max;
+    CANAL_ASSERT(Integer::Utils::unsignedMin(*item.mValue, min) && min == 1);
+    CANAL_ASSERT(Integer::Utils::unsignedMax(*item.mValue, max) && max == 2);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -31,6 +64,7 @@ main(int argc, char **argv)
     gInterpreter = new Interpreter::Interpreter(module);
 
     testConstructors();
+    testCollapse();
 
     delete gInterpreter;
     return 0;
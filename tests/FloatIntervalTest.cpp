@@ -1,4 +1,5 @@
 #include "lib/FloatInterval.h"
+#include "lib/FloatUtils.h"
 #include "lib/Utils.h"
 #include "lib/Environment.h"
 #include <llvm/Module.h>
@@ -69,6 +70,17 @@ testComparison()
 
     CANAL_ASSERT(bot != zero);
     CANAL_ASSERT(zero != bot);
+
+    // Positive and negative zero are equal, so their hashes must be
+    // equal too.
+    Float::Interval negativeZero(*gEnvironment, llvm::APFloat(-0.0f));
+    CANAL_ASSERT(zero == negativeZero);
+    CANAL_ASSERT(zero.hash() == negativeZero.hash());
+
+    Float::Interval topToo(zero);
+    topToo.setTop();
+    CANAL_ASSERT(top == topToo);
+    CANAL_ASSERT(top.hash() == topToo.hash());
 }
 
 static void
@@ -80,11 +92,13 @@ testDivisionByZero()
             one_two(one),
             zero_one(zero),
             minusone_zero(*gEnvironment, llvm::APFloat(-1.0f)),
+            minusone_one(minusone_zero),
             result(zero);
 
     one_two.join(two);
     zero_one.join(one);
     minusone_zero.join(zero);
+    minusone_one.join(one);
 
     //Fdiv test
     CANAL_ASSERT(result.fdiv(one, zero).isTop());
@@ -100,6 +114,72 @@ testDivisionByZero()
     CANAL_ASSERT(result.getMinMax(min, max));
     CANAL_ASSERT(min.isInfinity() && min.isNegative()); //Negative infinity minus one
     CANAL_ASSERT(max.compare(llvm::APFloat(-1.0f)) == llvm::APFloat::cmpEqual); //Unsigned zero to two
+
+    // The divisor crosses zero, so the quotient is unbounded.
+    CANAL_ASSERT(result.fdiv(one_two, minusone_one).isTop());
+}
+
+static bool
+contains(const Float::Interval &interval, const llvm::APFloat &value)
+{
+    llvm::APFloat min(value), max(value);
+    if (!interval.getMinMax(min, max))
+        return false;
+
+    return min.compare(value) != llvm::APFloat::cmpGreaterThan &&
+        max.compare(value) != llvm::APFloat::cmpLessThan;
+}
+
+static void
+testArithmetic()
+{
+    Float::Interval one(*gEnvironment, llvm::APFloat(1.0)),
+            two(*gEnvironment, llvm::APFloat(2.0)),
+            tenth(*gEnvironment, llvm::APFloat(0.1)),
+            fifth(*gEnvironment, llvm::APFloat(0.2)),
+            result(one);
+
+    // Exact results remain constants.
+    result.fadd(one, two);
+    CANAL_ASSERT(result == Float::Interval(*gEnvironment, llvm::APFloat(3.0)));
+    result.fsub(one, two);
+    CANAL_ASSERT(result == Float::Interval(*gEnvironment, llvm::APFloat(-1.0)));
+    result.fmul(two, two);
+    CANAL_ASSERT(result == Float::Interval(*gEnvironment, llvm::APFloat(4.0)));
+    result.fdiv(one, two);
+    CANAL_ASSERT(result == Float::Interval(*gEnvironment, llvm::APFloat(0.5)));
+
+    // Inexact results are enclosed by their neighbouring values.
+    // Without the native arithmetic, they might be top.
+    bool native = Float::Utils::isNative(one.getSemantics());
+    result.fadd(tenth, fifth);
+    CANAL_ASSERT(!native || !result.isTop());
+    CANAL_ASSERT(contains(result, llvm::APFloat(0.1 + 0.2)));
+    result.fdiv(one, Float::Interval(*gEnvironment, llvm::APFloat(3.0)));
+    CANAL_ASSERT(!native || !result.isTop());
+    CANAL_ASSERT(contains(result, llvm::APFloat(1.0 / 3.0)));
+
+    Float::Interval tenthSingle(*gEnvironment, llvm::APFloat(0.1f)),
+            oneSingle(*gEnvironment, llvm::APFloat(1.0f)),
+            resultSingle(oneSingle);
+
+    resultSingle.fmul(tenthSingle, tenthSingle);
+    CANAL_ASSERT(!native || !resultSingle.isTop());
+    CANAL_ASSERT(&resultSingle.getSemantics() == &llvm::APFloat::IEEEsingle);
+    CANAL_ASSERT(contains(resultSingle, llvm::APFloat(0.1f * 0.1f)));
+
+    // Subtraction pairs the lower bound with the upper bound.
+    Float::Interval one_two(one);
+    one_two.join(two);
+    result.fsub(one_two, one_two);
+    CANAL_ASSERT(contains(result, llvm::APFloat(-1.0)));
+    CANAL_ASSERT(contains(result, llvm::APFloat(1.0)));
+
+    // Overflow leads to top.
+    Float::Interval largest(*gEnvironment,
+                            llvm::APFloat::getLargest(one.getSemantics()));
+    CANAL_ASSERT(result.fadd(largest, largest).isTop());
+    CANAL_ASSERT(result.fmul(largest, two).isTop());
 }
 
 int
@@ -115,6 +195,7 @@ main(int argc, char **argv)
     testComparison();
     testJoin();
     testDivisionByZero();
+    testArithmetic();
 
     delete gEnvironment;
     return 0;
@@ -732,6 +732,54 @@ testAshr () {
     }
 }
 
+static void
+testBitOperations(unsigned bitWidth)
+{
+    Integer::Bitfield a(*gEnvironment, llvm::APInt(bitWidth, 12)), //1100
+        b(*gEnvironment, llvm::APInt(bitWidth, 10)), //1010
+        result(*gEnvironment, bitWidth),
+        top(*gEnvironment, bitWidth),
+        boolean(*gEnvironment, 1);
+
+    llvm::APInt res;
+    top.setTop();
+    b.join(Integer::Bitfield(*gEnvironment, llvm::APInt(bitWidth, 8))); //10T0
+
+    result.and_(a, b); //1000
+    CANAL_ASSERT(result.isConstant());
+    CANAL_ASSERT(result.unsignedMin(res) && res == 8);
+
+    result.or_(a, b); //11T0
+    CANAL_ASSERT(result.unsignedMin(res) && res == 12 && result.unsignedMax(res) && res == 14);
+
+    result.xor_(a, b); //01T0
+    CANAL_ASSERT(result.unsignedMin(res) && res == 4 && result.unsignedMax(res) && res == 6);
+
+    result.xor_(a, a); //0000
+    CANAL_ASSERT(result.isConstant());
+    CANAL_ASSERT(result.unsignedMin(res) && res == 0);
+
+    // Known bits win over the top ones in and/or.
+    result.and_(Integer::Bitfield(*gEnvironment, llvm::APInt(bitWidth, 0)), top);
+    CANAL_ASSERT(result.isConstant());
+
+    result.or_(Integer::Bitfield(*gEnvironment, llvm::APInt::getAllOnesValue(bitWidth)), top);
+    CANAL_ASSERT(result.isConstant());
+
+    result.xor_(a, top);
+    CANAL_ASSERT(result.isTop());
+    CANAL_ASSERT(result.accuracy() == 0);
+
+    boolean.icmp(a, b, llvm::CmpInst::ICMP_EQ); //1100 and 10T0 differ
+    CANAL_ASSERT(boolean.isFalse());
+    boolean.icmp(a, b, llvm::CmpInst::ICMP_UGT); //1100 > 10T0
+    CANAL_ASSERT(boolean.isTrue());
+    boolean.icmp(b, a, llvm::CmpInst::ICMP_ULT);
+    CANAL_ASSERT(boolean.isTrue());
+    boolean.icmp(a, a, llvm::CmpInst::ICMP_UGE);
+    CANAL_ASSERT(boolean.isTrue());
+}
+
 static void
 testIntervalConversion () {
     Integer::Interval zero(*gEnvironment, llvm::APInt(32, 0)),
@@ -975,6 +1023,9 @@ main(int argc, char **argv)
     testShl();
     testLshr();
     testAshr();
+    testBitOperations(8);
+    testBitOperations(64);
+    testBitOperations(128);
 
     testIntervalConversion();
 
@@ -32,6 +32,20 @@ testEquality()
     // Test empty intervals.
     CANAL_ASSERT(interval1 == interval2);
     CANAL_ASSERT(interval1 != interval3);
+    CANAL_ASSERT(interval1.hash() == interval2.hash());
+
+    // Equal intervals have equal hashes.
+    Integer::Interval five(*gEnvironment, llvm::APInt(32, 5));
+    Integer::Interval fiveToo(*gEnvironment, llvm::APInt(32, 5));
+    CANAL_ASSERT(five == fiveToo);
+    CANAL_ASSERT(five.hash() == fiveToo.hash());
+
+    Integer::Interval top(*gEnvironment, 32);
+    top.setTop();
+    Integer::Interval topToo(five);
+    topToo.setTop();
+    CANAL_ASSERT(top == topToo);
+    CANAL_ASSERT(top.hash() == topToo.hash());
 }
 
 static void
@@ -785,6 +799,41 @@ testAdd()
     CANAL_ASSERT(result.add(bottom, bottom).isBottom());
 }
 
+static void
+testOverflow(unsigned bitWidth)
+{
+    Integer::Interval one(*gEnvironment, llvm::APInt(bitWidth, 1)),
+        two(*gEnvironment, llvm::APInt(bitWidth, 2)),
+        signedMax(*gEnvironment, llvm::APInt::getSignedMaxValue(bitWidth)),
+        unsignedMax(*gEnvironment, llvm::APInt::getMaxValue(bitWidth)),
+        zero(*gEnvironment, llvm::APInt(bitWidth, 0)),
+        result(zero);
+
+    llvm::APInt res;
+
+    result.add(signedMax, one); //Signed overflow only
+    CANAL_ASSERT(result.isSignedTop() && !result.isUnsignedTop());
+    CANAL_ASSERT(result.unsignedMin(res) && res == llvm::APInt::getSignedMinValue(bitWidth));
+
+    result.add(unsignedMax, one); //-1 + 1 = 0, unsigned overflow only
+    CANAL_ASSERT(!result.isSignedTop() && result.isUnsignedTop());
+    CANAL_ASSERT(result.signedMin(res) && res == 0 && result.signedMax(res) && res == 0);
+
+    result.sub(zero, one); //0 - 1 = -1, unsigned overflow only
+    CANAL_ASSERT(!result.isSignedTop() && result.isUnsignedTop());
+    CANAL_ASSERT(result.signedMin(res) && res.isAllOnesValue());
+
+    result.sub(zero, Integer::Interval(*gEnvironment, llvm::APInt::getSignedMinValue(bitWidth)));
+    CANAL_ASSERT(result.isSignedTop());
+
+    result.mul(signedMax, two); //Signed overflow only
+    CANAL_ASSERT(result.isSignedTop() && !result.isUnsignedTop());
+    CANAL_ASSERT(result.unsignedMin(res) && res == llvm::APInt::getMaxValue(bitWidth) - 1);
+
+    result.mul(unsignedMax, two);
+    CANAL_ASSERT(result.isUnsignedTop());
+}
+
 static void
 testDivisionByZero() {
     Integer::Interval zero(*gEnvironment, llvm::APInt(32, 0)),
@@ -1180,6 +1229,9 @@ main(int argc, char **argv)
     testFPConversions();
 
     testAdd();
+    testOverflow(8);
+    testOverflow(64);
+    testOverflow(128);
     testDivisionByZero();
     testRemainder();
 
@@ -633,6 +633,117 @@ testAdd()
     CANAL_ASSERT(result.add(bottom, bottom).isBottom());
 }
 
+static void
+testThreshold()
+{
+    unsigned threshold = Integer::Set::SET_THRESHOLD;
+    Integer::Set::SET_THRESHOLD = 4;
+
+    Integer::Set small(*gEnvironment, llvm::APInt(8, 0)),
+        other(*gEnvironment, llvm::APInt(8, 0)),
+        result(*gEnvironment, 8);
+
+    llvm::APInt res;
+    for (unsigned i = 4; i < 16; i += 4)
+        small.join(Integer::Set(*gEnvironment, llvm::APInt(8, i))); //0, 4, 8, 12
+
+    CANAL_ASSERT(small.mValues.size() == 4);
+
+    // Sixteen sums, but only seven distinct values.
+    result.add(small, small);
+    CANAL_ASSERT(result.isTop());
+
+    // Sixteen products of and, four distinct values.
+    result.and_(small, small);
+    CANAL_ASSERT(!result.isTop() && result.mValues.size() == 4);
+    CANAL_ASSERT(result.unsignedMin(res) && res == 0 && result.unsignedMax(res) && res == 12);
+
+    // Truncation creates duplicates.
+    Integer::Set wide(*gEnvironment, llvm::APInt(16, 256)),
+        truncated(*gEnvironment, 8);
+
+    wide.join(Integer::Set(*gEnvironment, llvm::APInt(16, 0)));
+    truncated.trunc(wide);
+    CANAL_ASSERT(truncated.isConstant());
+
+    other.join(Integer::Set(*gEnvironment, llvm::APInt(8, 4)));
+    other.join(Integer::Set(*gEnvironment, llvm::APInt(8, 255)));
+    CANAL_ASSERT(other < Integer::Set(other).join(small));
+    CANAL_ASSERT(!(other < small));
+
+    Integer::Set met(small);
+    met.meet(other); //0, 4
+    CANAL_ASSERT(met.mValues.size() == 2);
+    CANAL_ASSERT(met.unsignedMin(res) && res == 0 && met.unsignedMax(res) && res == 4);
+
+    Integer::Set::SET_THRESHOLD = threshold;
+}
+
+static void
+testRanges()
+{
+    Integer::Interval interval(*gEnvironment, llvm::APInt(32, 0));
+    interval.join(Integer::Interval(*gEnvironment, llvm::APInt(32, 1000)));
+
+    Integer::Set range(*gEnvironment, 32),
+        result(*gEnvironment, 32),
+        minusten(*gEnvironment, llvm::APInt(32, -10, true)),
+        hundred(*gEnvironment, llvm::APInt(32, 100));
+
+    llvm::APInt res;
+    range.fromInterval(interval); //0-1000
+    CANAL_ASSERT(range.mValues.rangeCount() == 1);
+
+    result.add(range, range); //0-2000
+    CANAL_ASSERT(result.mValues.rangeCount() == 1 && result.mValues.size() == 2001);
+    CANAL_ASSERT(result.unsignedMin(res) && res == 0 && result.unsignedMax(res) && res == 2000);
+
+    result.add(range, minusten); //-10-990
+    CANAL_ASSERT(result.mValues.rangeCount() == 2 && result.mValues.size() == 1001);
+    CANAL_ASSERT(result.signedMin(res) && res == llvm::APInt(32, -10, true) &&
+                 result.signedMax(res) && res == 990);
+
+    result.sub(range, hundred); //-100-900
+    CANAL_ASSERT(result.signedMin(res) && res == llvm::APInt(32, -100, true) &&
+                 result.signedMax(res) && res == 900);
+
+    // Joining adjacent ranges keeps a single range.
+    Integer::Set upper(*gEnvironment, 32);
+    upper.add(range, Integer::Set(*gEnvironment, llvm::APInt(32, 1001))); //1001-2001
+    CANAL_ASSERT(Integer::Set(range).join(upper).mValues.rangeCount() == 1);
+
+    // Inclusion and intersection work on ranges.
+    CANAL_ASSERT(hundred < range);
+    CANAL_ASSERT(!(range < hundred));
+    CANAL_ASSERT(Integer::Set(range).meet(upper).isBottom());
+    CANAL_ASSERT(Integer::Set(range).meet(hundred) == hundred);
+
+    // Values are iterated in unsigned order across ranges.
+    Integer::Set twoRanges(*gEnvironment, 32);
+    twoRanges.fromInterval(Integer::Interval(*gEnvironment, llvm::APInt(32, -2, true)).join(
+                               Integer::Interval(*gEnvironment, llvm::APInt(32, 1))));
+
+    Integer::Utils::USet::const_iterator it = twoRanges.mValues.begin();
+    CANAL_ASSERT(*it == 0 && *++it == 1 && *++it == llvm::APInt(32, -2, true));
+    CANAL_ASSERT(*++it == llvm::APInt(32, -1, true) && ++it == twoRanges.mValues.end());
+
+    // Comparison of ranges without a common value.
+    Integer::Set boolean(*gEnvironment, 1);
+    boolean.icmp(range, upper, llvm::CmpInst::ICMP_EQ);
+    CANAL_ASSERT(boolean.isFalse());
+    boolean.icmp(range, upper, llvm::CmpInst::ICMP_ULT);
+    CANAL_ASSERT(boolean.isTrue());
+
+    // Truncation of a range longer than the target type.
+    Integer::Set byte(*gEnvironment, 8);
+    CANAL_ASSERT(byte.trunc(range).isTop());
+
+    Integer::Set wide(*gEnvironment, 64);
+    wide.sext(twoRanges);
+    CANAL_ASSERT(wide.signedMin(res) && res == llvm::APInt(64, -2, true) &&
+                 wide.signedMax(res) && res == 1);
+}
+
 static void
 testIntervalConversion () {
     Integer::Interval zero(*gEnvironment, llvm::APInt(32, 0)),
@@ -708,7 +819,10 @@ testIntervalConversion () {
                  result.signedMin(res) && res == llvm::APInt(32, -2, true) &&
                  result.signedMax(res) && res == llvm::APInt(32, 2));
 
-    CANAL_ASSERT(result.fromInterval(zero_thousand).isTop()); //Too many values
+    result.fromInterval(zero_thousand); //Single range
+    CANAL_ASSERT(!result.isTop() && result.mValues.size() == 1001);
+    CANAL_ASSERT(result.unsignedMin(res) && res == llvm::APInt(32, 0) &&
+                 result.unsignedMax(res) && res == llvm::APInt(32, 1000));
 
     result.fromInterval(signedOverflow); //Signed overflow, but not unsigned
     CANAL_ASSERT(result.unsignedMin(res) && res == llvm::APInt(32, 2147483647) &&
@@ -873,6 +987,8 @@ main(int argc, char **argv)
     testDivisionByZero();
 
     testAdd();
+    testThreshold();
+    testRanges();
 
     testIntervalConversion();
     testFPConversions();
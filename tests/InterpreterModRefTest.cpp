@@ -0,0 +1,146 @@
+#include "lib/Interpreter.h"
+#include "lib/InterpreterModRef.h"
+#include "lib/Utils.h"
+#include <llvm/Module.h>
+#include <llvm/LLVMContext.h>
+#include <llvm/Support/ManagedStatic.h>
+
+using namespace Canal;
+
+static llvm::GlobalVariable *
+createGlobal(llvm::Module &module, const char *name)
+{
+    llvm::Type *type = llvm::Type::getInt32Ty(module.getContext());
+    return new llvm::GlobalVariable(module,
+                                    type,
+                                    false,
+                                    llvm::GlobalValue::InternalLinkage,
+                                    llvm::ConstantInt::get(type, 0),
+                                    name);
+}
+
+static llvm::Function *
+createFunction(llvm::Module &module, const char *name)
+{
+    llvm::FunctionType *type = llvm::FunctionType::get(
+        llvm::Type::getVoidTy(module.getContext()), false);
+
+    return llvm::Function::Create(type,
+                                  llvm::GlobalValue::ExternalLinkage,
+                                  name,
+                                  &module);
+}
+
+static llvm::BasicBlock *
+createBlock(llvm::Function &function)
+{
+    return llvm::BasicBlock::Create(function.getContext(), "entry", &function);
+}
+
+static void
+testSummaries()
+{
+    llvm::Module *module = new llvm::Module("testModule",
+                                            llvm::getGlobalContext());
+
+    llvm::GlobalVariable *read = createGlobal(*module, "read"),
+        *written = createGlobal(*module, "written"),
+        *recursive = createGlobal(*module, "recursive"),
+        *escaping = createGlobal(*module, "escaping");
+
+    // The address of the escaping global is stored in another global,
+    // so it might be accessed through a pointer anywhere.
+    new llvm::GlobalVariable(*module,
+                             escaping->getType(),
+                             false,
+                             llvm::GlobalValue::InternalLinkage,
+                             escaping,
+                             "pointer");
+
+    llvm::Function *declaration = createFunction(*module, "declaration");
+
+    llvm::Function *reader = createFunction(*module, "reader");
+    llvm::BasicBlock *block = createBlock(*reader);
+    new llvm::LoadInst(read, "", block);
+    llvm::ReturnInst::Create(module->getContext(), block);
+
+    llvm::Function *writer = createFunction(*module, "writer");
+    block = createBlock(*writer);
+    new llvm::StoreInst(llvm::ConstantInt::get(written->getType()->getElementType(), 1),
+                        written,
+                        block);
+
+    llvm::ReturnInst::Create(module->getContext(), block);
+
+    llvm::Function *caller = createFunction(*module, "caller");
+    block = createBlock(*caller);
+    llvm::CallInst::Create(writer, "", block);
+    llvm::ReturnInst::Create(module->getContext(), block);
+
+    // Two functions calling each other form a component of the call
+    // graph, so they share the summary.
+    llvm::Function *first = createFunction(*module, "first"),
+        *second = createFunction(*module, "second");
+
+    block = createBlock(*first);
+    new llvm::StoreInst(llvm::ConstantInt::get(recursive->getType()->getElementType(), 1),
+                        recursive,
+                        block);
+
+    llvm::CallInst::Create(second, "", block);
+    llvm::ReturnInst::Create(module->getContext(), block);
+
+    block = createBlock(*second);
+    llvm::CallInst::Create(first, "", block);
+    llvm::ReturnInst::Create(module->getContext(), block);
+
+    Interpreter::ModRef::ENABLED = true;
+    Interpreter::Interpreter interpreter(module);
+    Interpreter::ModRef::ENABLED = false;
+
+    const Interpreter::ModRef &modRef = interpreter.getModule().getModRef();
+    CANAL_ASSERT(!modRef.getSummary(*declaration));
+
+    // Loads reference the global, but do not modify it.  Escaping
+    // globals are referenced and modified by every function.
+    const Interpreter::ModRef::Summary *summary = modRef.getSummary(*reader);
+    CANAL_ASSERT(summary);
+    CANAL_ASSERT(summary->mReferences.mGlobalBlocks.count(read));
+    CANAL_ASSERT(!summary->mModifications.mGlobalBlocks.count(read));
+    CANAL_ASSERT(!summary->mReferences.mGlobalBlocks.count(written));
+    CANAL_ASSERT(summary->mReferences.mGlobalBlocks.count(escaping));
+    CANAL_ASSERT(summary->mModifications.mGlobalBlocks.count(escaping));
+
+    summary = modRef.getSummary(*writer);
+    CANAL_ASSERT(summary);
+    CANAL_ASSERT(summary->mReferences.mGlobalBlocks.count(written));
+    CANAL_ASSERT(summary->mModifications.mGlobalBlocks.count(written));
+    CANAL_ASSERT(!summary->mReferences.mGlobalBlocks.count(read));
+
+    // The accesses of callees are included.
+    summary = modRef.getSummary(*caller);
+    CANAL_ASSERT(summary);
+    CANAL_ASSERT(summary->mModifications.mGlobalBlocks.count(written));
+    CANAL_ASSERT(!summary->mReferences.mGlobalBlocks.count(read));
+    CANAL_ASSERT(!summary->mReferences.mGlobalBlocks.count(recursive));
+
+    const Interpreter::ModRef::Summary *firstSummary = modRef.getSummary(*first),
+        *secondSummary = modRef.getSummary(*second);
+
+    CANAL_ASSERT(firstSummary && secondSummary);
+    CANAL_ASSERT(secondSummary->mModifications.mGlobalBlocks.count(recursive));
+    CANAL_ASSERT(firstSummary->mModifications.mGlobalBlocks ==
+                 secondSummary->mModifications.mGlobalBlocks);
+
+    CANAL_ASSERT(!firstSummary->mReferences.mGlobalBlocks.count(written));
+}
+
+int
+main(int argc, char **argv)
+{
+    llvm::llvm_shutdown_obj y;  // Call llvm_shutdown() on exit.
+
+    testSummaries();
+
+    return 0;
+}
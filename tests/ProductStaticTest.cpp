@@ -0,0 +1,107 @@
+#include "lib/ProductStatic.h"
+#include "lib/IntegerBitfield.h"
+#include "lib/IntegerSet.h"
+#include "lib/IntegerInterval.h"
+#include "lib/IntegerUtils.h"
+#include "lib/Constructors.h"
+#include "lib/Utils.h"
+#include "lib/Environment.h"
+#include <llvm/Module.h>
+#include <llvm/LLVMContext.h>
+#include <llvm/Support/ManagedStatic.h>
+
+using namespace Canal;
+
+static Environment *gEnvironment;
+
+static void
+testConstructors()
+{
+    Integer::Combined empty(*gEnvironment, 8);
+    CANAL_ASSERT(empty.isBottom());
+    CANAL_ASSERT(Integer::Utils::getBitWidth(empty) == 8);
+
+    Integer::Combined five(*gEnvironment, llvm::APInt(8, 5));
+    CANAL_ASSERT(!five.isBottom() && !five.isTop());
+    CANAL_ASSERT(Integer::Utils::isConstant(five));
+
+    // Components are accessed directly.
+    CANAL_ASSERT(&Integer::Utils::getBitfield(five) == &five.mFirst);
+    CANAL_ASSERT(&Integer::Utils::getSet(five) == &five.mSecond);
+    CANAL_ASSERT(&Integer::Utils::getInterval(five) == &five.mThird);
+
+    // Constructors create the static product for integers.
+    Domain *created = gEnvironment->getConstructors().createInteger(
+        llvm::APInt(8, 5));
+
+    CANAL_ASSERT(llvm::isa<Integer::Combined>(created));
+    CANAL_ASSERT(*created == five);
+    CANAL_ASSERT(created->hash() == five.hash());
+    delete created;
+}
+
+static void
+testCopy()
+{
+    Integer::Combined five(*gEnvironment, llvm::APInt(8, 5));
+    Integer::Combined *copy = five.clone();
+    CANAL_ASSERT(*copy == five);
+
+    // The copy is independent of the original.
+    copy->setTop();
+    CANAL_ASSERT(copy->isTop());
+    CANAL_ASSERT(!five.isTop());
+    CANAL_ASSERT(*copy != five);
+    delete copy;
+}
+
+static void
+testOperations()
+{
+    Integer::Combined two(*gEnvironment, llvm::APInt(8, 2)),
+        three(*gEnvironment, llvm::APInt(8, 3)),
+        result(*gEnvironment, 8);
+
+    result.add(two, three);
+    CANAL_ASSERT(result == Integer::Combined(*gEnvironment, llvm::APInt(8, 5)));
+
+    result.mul(two, three);
+    CANAL_ASSERT(result == Integer::Combined(*gEnvironment, llvm::APInt(8, 6)));
+
+    Integer::Combined two_three(two);
+    two_three.join(three);
+    CANAL_ASSERT(!Integer::Utils::isConstant(two_three));
+
+    llvm::APInt min, max;
+    CANAL_ASSERT(Integer::Utils::unsignedMin(two_three, min) && min == 2);
+    CANAL_ASSERT(Integer::Utils::unsignedMax(two_three, max) && max == 3);
+
+    Integer::Combined boolean(*gEnvironment, 1);
+    boolean.icmp(two, three, llvm::CmpInst::ICMP_ULT);
+    CANAL_ASSERT(boolean == Integer::Combined(*gEnvironment, llvm::APInt(1, 1)));
+
+    Integer::Combined unknown(*gEnvironment, 1);
+    unknown.icmp(two_three, three, llvm::CmpInst::ICMP_ULT);
+    CANAL_ASSERT(!unknown.isBottom() && !Integer::Utils::isConstant(unknown));
+
+    Integer::Combined wide(*gEnvironment, 8);
+    wide.zext(unknown);
+    CANAL_ASSERT(Integer::Utils::unsignedMax(wide, max) && max == 1);
+}
+
+int
+main(int argc, char **argv)
+{
+    llvm::LLVMContext &context = llvm::getGlobalContext();
+    llvm::llvm_shutdown_obj y;  // Call llvm_shutdown() on exit.
+
+    llvm::Module *module = new llvm::Module("testModule", context);
+    gEnvironment = new Environment(module);
+
+    testConstructors();
+    testCopy();
+    testOperations();
+
+    delete gEnvironment;
+    return 0;
+}
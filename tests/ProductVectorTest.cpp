@@ -51,6 +51,7 @@ public:
     virtual Domain& join(const Domain& value) { return *this; }
     virtual Domain& meet(const Domain& value) { return *this; }
     virtual size_t memoryUsage() const { return 0; }
+    virtual size_t hash() const { return 0; }
     virtual bool operator<(const Domain& value) const { return false; }
     virtual bool operator==(const Domain& value) const { return false; }
     virtual void setZero(const llvm::Value* place) {}
@@ -0,0 +1,269 @@
+#include "lib/StateMap.h"
+#include "lib/Constructors.h"
+#include "lib/Utils.h"
+#include "lib/Environment.h"
+#include <llvm/Module.h>
+#include <llvm/LLVMContext.h>
+#include <llvm/Support/ManagedStatic.h>
+#include <algorithm>
+#include <set>
+
+using namespace Canal;
+
+static Environment *gEnvironment;
+
+/// Gives the tests access to the trie.
+class TestStateMap : public StateMap
+{
+public:
+    const Node *getRoot() const
+    {
+        return mRoot.data();
+    }
+};
+
+/// Get a fake place with the requested hash.  Places are compared by
+/// their addresses only, so they are never dereferenced.  The hash of
+/// a pointer ignores its low four bits, so places with a different
+/// offset collide.
+static const llvm::Value *
+getPlace(unsigned hash, unsigned offset = 0)
+{
+    // Invert hash = (address >> 4) ^ (address >> 9).
+    uint64_t shifted = hash;
+    for (unsigned shift = 5; shift < 32; shift += 5)
+        shifted ^= hash >> shift;
+
+    const llvm::Value *place = reinterpret_cast<const llvm::Value*>(
+        (uintptr_t)((shifted << 4) | offset));
+
+    CANAL_ASSERT(llvm::DenseMapInfo<const llvm::Value*>::getHashValue(place) == hash);
+    return place;
+}
+
+static StateMap::value_type
+createEntry(const llvm::Value *place, unsigned number)
+{
+    Domain *value = gEnvironment->getConstructors().createInteger(
+        llvm::APInt(32, number));
+
+    return StateMap::value_type(place, SharedDataPointer<Domain>(value));
+}
+
+static unsigned
+getDepth(const StateMap::Node &node)
+{
+    unsigned depth = 0;
+    for (size_t i = 0; i < node.mChildren.size(); ++i)
+        depth = std::max(depth, getDepth(*node.mChildren[i]));
+
+    return depth + 1;
+}
+
+static bool
+equalShapes(const StateMap::Node *first, const StateMap::Node *second)
+{
+    if (!first || !second)
+        return first == second;
+
+    if (first->isLeaf() != second->isLeaf() ||
+        first->mBitmap != second->mBitmap ||
+        first->mHash != second->mHash ||
+        first->mEntries.size() != second->mEntries.size() ||
+        first->mSize != second->mSize)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < first->mChildren.size(); ++i)
+    {
+        if (!equalShapes(first->mChildren[i].data(),
+                         second->mChildren[i].data()))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void
+testInsertErase()
+{
+    StateMap map;
+    CANAL_ASSERT(map.size() == 0);
+    CANAL_ASSERT(map.begin() == map.end());
+
+    for (unsigned i = 1; i <= 200; ++i)
+        CANAL_ASSERT(map.insert(createEntry(getPlace(i * 7919), i)));
+
+    CANAL_ASSERT(map.size() == 200);
+    CANAL_ASSERT(!map.insert(createEntry(getPlace(7919), 0)));
+    CANAL_ASSERT(*map.find(getPlace(7919))->second ==
+                 *createEntry(NULL, 1).second);
+
+    // Every entry is visited exactly once.
+    std::set<const llvm::Value*> visited;
+    StateMap::const_iterator it = map.begin(), itend = map.end();
+    for (; it != itend; ++it)
+        CANAL_ASSERT(visited.insert(it->first).second);
+
+    CANAL_ASSERT(visited.size() == 200);
+
+    for (unsigned i = 1; i <= 200; i += 2)
+        CANAL_ASSERT(map.erase(getPlace(i * 7919)));
+
+    CANAL_ASSERT(!map.erase(getPlace(7919)));
+    CANAL_ASSERT(map.size() == 100);
+    for (unsigned i = 1; i <= 200; ++i)
+        CANAL_ASSERT((map.find(getPlace(i * 7919)) == map.end()) == (i % 2 == 1));
+
+    for (unsigned i = 2; i <= 200; i += 2)
+        CANAL_ASSERT(map.erase(getPlace(i * 7919)));
+
+    CANAL_ASSERT(map.size() == 0);
+    CANAL_ASSERT(map.begin() == map.end());
+}
+
+static void
+testEquality()
+{
+    StateMap first, second;
+    for (unsigned i = 1; i <= 50; ++i)
+    {
+        CANAL_ASSERT(first.insert(createEntry(getPlace(i * 31), i)));
+        CANAL_ASSERT(second.insert(createEntry(getPlace((51 - i) * 31), 51 - i)));
+    }
+
+    // The insertion order does not matter.
+    CANAL_ASSERT(first == second);
+
+    // A copy shares the trie until it is modified.
+    StateMap copy(first);
+    CANAL_ASSERT(copy == first);
+    CANAL_ASSERT(copy.erase(getPlace(31)));
+    CANAL_ASSERT(!(copy == first));
+    CANAL_ASSERT(first.find(getPlace(31)) != first.end());
+    CANAL_ASSERT(first.size() == 50 && copy.size() == 49);
+
+    CANAL_ASSERT(copy.insert(createEntry(getPlace(31), 2)));
+    CANAL_ASSERT(!(copy == first));
+}
+
+static void
+testCollisions()
+{
+    TestStateMap map;
+    for (unsigned offset = 1; offset <= 3; ++offset)
+        CANAL_ASSERT(map.insert(createEntry(getPlace(42, offset), offset)));
+
+    // Entries with the same hash share a leaf.
+    CANAL_ASSERT(map.size() == 3);
+    CANAL_ASSERT(map.getRoot()->isLeaf());
+    CANAL_ASSERT(map.getRoot()->mEntries.size() == 3);
+
+    for (unsigned offset = 1; offset <= 3; ++offset)
+        CANAL_ASSERT(map.find(getPlace(42, offset)) != map.end());
+
+    CANAL_ASSERT(map.find(getPlace(42, 4)) == map.end());
+    CANAL_ASSERT(!map.erase(getPlace(42, 4)));
+    CANAL_ASSERT(map.erase(getPlace(42, 2)));
+    CANAL_ASSERT(map.size() == 2);
+
+    unsigned count = 0;
+    StateMap::const_iterator it = map.begin(), itend = map.end();
+    for (; it != itend; ++it, ++count)
+        CANAL_ASSERT(it->first != getPlace(42, 2));
+
+    CANAL_ASSERT(count == 2);
+
+    // Colliding entries are compared by their places.
+    TestStateMap other;
+    CANAL_ASSERT(other.insert(createEntry(getPlace(42, 3), 3)));
+    CANAL_ASSERT(other.insert(createEntry(getPlace(42, 1), 1)));
+    CANAL_ASSERT(map == other);
+}
+
+static void
+testMaxDepth()
+{
+    // The hashes differ only in the last bit, so the leaves are at
+    // the deepest level of the trie.
+    const llvm::Value *first = getPlace(1),
+        *second = getPlace(1 | (1u << 31));
+
+    TestStateMap map;
+    CANAL_ASSERT(map.insert(createEntry(first, 1)));
+    CANAL_ASSERT(map.insert(createEntry(second, 2)));
+    CANAL_ASSERT(getDepth(*map.getRoot()) == StateMap::MAX_DEPTH);
+
+    unsigned count = 0;
+    StateMap::const_iterator it = map.begin(), itend = map.end();
+    for (; it != itend; ++it)
+        ++count;
+
+    CANAL_ASSERT(count == 2);
+    CANAL_ASSERT(map.find(second)->first == second);
+
+    // The chain of branches is removed with the entry.
+    CANAL_ASSERT(map.erase(second));
+    CANAL_ASSERT(map.getRoot()->isLeaf());
+    CANAL_ASSERT(getDepth(*map.getRoot()) == 1);
+}
+
+static void
+testCanonicalShape()
+{
+    // Maps with the same places have the same shape, regardless of
+    // the entries that have been erased.  Equality depends on it.
+    TestStateMap erased, inserted;
+    for (unsigned i = 1; i <= 40; ++i)
+    {
+        CANAL_ASSERT(erased.insert(createEntry(getPlace(i * 97), i)));
+        CANAL_ASSERT(erased.insert(createEntry(getPlace(i * 97 | (1u << 31)), i)));
+        CANAL_ASSERT(erased.insert(createEntry(getPlace(i * 97, 1), i)));
+    }
+
+    for (unsigned i = 1; i <= 40; ++i)
+    {
+        CANAL_ASSERT(erased.erase(getPlace(i * 97 | (1u << 31))));
+        if (i % 2 == 0)
+            CANAL_ASSERT(erased.erase(getPlace(i * 97, 1)));
+    }
+
+    for (unsigned i = 40; i >= 1; --i)
+    {
+        CANAL_ASSERT(inserted.insert(createEntry(getPlace(i * 97), i)));
+        if (i % 2 == 1)
+            CANAL_ASSERT(inserted.insert(createEntry(getPlace(i * 97, 1), i)));
+    }
+
+    CANAL_ASSERT(equalShapes(erased.getRoot(), inserted.getRoot()));
+    CANAL_ASSERT(erased == inserted);
+
+    // A single entry left after erasing is the root leaf.
+    TestStateMap single;
+    CANAL_ASSERT(single.insert(createEntry(getPlace(5), 5)));
+    CANAL_ASSERT(single.insert(createEntry(getPlace(5 | (1u << 20)), 6)));
+    CANAL_ASSERT(single.erase(getPlace(5 | (1u << 20))));
+    CANAL_ASSERT(single.getRoot()->isLeaf());
+}
+
+int
+main(int argc, char **argv)
+{
+    llvm::LLVMContext &context = llvm::getGlobalContext();
+    llvm::llvm_shutdown_obj y;  // Call llvm_shutdown() on exit.
+
+    llvm::Module *module = new llvm::Module("testModule", context);
+    gEnvironment = new Environment(module);
+
+    testInsertErase();
+    testEquality();
+    testCollisions();
+    testMaxDepth();
+    testCanonicalShape();
+
+    delete gEnvironment;
+    return 0;
+}
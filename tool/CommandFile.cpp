@@ -356,6 +356,14 @@ CommandFile::run(const std::vector<std::string> &args)
         }
     }
 
+    if (State::INCREMENTAL_RELOAD &&
+        mCommands.getState() &&
+        mCommands.getState()->reload(module))
+    {
+        llvm::outs() << "Module reloaded.\n";
+        return;
+    }
+
     mCommands.createState(module);
     llvm::outs() << "Module loaded.\n";
 }
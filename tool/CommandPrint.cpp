@@ -17,15 +17,16 @@ CommandPrint::CommandPrint(Commands &commands)
 {
 }
 
+template <typename Map>
 static void
-filterStateMap(const Canal::StateMap &map,
+filterStateMap(const Map &map,
                Canal::SlotTracker &slotTracker,
                const char *prefix,
                const std::string &arg,
                bool addFunctionName,
                std::vector<std::string> &result)
 {
-    Canal::StateMap::const_iterator it = map.begin();
+    typename Map::const_iterator it = map.begin();
     for (; it != map.end(); ++it)
     {
         Canal::StringStream name;
@@ -211,23 +212,33 @@ CommandPrint::run(const std::vector<std::string> &args)
 
         bool addFunctionName = (args[1] == "@^");
         const Canal::StateMap *map = NULL;
-        if (args[1] == "%")
-            map = &curState.getFunctionVariables();
-        else if (args[1] == "@")
+        if (args[1] == "@")
             map = &curState.getGlobalVariables();
         else if (args[1] == "@^")
             map = &curState.getGlobalBlocks();
         else if (args[1] == "%^")
             map = &curState.getFunctionBlocks();
-        else
+        else if (args[1] != "%")
             CANAL_DIE();
 
-        filterStateMap(*map,
-                       state->getSlotTracker(),
-                       args[1].c_str(),
-                       args[1],
-                       addFunctionName,
-                       variables);
+        if (map)
+        {
+            filterStateMap(*map,
+                           state->getSlotTracker(),
+                           args[1].c_str(),
+                           args[1],
+                           addFunctionName,
+                           variables);
+        }
+        else
+        {
+            filterStateMap(curState.getFunctionVariables(),
+                           state->getSlotTracker(),
+                           args[1].c_str(),
+                           args[1],
+                           addFunctionName,
+                           variables);
+        }
 
         std::vector<std::string>::const_iterator it = variables.begin();
         for (; it != variables.end(); ++it)
@@ -1,7 +1,19 @@
 #include "CommandSet.h"
+#include "Commands.h"
+#include "State.h"
 #include "lib/IntegerSet.h"
+#include "lib/GarbageCollector.h"
+#include "lib/InterningTable.h"
+#include "lib/InterpreterBudget.h"
+#include "lib/InterpreterFunction.h"
+#include "lib/InterpreterIterator.h"
+#include "lib/InterpreterModRef.h"
 #include "lib/InterpreterOperationsCallback.h"
+#include "lib/InterpreterParallelIterator.h"
 #include "lib/WideningDataIterationCount.h"
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
 
 CommandSet::CommandSet(Commands &commands)
     : Command("set",
@@ -13,6 +25,17 @@ CommandSet::CommandSet(Commands &commands)
     mOptions["widening-iterations"] = CommandSet::WideningIterations;
     mOptions["no-missing"] = CommandSet::NoMissing;
     mOptions["set-threshold"] = CommandSet::SetThreshold;
+    mOptions["iteration-strategy"] = CommandSet::IterationStrategy;
+    mOptions["threads"] = CommandSet::Threads;
+    mOptions["sparse"] = CommandSet::Sparse;
+    mOptions["incremental"] = CommandSet::Incremental;
+    mOptions["budget"] = CommandSet::Budget;
+    mOptions["function-budget"] = CommandSet::FunctionBudget;
+    mOptions["interning"] = CommandSet::Interning;
+    mOptions["garbage-collection"] = CommandSet::GarbageCollection;
+    mOptions["keep-dead-registers"] = CommandSet::KeepDeadRegisters;
+    mOptions["degradation-memory"] = CommandSet::DegradationMemory;
+    mOptions["mod-ref"] = CommandSet::ModRef;
 }
 
 std::vector<std::string>
@@ -46,6 +69,37 @@ isNumber(const std::string &s)
     return it == s.end();
 }
 
+// Parse a decimal number.  Returns false if the string is not
+// a number or the number is greater than the maximum.
+static bool
+parseNumber(const std::string &s, unsigned long max, unsigned long &result)
+{
+    if (s.empty() || !isNumber(s))
+        return false;
+
+    errno = 0;
+    result = std::strtoul(s.c_str(), NULL, 10);
+    return errno != ERANGE && result <= max;
+}
+
+// Parse the on/off argument of a switch.  A missing argument turns
+// the switch on.  Returns false if the argument is invalid.
+static bool
+parseSwitch(const std::vector<std::string> &args, bool &value)
+{
+    if (args.size() < 3 || args[2] == "on")
+        value = true;
+    else if (args[2] == "off")
+        value = false;
+    else
+    {
+        llvm::outs() << "Switch must be either on or off.\n";
+        return false;
+    }
+
+    return true;
+}
+
 static void
 setWideningIterations(const std::vector<std::string> &args)
 {
@@ -91,6 +145,217 @@ setSetThreshold(const std::vector<std::string> &args)
     llvm::outs() << "Set threshold set to " << args[2] << ".\n";
 }
 
+static void
+setIterationStrategy(const std::vector<std::string> &args)
+{
+    if (args.size() < 3)
+    {
+        llvm::outs() << "Iteration strategy must be specified "
+                     << "(round-robin, worklist, wto).\n";
+        return;
+    }
+
+    if (args[2] == "round-robin")
+        Canal::Interpreter::Iterator::STRATEGY = Canal::Interpreter::Iterator::RoundRobinStrategy;
+    else if (args[2] == "worklist")
+        Canal::Interpreter::Iterator::STRATEGY = Canal::Interpreter::Iterator::WorklistStrategy;
+    else if (args[2] == "wto")
+        Canal::Interpreter::Iterator::STRATEGY = Canal::Interpreter::Iterator::WeakTopologicalOrderStrategy;
+    else
+    {
+        llvm::outs() << "Unknown iteration strategy.\n";
+        return;
+    }
+
+    llvm::outs() << "Iteration strategy set to " << args[2] << ".\n";
+    if (Canal::Interpreter::Iterator::SPARSE &&
+        Canal::Interpreter::Iterator::STRATEGY ==
+        Canal::Interpreter::Iterator::RoundRobinStrategy)
+    {
+        llvm::outs() << "Registers are not propagated sparsely "
+                     << "with this strategy.\n";
+    }
+}
+
+static void
+setThreads(const std::vector<std::string> &args)
+{
+    if (args.size() < 3)
+    {
+        llvm::outs() << "Number of threads must be specified.\n";
+        return;
+    }
+
+    if (!isNumber(args[2]))
+    {
+        llvm::outs() << "Thread count must be a number.\n";
+        return;
+    }
+
+    Canal::Interpreter::ParallelIterator::THREAD_COUNT = std::atoi(args[2].c_str());
+    llvm::outs() << "Thread count set to " << args[2] << ".\n";
+}
+
+static void
+setSparse(const std::vector<std::string> &args)
+{
+    bool sparse;
+    if (!parseSwitch(args, sparse))
+        return;
+
+    Canal::Interpreter::Iterator::SPARSE = sparse;
+    if (!sparse)
+    {
+        llvm::outs() << "Propagating registers through basic block states.\n";
+        return;
+    }
+
+    llvm::outs() << "Propagating registers sparsely.\n";
+    if (Canal::Interpreter::Iterator::STRATEGY ==
+        Canal::Interpreter::Iterator::RoundRobinStrategy)
+    {
+        llvm::outs() << "The round-robin strategy ignores this option.  "
+                     << "Use the worklist or wto iteration strategy.\n";
+    }
+}
+
+static void
+setIncremental()
+{
+    State::INCREMENTAL_RELOAD = true;
+    llvm::outs() << "Reloading changed functions only.\n";
+}
+
+static void
+setInterning()
+{
+    Canal::InterningTable::ENABLED = true;
+    llvm::outs() << "Interning abstract values.\n";
+}
+
+static void
+setGarbageCollection()
+{
+    Canal::GarbageCollector::ENABLED = true;
+    llvm::outs() << "Collecting unreachable memory blocks.\n";
+}
+
+static void
+setKeepDeadRegisters(const std::vector<std::string> &args,
+                     const State *state)
+{
+    bool keep;
+    if (!parseSwitch(args, keep))
+        return;
+
+    // Registers removed from the output states are not computed
+    // again, so they cannot be brought back.
+    if (keep &&
+        !Canal::Interpreter::Function::KEEP_DEAD_REGISTERS &&
+        state && state->hasStarted())
+    {
+        llvm::outs() << "Dead registers have been removed already.  "
+                     << "Load the program again to keep them.\n";
+        return;
+    }
+
+    Canal::Interpreter::Function::KEEP_DEAD_REGISTERS = keep;
+    if (keep)
+        llvm::outs() << "Keeping all registers in basic block states.\n";
+    else
+        llvm::outs() << "Removing dead registers from basic block states.\n";
+}
+
+static void
+setModRef(const std::vector<std::string> &args, const State *state)
+{
+    bool enabled;
+    if (!parseSwitch(args, enabled))
+        return;
+
+    // The summaries are computed when the program is loaded.
+    if (state && enabled != Canal::Interpreter::ModRef::ENABLED)
+    {
+        llvm::outs() << "The option applies to programs loaded later.  "
+                     << "Load the program again to use it.\n";
+        return;
+    }
+
+    Canal::Interpreter::ModRef::ENABLED = enabled;
+    if (enabled)
+        llvm::outs() << "Propagating only the globals accessed by called functions.\n";
+    else
+        llvm::outs() << "Propagating all globals to called functions.\n";
+}
+
+static void
+setDegradationMemory(const std::vector<std::string> &args)
+{
+    if (args.size() < 3)
+    {
+        llvm::outs() << "Memory limit (megabytes) must be specified.\n";
+        return;
+    }
+
+    unsigned long megabytes;
+    if (!parseNumber(args[2],
+                     std::numeric_limits<size_t>::max() / (1024 * 1024),
+                     megabytes))
+    {
+        llvm::outs() << "Memory limit must be a number of megabytes "
+                     << "that fits the address space.\n";
+        return;
+    }
+
+    Canal::Interpreter::Budget::DEGRADATION_MEMORY =
+        (size_t)megabytes * 1024 * 1024;
+
+    llvm::outs() << "Degrading precision after " << args[2]
+                 << " megabytes of abstract values.\n";
+}
+
+static void
+setBudget(const std::vector<std::string> &args,
+          unsigned &time,
+          unsigned &visits,
+          size_t &memory)
+{
+    if (args.size() < 4)
+    {
+        llvm::outs() << "Resource and limit must be specified "
+                     << "(time SECONDS, visits COUNT, memory MEGABYTES).\n";
+        return;
+    }
+
+    unsigned long max;
+    if (args[2] == "time" || args[2] == "visits")
+        max = std::numeric_limits<unsigned>::max();
+    else if (args[2] == "memory")
+        max = std::numeric_limits<size_t>::max() / (1024 * 1024);
+    else
+    {
+        llvm::outs() << "Unknown resource.\n";
+        return;
+    }
+
+    unsigned long limit;
+    if (!parseNumber(args[3], max, limit))
+    {
+        llvm::outs() << "Limit must be a number not greater than "
+                     << max << ".\n";
+        return;
+    }
+
+    if (args[2] == "time")
+        time = limit;
+    else if (args[2] == "visits")
+        visits = limit;
+    else
+        memory = (size_t)limit * 1024 * 1024;
+
+    llvm::outs() << "Limit of " << args[2] << " set to " << args[3] << ".\n";
+}
+
 void
 CommandSet::run(const std::vector<std::string> &args)
 {
@@ -120,6 +385,45 @@ CommandSet::run(const std::vector<std::string> &args)
         case SetThreshold:
             setSetThreshold(args);
             break;
+        case IterationStrategy:
+            setIterationStrategy(args);
+            break;
+        case Threads:
+            setThreads(args);
+            break;
+        case Sparse:
+            setSparse(args);
+            break;
+        case Incremental:
+            setIncremental();
+            break;
+        case Budget:
+            setBudget(args,
+                      Canal::Interpreter::Budget::TIME,
+                      Canal::Interpreter::Budget::VISITS,
+                      Canal::Interpreter::Budget::MEMORY);
+            break;
+        case FunctionBudget:
+            setBudget(args,
+                      Canal::Interpreter::Budget::FUNCTION_TIME,
+                      Canal::Interpreter::Budget::FUNCTION_VISITS,
+                      Canal::Interpreter::Budget::FUNCTION_MEMORY);
+            break;
+        case Interning:
+            setInterning();
+            break;
+        case GarbageCollection:
+            setGarbageCollection();
+            break;
+        case KeepDeadRegisters:
+            setKeepDeadRegisters(args, mCommands.getState());
+            break;
+        case DegradationMemory:
+            setDegradationMemory(args);
+            break;
+        case ModRef:
+            setModRef(args, mCommands.getState());
+            break;
         default:
             llvm::outs() << "No action defined for the command.\n";
             break;
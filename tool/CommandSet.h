@@ -9,7 +9,18 @@ class CommandSet : public Command
     {
         WideningIterations = 1,
         NoMissing,
-        SetThreshold
+        SetThreshold,
+        IterationStrategy,
+        Threads,
+        Sparse,
+        Incremental,
+        Budget,
+        FunctionBudget,
+        Interning,
+        GarbageCollection,
+        KeepDeadRegisters,
+        DegradationMemory,
+        ModRef
     };
 
     typedef std::map<std::string, Option> OptionMap;
@@ -42,6 +42,11 @@ public:
     {
         return mFunctionEnter;
     }
+
+    void reset()
+    {
+        mFixpointReached = mFunctionEnter = mBasicBlockEnter = false;
+    }
 };
 
 #endif // CANAL_ITERATOR_CALLBACK
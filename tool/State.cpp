@@ -6,9 +6,12 @@
 #include "lib/Pointer.h"
 #include "lib/InterpreterFunction.h"
 
+bool State::INCREMENTAL_RELOAD = false;
+
 State::State(llvm::Module *module) : mInterpreter(module)
 {
     mInterpreter.getIterator().setCallback(mIteratorCallback);
+    mInterpreter.getParallelIterator().setCallback(mIteratorCallback);
 }
 
 State::~State()
@@ -22,10 +25,34 @@ State::isInterpreting() const
         !mIteratorCallback.isFixpointReached();
 }
 
+bool
+State::hasStarted() const
+{
+    return mInterpreter.getIterator().isInitialized() ||
+        mIteratorCallback.isFixpointReached();
+}
+
+bool
+State::reload(llvm::Module *module)
+{
+    bool converged = mIteratorCallback.isFixpointReached();
+    if (!mInterpreter.update(module, converged))
+        return false;
+
+    mIteratorCallback.reset();
+    return true;
+}
+
 void
 State::start()
 {
     mInterpreter.getIterator().initialize();
+    if (!mInterpreter.getIterator().isInitialized())
+    {
+        llvm::outs() << "The program has no function to interpret.\n";
+        return;
+    }
+
     llvm::outs() << "Entering function "
                  << mInterpreter.getCurrentFunction().getName() << ".\n"
                  << "Entering basic block.\n"
@@ -35,6 +62,20 @@ State::start()
 void
 State::run()
 {
+    // Breakpoints require stepping through single instructions,
+    // which the batch iterations do not support.
+    if (mFunctionBreakpoints.empty() &&
+        !mInterpreter.getIterator().isInitialized())
+    {
+        if (Canal::Interpreter::ParallelIterator::THREAD_COUNT > 0)
+            mInterpreter.getParallelIterator().run();
+        else
+            mInterpreter.getIterator().runToFixpoint();
+
+        printBudget();
+        return;
+    }
+
     mInterpreter.getIterator().initialize();
 
     while (!mIteratorCallback.isFixpointReached())
@@ -43,6 +84,8 @@ State::run()
         if (reachedBreakpoint())
             return;
     }
+
+    printBudget();
 }
 
 void
@@ -52,7 +95,10 @@ State::step(int count)
     {
         mInterpreter.getIterator().interpretInstruction();
         if (mIteratorCallback.isFixpointReached())
+        {
+            printBudget();
             return;
+        }
 
         if (reachedBreakpoint())
             return;
@@ -78,7 +124,10 @@ State::finish()
     {
         mInterpreter.getIterator().interpretInstruction();
         if (mIteratorCallback.isFixpointReached())
+        {
+            printBudget();
             return;
+        }
 
         if (reachedBreakpoint())
             return;
@@ -115,6 +164,14 @@ State::addFunctionBreakpoint(const std::string &functionName)
     }
 }
 
+void
+State::printBudget() const
+{
+    const Canal::Interpreter::Budget &budget = mInterpreter.getBudget();
+    if (budget.isExhausted())
+        llvm::outs() << budget.toString();
+}
+
 bool
 State::reachedBreakpoint()
 {
@@ -9,6 +9,12 @@
 // State of the interpreter.
 class State
 {
+public:
+    // Reload changed functions only when a new version of the
+    // program is loaded.
+    static bool INCREMENTAL_RELOAD;
+
+private:
     Canal::Interpreter::Interpreter mInterpreter;
 
     std::set<std::string> mFunctionBreakpoints;
@@ -58,16 +64,30 @@ public:
     // This is true if something is on the stack.
     bool isInterpreting() const;
 
+    // Check if some results have been computed already, either by an
+    // interpretation in progress or by a finished one.
+    bool hasStarted() const;
+
     void start();
     void run();
     void step(int count);
     void finish();
 
+    // Replace the interpreted program by its new version, keeping
+    // the results of unchanged functions.  Returns false if the
+    // program changed too much and must be loaded from scratch.
+    // Takes ownership of the module on success.
+    bool reload(llvm::Module *module);
+
     // Add a breakpoint on function start.
     void addFunctionBreakpoint(const std::string &functionName);
 
 protected:
     bool reachedBreakpoint();
+
+    // Report the functions whose interpretation has been cut short
+    // by the budget.
+    void printBudget() const;
 };
 
 #endif // CANAL_STATE_H